@@ -16,40 +16,38 @@
 
 namespace hat {
 namespace core {
-LINKAGE_RESTRICTION std::string encodeNumberInTauIdentifier(char prefix, size_t numberToEncode)
+LINKAGE_RESTRICTION std::string encodeNumberInTauIdentifier(char prefix, size_t numberToEncode, std::string const & positionInLayout)
 {
-	static size_t counter = 0;
 	std::stringstream result;
-	result << prefix << numberToEncode << '_' << counter;
-	++counter;
+	result << prefix << numberToEncode << '_' << positionInLayout;
 	return result.str();
 }
 
 LINKAGE_RESTRICTION size_t getEncodedNumberFromTauIdentifier(std::string const & id)
 {
-	size_t encodedNumberEnd = id.find("_");
-	auto encodedPart = id.substr(1, encodedNumberEnd - 1);
-	std::stringstream str(encodedPart);
+	// The digits are parsed in place (this is called for each button click, so there is no need to copy the ID's tail, which could be long for the deeply nested elements).
 	size_t result = 0;
-	str >> result;
+	for (size_t i = 1; (i < id.size()) && (id[i] >= '0') && (id[i] <= '9'); ++i) {
+		result = result * 10 + static_cast<size_t>(id[i] - '0');
+	}
 	return result;
 }
 
 //Returns an element ID, which is unique for the layout, but also is easily convertible to the command ID
-LINKAGE_RESTRICTION std::string AbstractEngine::generateTauIdentifierForCommand(size_t commandIndex)
+LINKAGE_RESTRICTION std::string AbstractEngine::generateTauIdentifierForCommand(size_t commandIndex, std::string const & positionInLayout)
 {
-	return encodeNumberInTauIdentifier(TAU_PREFIX_COMMAND, commandIndex);
+	return encodeNumberInTauIdentifier(TAU_PREFIX_COMMAND, commandIndex, positionInLayout);
 }
 
 //The values generated from this call are for the elements, which are not interesting for the user (navigation buttons, labels, etc). The only requirement for them is not to conflict with other IDs
-LINKAGE_RESTRICTION std::string AbstractEngine::generateTrowawayTauIdentifier()
+LINKAGE_RESTRICTION std::string AbstractEngine::generateTrowawayTauIdentifier(std::string const & positionInLayout)
 {
-	return encodeNumberInTauIdentifier(TAU_PREFIX_THROWAWAY, 0);
+	return encodeNumberInTauIdentifier(TAU_PREFIX_THROWAWAY, 0, positionInLayout);
 }
 
-LINKAGE_RESTRICTION std::string AbstractEngine::generateTauIdentifierForEnvSwitching(size_t indexForEnvironment)
+LINKAGE_RESTRICTION std::string AbstractEngine::generateTauIdentifierForEnvSwitching(size_t indexForEnvironment, std::string const & positionInLayout)
 {
-	return encodeNumberInTauIdentifier(TAU_PREFIX_ENV_SWITCH, indexForEnvironment);
+	return encodeNumberInTauIdentifier(TAU_PREFIX_ENV_SWITCH, indexForEnvironment, positionInLayout);
 }
 
 enum class SPECIAL_SERVER_COMMANDS
@@ -81,12 +79,39 @@ LINKAGE_RESTRICTION std::string AbstractEngine::generateStickEnvironmentToWindow
 	return encodeNumberInTauIdentifier(TAU_PREFIX_UTIL, static_cast<size_t>(SPECIAL_SERVER_COMMANDS::STICK_TOPMOST_WINDOW_TO_SELECTED_ENVIRONMENT));
 }
 
+LINKAGE_RESTRICTION ButtonClickAction AbstractEngine::decodeButtonClickAction(std::string const & buttonID)
+{
+	auto result = ButtonClickAction{};
+	if (buttonID.empty()) {
+		return result;
+	}
+	switch (buttonID[0]) {
+	case TAU_PREFIX_COMMAND:
+		result.m_type = ButtonClickAction::Type::COMMAND;
+		break;
+	case TAU_PREFIX_ENV_SWITCH:
+		result.m_type = ButtonClickAction::Type::ENV_SWITCH;
+		break;
+	case TAU_PREFIX_UTIL:
+		result.m_type = ButtonClickAction::Type::UTIL;
+		break;
+	default:
+		return result;
+	}
+	result.m_index = getEncodedNumberFromTauIdentifier(buttonID);
+	return result;
+}
+
 //Return value tells the caller, if the layout should be refereshed.
 LINKAGE_RESTRICTION FeedbackFromButtonClick AbstractEngine::buttonOnLayoutClicked(std::string const & buttonID)
 {
-	char indicator = buttonID[0];
-	if (indicator == TAU_PREFIX_COMMAND) {
-		auto commandToExecute = getEncodedNumberFromTauIdentifier(buttonID);
+	return buttonOnLayoutClicked(decodeButtonClickAction(buttonID));
+}
+
+LINKAGE_RESTRICTION FeedbackFromButtonClick AbstractEngine::buttonOnLayoutClicked(ButtonClickAction const & action)
+{
+	if (action.m_type == ButtonClickAction::Type::COMMAND) {
+		auto commandToExecute = action.m_index;
 		if (canSendTheCommmandForEnvironment()) {
 			executeCommandForCurrentlySelectedEnvironment(commandToExecute);
 		} else {
@@ -96,10 +121,10 @@ LINKAGE_RESTRICTION FeedbackFromButtonClick AbstractEngine::buttonOnLayoutClicke
 			switchLayout_wrongTopmostWindow();
 			return FeedbackFromButtonClick::UPDATE_LAYOUT;
 		}
-	} else if (indicator == TAU_PREFIX_ENV_SWITCH) {
-		return setNewEnvironment(getEncodedNumberFromTauIdentifier(buttonID)) ? FeedbackFromButtonClick::UPDATE_LAYOUT : FeedbackFromButtonClick::NONE;
-	} else if (indicator == TAU_PREFIX_UTIL) {
-		auto encodedActionIndex = static_cast<SPECIAL_SERVER_COMMANDS>(getEncodedNumberFromTauIdentifier(buttonID));
+	} else if (action.m_type == ButtonClickAction::Type::ENV_SWITCH) {
+		return setNewEnvironment(action.m_index) ? FeedbackFromButtonClick::UPDATE_LAYOUT : FeedbackFromButtonClick::NONE;
+	} else if (action.m_type == ButtonClickAction::Type::UTIL) {
+		auto encodedActionIndex = static_cast<SPECIAL_SERVER_COMMANDS>(action.m_index);
 		switch (encodedActionIndex) {
 		case SPECIAL_SERVER_COMMANDS::RELOAD_CONFIGS_BUTTON:
 			return FeedbackFromButtonClick::RELOAD_CONFIGS;
@@ -21,8 +21,24 @@ enum class FeedbackFromButtonClick
 	SHOW_STICK_ENV_TO_WIN_PAGE,
 	SHOW_TARGET_WINDOW_NOT_ACTIVE_PAGE,	 // this is returned when the environment is stuck to the given window, and it is not in focus, so the command can't be executed
 };
+// The action of the layout's button, decoded from the button's ID (see AbstractEngine::decodeButtonClickAction()).
+// The layout generation code could decode the actions of all the buttons in advance, so the clicks are dispatched without parsing the IDs.
+struct ButtonClickAction
+{
+	enum class Type
+	{
+		NONE, // the button does not trigger any action on the server side (for example, the navigation buttons)
+		COMMAND,
+		ENV_SWITCH,
+		UTIL
+	};
+	Type m_type{ Type::NONE };
+	size_t m_index{ 0 }; // the command index, the environment index or the util action index (depending on the m_type)
+};
+
 //These are helper methods. Ideally, they should not be exposed to outside code, but this way it is easier to test them;
-static std::string encodeNumberInTauIdentifier(char prefix, size_t numberToEncode);
+//The IDs have the form '<prefix><number>_<position in layout>'. They don't contain any counters, so the same layout always gets the same IDs (the position part makes them unique inside the layout).
+static std::string encodeNumberInTauIdentifier(char prefix, size_t numberToEncode, std::string const & positionInLayout = "");
 static size_t getEncodedNumberFromTauIdentifier(std::string const & id);
 
 class AbstractEngine
@@ -50,15 +66,18 @@ public:
 	// We could add throwing of exceptions in cases of the pending commands misuse (when a new command is requested, when there still is a pending one, we should throw exception)
 
 //Returns an element ID, which is unique for the layout, but also is easily convertible to the command ID
-	static std::string generateTauIdentifierForCommand(size_t commandIndex);
+	//Note: the positionInLayout should be unique inside the layout for all the elements with the same prefix and number (it is a path to the element, for example).
+	static std::string generateTauIdentifierForCommand(size_t commandIndex, std::string const & positionInLayout = "");
 	//The values generated from this call are for the elements, which are not interesting for the user (navigation buttons, labels, etc). The only requirement for them is not to conflict with other IDs
-	static std::string generateTrowawayTauIdentifier();
-	static std::string generateTauIdentifierForEnvSwitching(size_t indexForEnv);
+	static std::string generateTrowawayTauIdentifier(std::string const & positionInLayout);
+	static std::string generateTauIdentifierForEnvSwitching(size_t indexForEnv, std::string const & positionInLayout = "");
 	static std::string generateReloadButtonID(); // generates a button ID, which should trigger re-read of the configs and reload of the UI on client.
 	static std::string generateResendPendingCommandButtonID(); // generates a button ID, which should trigger retry of sending the pending command (this happens when the current topmost window was not equal to the expected)
 	static std::string generateClearPendingCommandButtonID(); // generates a button ID, which should trigger clearing of the pending command
 	static std::string generateStickEnvironmentToWindowCommand(); // generates a button ID, which should trigger clearing of the pending command
+	static ButtonClickAction decodeButtonClickAction(std::string const & buttonID);
 	FeedbackFromButtonClick buttonOnLayoutClicked(std::string const & buttonID);
+	FeedbackFromButtonClick buttonOnLayoutClicked(ButtonClickAction const & action);
 };
 } //namespace core
 } //namespace hat
@@ -7,13 +7,18 @@
 #define COMMAND_ID_HPP
 
 #include "string_id.hpp"
+#include "string_ref.hpp"
+#include <cstdint>
 namespace hat {
 namespace core {
 
+// Note: the hash of the id is calculated once, when the object is created. It is used for the lookups in the commands index (see commands_index.hpp).
 class CommandID: public StringID<CommandID> {
+	uint64_t m_hash;
 public:
-	CommandID() : StringID() {}
-	explicit CommandID(std::string const & value) : StringID(value) {};
+	CommandID() : StringID(), m_hash(calculateStringHash(StringRef())) {}
+	explicit CommandID(std::string const & value) : StringID(value), m_hash(calculateStringHash(StringRef(value))) {};
+	uint64_t getHash() const { return m_hash; };
 };
 } //namespace core
 } //namespace hat
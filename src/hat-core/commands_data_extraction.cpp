@@ -7,8 +7,10 @@
 #include "commands_data_extraction.hpp"
 #endif
 #include "utils.hpp"
+#include "config_file_reader.hpp"
 #include <iostream>
 #include <sstream>
+#include <thread>
 
 #ifndef HAT_CORE_HEADERONLY_MODE
 #define LINKAGE_RESTRICTION 
@@ -51,11 +53,46 @@ LINKAGE_RESTRICTION bool SystemCall::isEquivalentTo_impl(SystemCall const & othe
 	return (enabled == other.enabled) && (m_value == other.m_value);
 }
 
+LINKAGE_RESTRICTION bool SimpleTextTyping::isEquivalentTo_impl(SimpleTextTyping const & other) const
+{
+	return (enabled == other.enabled) && (m_value == other.m_value);
+}
+
 LINKAGE_RESTRICTION bool InputSequencesCollection::isEquivalentTo_impl(InputSequencesCollection const & other) const
 {
 	return checkSimpleEquivalence(*this, other);
 }
 
+LINKAGE_RESTRICTION std::shared_ptr<AbstractSimulatedUserInput> const & InputsForEnvironments::getDisabledInput()
+{
+	static std::shared_ptr<AbstractSimulatedUserInput> const result = std::make_shared<SimpleHotkeyCombination>("", false);
+	return result;
+}
+
+LINKAGE_RESTRICTION void InputsForEnvironments::setInput(size_t environmentIndex, std::shared_ptr<AbstractSimulatedUserInput> const & input)
+{
+	if (environmentIndex >= m_definedInputs.size()) {
+		if (input == getDisabledInput()) {
+			return;
+		}
+		m_definedInputs.resize(environmentIndex + 1, getDisabledInput());
+	}
+	m_definedInputs[environmentIndex] = input;
+}
+
+LINKAGE_RESTRICTION bool InputsForEnvironments::operator == (InputsForEnvironments const & other) const
+{
+	if (m_environmentsCount != other.m_environmentsCount) {
+		return false;
+	}
+	for (size_t i = 0; i < m_environmentsCount; ++i) {
+		if (!(*this)[i]->isEquivalentTo(*other[i])) {
+			return false;
+		}
+	}
+	return true;
+}
+
 LINKAGE_RESTRICTION Command::Command(std::string const & c_id, std::string const & c_desc, std::string const & c_gr, HotkeysForDifferentEnvironments const & hkeys) :
 	commandID(c_id),
 	commandNote(c_desc),
@@ -69,12 +106,7 @@ LINKAGE_RESTRICTION bool Command::operator == (Command const & other) const
 	return (commandID == other.commandID) &&
 		(commandNote == other.commandNote) &&
 		(commandGroup == other.commandGroup) && 
-		(hotkeysForEnvironments.size() == other.hotkeysForEnvironments.size()) &&
-		std::equal(
-			std::begin(hotkeysForEnvironments), std::end(hotkeysForEnvironments), std::begin(other.hotkeysForEnvironments),
-			[](HotkeysForDifferentEnvironments::value_type const & left, HotkeysForDifferentEnvironments::value_type const & right) {
-				return left->isEquivalentTo(*right);
-			});
+		(hotkeysForEnvironments == other.hotkeysForEnvironments);
 }
 
 LINKAGE_RESTRICTION Command Command::create(hat::core::ParsedCsvRow const & data, size_t customColumnsCount, HotkeyCombinationFactoryMethod hotkey_builder)
@@ -82,36 +114,38 @@ LINKAGE_RESTRICTION Command Command::create(hat::core::ParsedCsvRow const & data
 	auto c_id = data.m_customColumns[0];
 	auto c_gr = data.m_customColumns[1];
 	auto c_desc = data.m_customColumns[2];
-	auto target = HotkeysForDifferentEnvironments{};
-	target.reserve(customColumnsCount);
-	for (size_t i = 0; i < customColumnsCount; ++i) {
-		if (i < data.m_customColumns.size() - 4) {
-			target.push_back(hotkey_builder(data.m_customColumns[i + 4], CommandID(c_id), i));
-		} else {
-			target.push_back(std::make_shared<SimpleHotkeyCombination>("", false)); // just an empty disabled combination. Maybe will also generate it through hotkey_builder though
+	auto target = HotkeysForDifferentEnvironments{ customColumnsCount };
+	auto const commandID = CommandID(c_id);
+	for (size_t i = 0; (i < customColumnsCount) && (i + 4 < data.m_customColumns.size()); ++i) {
+		auto const & cellValue = data.m_customColumns[i + 4];
+		if (cellValue.size() > 0) { // the empty cells are left referencing the shared disabled object
+			target.setInput(i, hotkey_builder(cellValue, commandID, i));
 		}
 	}
 	return Command(c_id, c_desc, c_gr, target);
 }
 
-LINKAGE_RESTRICTION std::vector<std::string> splitTheRow(std::string const & row, char delimiter)
+LINKAGE_RESTRICTION std::vector<std::string> splitTheRow(StringRef const & row, char delimiter)
 {
-	auto verificationLambda = [](std::string const & extractedString, size_t indexForString, bool moreDataInStream) -> bool {
+	std::vector<std::string> elements;
+	auto verificationLambda = [&elements](StringRef const & extractedString, size_t indexForString, bool moreDataInStream) -> bool {
+		elements.push_back(std::string(extractedString));
 		return true;
 	};
-	return splitTheRow(row, delimiter, verificationLambda);
+	splitTheRow(row, delimiter, verificationLambda);
+	return elements;
 }
 
-LINKAGE_RESTRICTION std::tuple<bool, size_t> idStringOk(std::string const & toTest) {
+LINKAGE_RESTRICTION std::tuple<bool, size_t> idStringOk(StringRef const & toTest) {
 	auto index = toTest.find_first_not_of("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz_1234567890");
-	if (index != std::string::npos) {
+	if (index != StringRef::npos) {
 		// TODO: add a special command line flag to display this kind of stuff in the console:
 		// std::cerr << "Error: forbidden symbol found in id string : '" << toTest << "' at position " << index << " (symbol: '" << toTest[index] << "').\n";
 		return std::make_tuple(false, index);
 	}
 	return std::make_tuple(true, 0);
 }
-LINKAGE_RESTRICTION void ensureIdStringOk(std::string const & toTest)
+LINKAGE_RESTRICTION void ensureIdStringOk(StringRef const & toTest)
 {
 	auto idStingCheck = idStringOk(toTest);
 	if (!std::get<0>(idStingCheck)) {
@@ -120,28 +154,32 @@ LINKAGE_RESTRICTION void ensureIdStringOk(std::string const & toTest)
 		throw std::runtime_error(errormessage.str());
 	}
 }
-LINKAGE_RESTRICTION auto ParsedCsvRow::parseHeaderString(std::string const & headerString)
+LINKAGE_RESTRICTION auto ParsedCsvRow::parseHeaderString(StringRef const & headerString)
 {
 	const auto & leadingRequiredCharacters = ConfigFilesKeywords::mandatoryCellsNamesInCommandsCSV();
 	if (headerString.find(leadingRequiredCharacters) != 0) {
 		throw std::runtime_error("Error during parsing commands config. Header string should start with the specific elements: " + leadingRequiredCharacters);
 	}
-	const auto toParse(headerString.substr(leadingRequiredCharacters.size(), headerString.size()));
-	auto myLambda = [](std::string const & extractedString, size_t indexForString, bool moreDataInStream) -> bool {
+	const auto toParse = headerString.substr(leadingRequiredCharacters.size());
+	auto elements = std::vector<std::string>{};
+	auto myLambda = [&elements](StringRef const & extractedString, size_t indexForString, bool moreDataInStream) -> bool {
 		if ((extractedString.size() == 0) && moreDataInStream) {
 			std::stringstream errorMessage;
 			errorMessage << "Empty attribute in the header string at position " << indexForString << " - this is not allowed";
 			throw std::runtime_error(errorMessage.str());
 		}
+		elements.push_back(std::string(extractedString));
 		return true;
 	};
-	return ParsedCsvRow(splitTheRow(toParse, '\t', myLambda));
+	splitTheRow(toParse, '\t', myLambda);
+	return ParsedCsvRow(elements);
 }
-namespace
+// Note: the named namespace is used here (and not the anonymous one), because the verificator is captured by the lambda in the parseDataRowString(), which is compiled in the headers-only mode.
+namespace detail
 {
-	auto getCsvCommandDataRowElementsProcessor()
+	LINKAGE_RESTRICTION auto getCsvCommandDataRowElementsProcessor()
 	{
-		return [](std::string const & extractedString, size_t indexForString, bool moreDataInStream) -> bool {
+		return [](StringRef const & extractedString, size_t indexForString, bool moreDataInStream) -> bool {
 			if (indexForString == 0) {
 				if (extractedString.size() == 0) {
 					std::stringstream errormessage;
@@ -157,17 +195,26 @@ namespace
 					errormessage << "Forbidden symbol in the category string value at position " << std::get<1>(categoryStingCheck) << ". The categoryID string: '" << extractedString << "'.";
 					throw std::runtime_error(errormessage.str());
 				}
-			} else if ((indexForString == 2) && (extractedString.size() == 0)) {
-				throw std::runtime_error("Each row should have a non-empty string note to associate with it.");
+			} else if (indexForString == 2) {
+				if (extractedString.size() == 0) {
+					throw std::runtime_error("Each row should have a non-empty string note to associate with it.");
+				}
+				ensureValidUTF8(extractedString); // the note is displayed on the client
 			}
 			return true;
 		};
 	}
 }
-LINKAGE_RESTRICTION auto ParsedCsvRow::parseDataRowString(std::string const & rowString)
+LINKAGE_RESTRICTION auto ParsedCsvRow::parseDataRowString(StringRef const & rowString)
 {
-	auto myLambda = getCsvCommandDataRowElementsProcessor();
-	auto rowElements = splitTheRow(rowString, '\t', myLambda);
+	auto rowElements = std::vector<std::string>{};
+	auto cellsVerificator = detail::getCsvCommandDataRowElementsProcessor();
+	auto myLambda = [&rowElements, &cellsVerificator](StringRef const & extractedString, size_t indexForString, bool moreDataInStream) -> bool {
+		cellsVerificator(extractedString, indexForString, moreDataInStream);
+		rowElements.push_back(std::string(extractedString));
+		return true;
+	};
+	splitTheRow(rowString, '\t', myLambda);
 	return ParsedCsvRow(rowElements);
 }
 
@@ -178,7 +225,7 @@ LINKAGE_RESTRICTION CommandsInfoContainer::CommandsContainer const & CommandsInf
 
 namespace {
 
-std::pair<bool, size_t> util_getEnvironmentIndex(CommandsInfoContainer::EnvsContainer const & environmentsContainer, std::string const & environmentStringId) {
+std::pair<bool, size_t> util_getEnvironmentIndex(CommandsInfoContainer::EnvsContainer const & environmentsContainer, StringRef const & environmentStringId) {
 	auto begin = std::begin(environmentsContainer);
 	auto end = std::end(environmentsContainer);
 
@@ -195,12 +242,21 @@ LINKAGE_RESTRICTION CommandsInfoContainer::EnvsContainer const & CommandsInfoCon
 
 LINKAGE_RESTRICTION size_t CommandsInfoContainer::getCommandIndex(CommandID const & commandID) const
 {
-	return m_commandsMap.at(commandID);
+	auto const findResult = m_commandsIndex.find(commandID);
+	if (!findResult.first) {
+		throw std::out_of_range("Unknown command id: '" + commandID.getValue() + "'");
+	}
+	return findResult.second;
+}
+
+LINKAGE_RESTRICTION std::pair<bool, size_t> CommandsInfoContainer::findCommandIndex(CommandID const & commandID) const
+{
+	return m_commandsIndex.find(commandID);
 }
 
 LINKAGE_RESTRICTION bool CommandsInfoContainer::hasCommandID(CommandID const & commandID) const
 {
-	return m_commandsMap.find(commandID) != m_commandsMap.end();
+	return m_commandsIndex.find(commandID).first;
 }
 
 LINKAGE_RESTRICTION Command const & CommandsInfoContainer::getCommandPrefs(CommandID const & commandID) const
@@ -216,59 +272,136 @@ LINKAGE_RESTRICTION bool CommandsInfoContainer::operator == (CommandsInfoContain
 }
 
 namespace {
-template <typename LinesProcessingCallableObject>
-void processFileStream(std::istream & dataSource, size_t lineCounterStart, std::string const & fileTypeDescription, LinesProcessingCallableObject & dataProcessor, bool shouldClearByteOrderMarkOnFirstLine) {
-	auto tmpStr = std::string{};
+std::string getConfigLineErrorMessage(std::string const & fileTypeDescription, size_t lineNumber, std::runtime_error const & e)
+{
+	std::stringstream errorMessage;
+	errorMessage << "Error parsing the " << fileTypeDescription << " configuration file at line " << lineNumber << ":\n\t";
+	errorMessage << e.what();
+	return errorMessage.str();
+}
+
+// Calls the lineProcessor for each line of the config file, which holds data (empty or commented out lines are just skipped here). The line number is passed along with the line.
+template <typename LinesReader, typename LinesProcessingCallableObject>
+void forEachConfigDataLine(LinesReader & dataSource, size_t lineCounterStart, LinesProcessingCallableObject & lineProcessor, bool shouldClearByteOrderMarkOnFirstLine) {
+	auto currentLine = StringRef{};
 	size_t lineCount = lineCounterStart;
 	auto firstLine = true;
-	while (getLineFromFile(dataSource, tmpStr)) {
+	while (dataSource.getLine(currentLine)) {
 		if (shouldClearByteOrderMarkOnFirstLine && firstLine) { // This is a special case
-			tmpStr = clearUTF8_byteOrderMark(tmpStr);
+			currentLine = clearUTF8_byteOrderMark(currentLine);
 			firstLine = false;
 		}
 		++lineCount;
-		try {
-			size_t firstNonSpaceCharacterInd = tmpStr.find_first_not_of(" \t");
-			if ((firstNonSpaceCharacterInd != std::string::npos)
-				&& (tmpStr[firstNonSpaceCharacterInd] != '#')) // Empty (without any non-space symbols) or commented out lines are just skipped here
-			{
-				dataProcessor(tmpStr);
+		size_t firstNonSpaceCharacterInd = currentLine.find_first_not_of(" \t");
+		if ((firstNonSpaceCharacterInd != StringRef::npos)
+			&& (currentLine[firstNonSpaceCharacterInd] != '#'))
+		{
+			if (!lineProcessor(currentLine, lineCount)) {
+				return;
 			}
-		} catch (std::runtime_error & e) {
-			std::stringstream errorMessage;
-			errorMessage << "Error parsing the " << fileTypeDescription << " configuration file at line " << lineCount << ":\n\t";
-			errorMessage << e.what();
-			throw std::runtime_error(errorMessage.str());
 		}
 	}
 }
+
+template <typename LinesReader, typename LinesProcessingCallableObject>
+void processFileStream(LinesReader & dataSource, size_t lineCounterStart, std::string const & fileTypeDescription, LinesProcessingCallableObject & dataProcessor, bool shouldClearByteOrderMarkOnFirstLine) {
+	auto lineProcessor = [&fileTypeDescription, &dataProcessor](StringRef const & lineToProcess, size_t lineNumber) {
+		try {
+			dataProcessor(lineToProcess);
+		} catch (std::runtime_error & e) {
+			throw std::runtime_error(getConfigLineErrorMessage(fileTypeDescription, lineNumber, e));
+		}
+		return true;
+	};
+	forEachConfigDataLine(dataSource, lineCounterStart, lineProcessor, shouldClearByteOrderMarkOnFirstLine);
 }
 
-LINKAGE_RESTRICTION CommandsInfoContainer CommandsInfoContainer::parseConfigFile(std::istream & dataSource, HotkeyCombinationFactoryMethod hotkey_builder)
+// The first step of the PreparsedConfigFile creation. The rowPreprocessor should split the line and return the operation, which stores its data.
+// If the row is ill-formed, the preprocessing stops. The error is remembered and reported after the previous rows are stored.
+template <typename RowPreprocessingCallableObject>
+PreparsedConfigFile preparseConfigFile(StringRef const & configContents, std::string const & fileTypeDescription, RowPreprocessingCallableObject & rowPreprocessor)
+{
+	auto result = PreparsedConfigFile{ fileTypeDescription };
+	BufferLinesReader reader(configContents);
+	auto lineProcessor = [&result, &fileTypeDescription, &rowPreprocessor](StringRef const & lineToProcess, size_t lineNumber) {
+		try {
+			result.pushRow(lineNumber, rowPreprocessor(lineToProcess));
+		} catch (std::runtime_error & e) {
+			result.setError(getConfigLineErrorMessage(fileTypeDescription, lineNumber, e));
+			return false;
+		}
+		return true;
+	};
+	forEachConfigDataLine(reader, 0, lineProcessor, true);
+	return result;
+}
+}
+
+LINKAGE_RESTRICTION void PreparsedConfigFile::pushRow(size_t lineNumber, RowStoringOperation const & storingOperation)
 {
-	auto tmpStr = std::string{};
-	if (!getLineFromFile(dataSource, tmpStr)) {
+	m_rows.push_back(Row{ lineNumber, storingOperation });
+}
+
+LINKAGE_RESTRICTION void PreparsedConfigFile::setError(std::string const & errorMessage)
+{
+	m_hasError = true;
+	m_errorMessage = errorMessage;
+}
+
+LINKAGE_RESTRICTION void PreparsedConfigFile::storeTo(CommandsInfoContainer & target) const
+{
+	for (auto const & row : m_rows) {
+		try {
+			row.m_storingOperation(target);
+		} catch (std::runtime_error & e) {
+			throw std::runtime_error(getConfigLineErrorMessage(m_fileTypeDescription, row.m_lineNumber, e));
+		}
+	}
+	if (m_hasError) {
+		throw std::runtime_error(m_errorMessage);
+	}
+}
+
+template <typename LinesReader>
+CommandsInfoContainer CommandsInfoContainer::parseConfigLines(LinesReader & dataSource, HotkeyCombinationFactoryMethod hotkey_builder)
+{
+	auto headerLine = StringRef{};
+	if (!dataSource.getLine(headerLine)) {
 		throw std::runtime_error("No data in the commands config stream.");
 	}
-	auto result = CommandsInfoContainer(ParsedCsvRow::parseHeaderString(clearUTF8_byteOrderMark(tmpStr)));
+	auto result = CommandsInfoContainer(ParsedCsvRow::parseHeaderString(clearUTF8_byteOrderMark(headerLine)));
 
-	auto dataLineProcessor = [&result, &hotkey_builder](std::string const & lineToProcess) {
+	auto dataLineProcessor = [&result, &hotkey_builder](StringRef const & lineToProcess) {
 		result.pushDataRow(ParsedCsvRow::parseDataRowString(lineToProcess), hotkey_builder);
 	};
 	processFileStream(dataSource, 1, "command", dataLineProcessor, false);
 	return result;
 }
 
+LINKAGE_RESTRICTION CommandsInfoContainer CommandsInfoContainer::parseConfigFile(std::istream & dataSource, HotkeyCombinationFactoryMethod hotkey_builder)
+{
+	StreamLinesReader reader(dataSource);
+	return parseConfigLines(reader, hotkey_builder);
+}
+
+LINKAGE_RESTRICTION CommandsInfoContainer CommandsInfoContainer::parseConfigFile(StringRef const & configContents, HotkeyCombinationFactoryMethod hotkey_builder)
+{
+	BufferLinesReader reader(configContents);
+	return parseConfigLines(reader, hotkey_builder);
+}
+
 namespace {
 
+// Note: the map should be created with the transparent comparator (std::less<>), so that the lookup could be done by StringRef without creating a temporary std::string.
 template <typename ValueType>
 ValueType getElementOrThrow(
-	std::map<std::string, ValueType> const & elementsMatchups, 
-	std::string const & stringToDispatch,
+	std::map<std::string, ValueType, std::less<>> const & elementsMatchups, 
+	StringRef const & stringToDispatch,
 	std::string const & typeOfFileForErrorMessage)
 {
-	if (elementsMatchups.count(stringToDispatch) > 0) {
-		return elementsMatchups.at(stringToDispatch);
+	auto const foundElement = elementsMatchups.find(stringToDispatch);
+	if (foundElement != elementsMatchups.end()) {
+		return foundElement->second;
 	} else {
 		std::stringstream error;
 		error << "Unknown type of the command in the " << typeOfFileForErrorMessage << " file. This is what is enterpreted as the command type string (it may be caused by use of space delimiter instead of <TAB>): \n'" << stringToDispatch << "'";
@@ -281,7 +414,7 @@ ValueType getElementOrThrow(
 // preconditions: flagsForEnabledEnvironments.size() should be equal to the amount of environments in the system.
 //                environmentToIndexConverter should have the getEnvironmentIndex() function, which allows us to convert environment's string identifier into it's index
 void util_parseEnvironmentsEnablingString(
-	std::string const & stringToParse, 
+	StringRef const & stringToParse, 
 	std::vector<char> & flagsForEnabledEnvironments,
 	CommandsInfoContainer::EnvsContainer const & environmentsList,
 	std::string const & configTypeForErrorMessage)
@@ -290,8 +423,7 @@ void util_parseEnvironmentsEnablingString(
 		flagsForEnabledEnvironments.assign(
 			environmentsList.size(), 1); // setting the flags to 'all of the environments enabled'
 	} else {
-		auto elements = splitTheRow(stringToParse, ',');
-		for (auto & environment : elements) {
+		auto environmentsProcessor = [&](StringRef const & environment, size_t indexForString, bool moreDataInStream) -> bool {
 			auto indexFindResult = util_getEnvironmentIndex(environmentsList, environment);
 			if (indexFindResult.first) {
 				flagsForEnabledEnvironments[indexFindResult.second] = 1; // enable the given environment
@@ -301,25 +433,46 @@ void util_parseEnvironmentsEnablingString(
 					<< "\nWhole environments string: " << stringToParse;
 				throw std::runtime_error(error.str());
 			}
-		}
+			return true;
+		};
+		splitTheRow(stringToParse, ',', environmentsProcessor);
 	}
 }
 
 // Simple utility function for converting a string (which is read from config file) into a number, which it is supposed to represent
-size_t getUintFromStringOrThrow(std::string const & toParse)
+size_t getUintFromStringOrThrow(StringRef const & toParse)
 {
 	auto pos = toParse.find_first_not_of("0123456789");
-	if (pos != std::string::npos) {
+	if (pos != StringRef::npos) {
 		std::stringstream error;
 		error << "unexpected symbol in the string representing positive integer number (position - " << pos << "): " << toParse;
 		throw std::runtime_error(error.str());
 	}
 	size_t result {0};
-	std::stringstream mystream(toParse);
-	mystream >> result;
+	for (auto digit : toParse) {
+		result = result * 10 + static_cast<size_t>(digit - '0');
+	}
 	return result;
 }
 
+}
+
+namespace detail {
+
+// The factory methods for the command objects, which are created from the input sequences config rows.
+// Note: the struct is not in the anonymous namespace, because it is captured by the lambdas in the CommandsInfoContainer methods, which are compiled in the headers-only mode.
+struct InputObjectsFactories
+{
+	HotkeyCombinationFactoryMethod m_hotkeyBuilder;
+	MouseInputsFactoryMethod m_mouseInputsBuilder;
+	SleepInputsFactoryMethod m_sleepObjectsBuilder;
+	TextTypingFactoryMethod m_textTypingBuilder;
+};
+
+}
+
+namespace {
+
 // This is a simple class, which is used for processing the data lines read from the input_sequences config file by the splitTheRow() funcion.
 // Currently there are 2 types of the data lines in this config files: simple and aggregative.
 // Simple rows hold the command as the robot's format string, the aggregative rows hold commands,
@@ -327,22 +480,58 @@ size_t getUintFromStringOrThrow(std::string const & toParse)
 // Format of the row string:    <typeOfRow>\t<idOfCommand>\t<environments,for which the command is enabled>\t<command data>
 class MyInputSequencesDataProcessor {
 	enum class TypeOfRow {
-		SIMPLE_KEYBOARD_INPUT, SIMPLE_MOUSE_INPUT, SLEEP_OPERATION, SYSTEM_CALL, AGGREGATE, UNKNOWN
+		SIMPLE_KEYBOARD_INPUT, SIMPLE_MOUSE_INPUT, SLEEP_OPERATION, SYSTEM_CALL, TEXT_TYPING, AGGREGATE, UNKNOWN
 	};
 	TypeOfRow m_type = TypeOfRow::UNKNOWN;
-	CommandsInfoContainer const & m_targetContainerRef;
-	std::vector<std::string> m_accumulatedRawDataCells;
+	CommandsInfoContainer::EnvsContainer const & m_environments;
+	std::vector<StringRef> m_accumulatedRawDataCells; // Note: these are references inside the line, which is being processed. This object should not outlive it.
 	std::vector<char> m_shouldEnableCommandForGivenEnv;
-	std::string m_commandData;
+	StringRef m_commandData;
+
+	// Here we finish generating synthetic representation of the simple command (as if it was typed inside the csv_commands file).
+	// This is the only place, where the cells data is copied out of the line buffer.
+	ParsedCsvRow createRowToStore() const
+	{
+		auto rowData = std::vector<std::string>{};
+		rowData.reserve(m_accumulatedRawDataCells.size() + m_shouldEnableCommandForGivenEnv.size());
+		for (auto const & cell : m_accumulatedRawDataCells) {
+			rowData.push_back(std::string(cell));
+		}
+		for (auto flag : m_shouldEnableCommandForGivenEnv) {
+			rowData.push_back((flag == 1) ? std::string(m_commandData) : std::string{});
+		}
+		return hat::core::ParsedCsvRow(rowData);
+	}
+
+	static void storeRowTo(CommandsInfoContainer & target, TypeOfRow type, ParsedCsvRow const & rowToStore, detail::InputObjectsFactories const & factories)
+	{
+		if (TypeOfRow::SIMPLE_KEYBOARD_INPUT == type) {
+			target.pushDataRow(rowToStore, factories.m_hotkeyBuilder);
+		} else if (TypeOfRow::SIMPLE_MOUSE_INPUT == type) {
+			target.pushDataRowForMouseInput(rowToStore, factories.m_mouseInputsBuilder);
+		} else if (TypeOfRow::SLEEP_OPERATION == type) {
+			target.pushDataRowForSleepOperation(rowToStore, factories.m_sleepObjectsBuilder);
+		} else if (TypeOfRow::SYSTEM_CALL == type) {
+			target.pushDataRowForSystemCallCommand(rowToStore);
+		} else if (TypeOfRow::TEXT_TYPING == type) {
+			target.pushDataRowForTextTyping(rowToStore, factories.m_textTypingBuilder);
+		} else if (TypeOfRow::AGGREGATE == type) {
+			target.pushDataRowForAggregatedCommand(rowToStore);
+		} else {
+			// Unreachable code
+			throw std::runtime_error("Unsupported data type. Note: this exception should never be thrown (the issue should've been detected earlier).");
+		}
+	}
 
 public:
-	MyInputSequencesDataProcessor(CommandsInfoContainer const & targeContainerRef):m_targetContainerRef(targeContainerRef) {
+	MyInputSequencesDataProcessor(CommandsInfoContainer::EnvsContainer const & environments):m_environments(environments) {
+		m_accumulatedRawDataCells.reserve(4); // id, category, note and description
 		m_shouldEnableCommandForGivenEnv.assign(
-			m_targetContainerRef.getEnvironments().size(), 0); // setting the flags to 'none of the environments enabled'
+			m_environments.size(), 0); // setting the flags to 'none of the environments enabled'
 	}
 
 	// This is a verification operator that gets called when an object of this class is passed to the splitTheRow() function.
-	bool operator()(std::string const & extractedString, size_t indexForString, bool moreDataInStream) {
+	bool operator()(StringRef const & extractedString, size_t indexForString, bool moreDataInStream) {
 		if (indexForString == 0) {
 			if (extractedString == ConfigFilesKeywords::simpleTypingSeqCommand()) {
 				m_type = TypeOfRow::SIMPLE_KEYBOARD_INPUT;
@@ -352,6 +541,8 @@ public:
 				m_type = TypeOfRow::SLEEP_OPERATION;
 			} else if (extractedString == ConfigFilesKeywords::systemCallCommand()) {
 				m_type = TypeOfRow::SYSTEM_CALL;
+			} else if (extractedString == ConfigFilesKeywords::textTypingCommand()) {
+				m_type = TypeOfRow::TEXT_TYPING;
 			} else if (extractedString == ConfigFilesKeywords::aggregatedSetOfCommands()) {
 				m_type = TypeOfRow::AGGREGATE;
 			} else {
@@ -364,15 +555,16 @@ public:
 				|| (TypeOfRow::SIMPLE_MOUSE_INPUT == m_type)
 				|| (TypeOfRow::SLEEP_OPERATION == m_type)
 				|| (TypeOfRow::SYSTEM_CALL == m_type)
+				|| (TypeOfRow::TEXT_TYPING == m_type)
 				|| (TypeOfRow::AGGREGATE == m_type))
 			{
 				m_accumulatedRawDataCells.push_back(extractedString);
-				return getCsvCommandDataRowElementsProcessor()(extractedString, indexForString - 1, moreDataInStream);
+				return detail::getCsvCommandDataRowElementsProcessor()(extractedString, indexForString - 1, moreDataInStream);
 			} else {
 				throw std::runtime_error("Unsupported data type"); //TODO: add better error message here
 			}
 		} else if (indexForString == 5) { //determine the environments, for which this command is enabled from the environments string:
-			util_parseEnvironmentsEnablingString(extractedString, m_shouldEnableCommandForGivenEnv, m_targetContainerRef.getEnvironments(), "input sequences file");
+			util_parseEnvironmentsEnablingString(extractedString, m_shouldEnableCommandForGivenEnv, m_environments, "input sequences file");
 		} else if (indexForString == 6) {
 			m_commandData = extractedString;
 		} else {
@@ -384,29 +576,19 @@ public:
 	}
 
 	// This method determines the type of data, which should be pushed into the target container and passes the data to it in the needed format.
-	void storeAccumulatedDataTo(CommandsInfoContainer & target, HotkeyCombinationFactoryMethod hotkey_builder, MouseInputsFactoryMethod mouse_inputs_builder, SleepInputsFactoryMethod sleep_objects_builder)
+	void storeAccumulatedDataTo(CommandsInfoContainer & target, detail::InputObjectsFactories const & factories) const
 	{
-		for (auto flag : m_shouldEnableCommandForGivenEnv) { // here we finish generating synthetic representation of the simple command (as if it was typed inside the csv_commands file), and then pass the data to the target container.
-			m_accumulatedRawDataCells.push_back((flag == 1) ? m_commandData : "");
-		}
-		if (TypeOfRow::SIMPLE_KEYBOARD_INPUT == m_type) {
-			target.pushDataRow(hat::core::ParsedCsvRow(m_accumulatedRawDataCells), hotkey_builder);
-		} else if (TypeOfRow::SIMPLE_MOUSE_INPUT == m_type) {
-			target.pushDataRowForMouseInput(
-				hat::core::ParsedCsvRow(m_accumulatedRawDataCells), mouse_inputs_builder);
-		} else if (TypeOfRow::SLEEP_OPERATION == m_type) {
-			target.pushDataRowForSleepOperation(
-				hat::core::ParsedCsvRow(m_accumulatedRawDataCells), sleep_objects_builder);
-		} else if (TypeOfRow::SYSTEM_CALL == m_type) {
-			target.pushDataRowForSystemCallCommand(
-				hat::core::ParsedCsvRow(m_accumulatedRawDataCells));
-		} else if (TypeOfRow::AGGREGATE == m_type) {
-			target.pushDataRowForAggregatedCommand(
-				hat::core::ParsedCsvRow(m_accumulatedRawDataCells));
-		} else {
-			// Unreachable code
-			throw std::runtime_error("Unsupported data type. Note: this exception should never be thrown (the issue should've been detected earlier).");
-		}
+		storeRowTo(target, m_type, createRowToStore(), factories);
+	}
+
+	// Same as storeAccumulatedDataTo(), but the data is stored later (see PreparsedConfigFile). The row data is copied out of the line buffer right away.
+	PreparsedConfigFile::RowStoringOperation createDelayedStoringOperation(std::shared_ptr<detail::InputObjectsFactories const> const & factories) const
+	{
+		auto const type = m_type;
+		auto const rowToStore = createRowToStore();
+		return [type, rowToStore, factories](CommandsInfoContainer & target) {
+			storeRowTo(target, type, rowToStore, *factories);
+		};
 	}
 };
 
@@ -422,8 +604,8 @@ class TextFeedbackLogicConfigurationProcessor {
 		APPEND_VALUE,
 		UNKNOWN
 	};
-	static std::map<std::string, TypeOfRow> const & getRowTypesMap() {
-		static std::map<std::string, TypeOfRow> 
+	static std::map<std::string, TypeOfRow, std::less<>> const & getRowTypesMap() {
+		static std::map<std::string, TypeOfRow, std::less<>> 
 			mymap{ 
 				 {ConfigFilesKeywords::defineInternalLabelVariable(), TypeOfRow::VARIABLE_DECLARATION}
 				,{ConfigFilesKeywords::textFeedbackSetInitialValue(), TypeOfRow::INITIAL_VALUE_FOR_VARIABLE}
@@ -437,31 +619,63 @@ class TextFeedbackLogicConfigurationProcessor {
 	}
 	TypeOfRow m_type = TypeOfRow::UNKNOWN;
 
-	CommandsInfoContainer const & m_targetContainerRef;
-	std::vector<std::string> m_accumulatedRawDataCells;
+	CommandsInfoContainer::EnvsContainer const & m_environments;
 	std::vector<char> m_shouldEnableCommandForGivenEnv;
+	size_t m_processedCellsCount = 0;
 
 	VariableID m_variableID;
 	CommandID m_triggerCommand;
-	std::string m_stringParameterValue;
-public:
-	TextFeedbackLogicConfigurationProcessor(CommandsInfoContainer const & targeContainerRef)
-		: m_targetContainerRef(targeContainerRef)
-	{
-		m_shouldEnableCommandForGivenEnv.assign(
-			m_targetContainerRef.getEnvironments().size(), 0); // setting the flags to 'none of the environments enabled'
-	}
+	StringRef m_stringParameterValue; // Note: this is a reference inside the line, which is being processed. This object should not outlive it.
 
-	void ensureTargetVariableExistsAndStoreIt(std::string const & value) {
-		m_variableID = VariableID{ value };
-		if (!(m_targetContainerRef.isVariableDeclaredInManagers(m_variableID))) {
+	void ensureTargetVariableExists(CommandsInfoContainer const & target) const {
+		if (!(target.isVariableDeclaredInManagers(m_variableID))) {
 			std::stringstream error;
-			error << "Unknown variable id (" << value << ") provided as a target for the operation. Please declare a variable before using it.";
+			error << "Unknown variable id (" << m_variableID.getValue() << ") provided as a target for the operation. Please declare a variable before using it.";
 			throw std::runtime_error(error.str());
 		}
 	}
 
-	bool operator()(std::string const & extractedString, size_t indexForString, bool moreDataInStream)
+	// The references to the commands and variables depend on the data from the other rows (and config files), so they are not checked during the row splitting.
+	// They are checked right before the data is stored into the target container (in the same order as the cells go in the row).
+	void ensureReferencedObjectsExist(CommandsInfoContainer const & target) const
+	{
+		if (TypeOfRow::VARIABLE_DECLARATION == m_type) {
+			if (target.isVariableDeclaredInManagers(m_variableID)) {
+				std::stringstream error;
+				error << "Variable redefinition (variableID = " << m_variableID.getValue() << "). This is not allowed.";
+				throw std::runtime_error(error.str());
+			}
+		} else if (TypeOfRow::INITIAL_VALUE_FOR_VARIABLE == m_type) {
+			if (m_processedCellsCount > 2) {
+				ensureTargetVariableExists(target);
+			}
+		} else {
+			if ((m_processedCellsCount > 2) && !target.hasCommandID(m_triggerCommand)) {
+				std::stringstream error;
+				error << "Unknown trigger command referenced by the variable operation descriptor: " << m_triggerCommand.getValue();
+				throw std::runtime_error(error.str());
+			}
+			if (m_processedCellsCount > 3) {
+				ensureTargetVariableExists(target);
+			}
+			if ((m_processedCellsCount > 4) && ((TypeOfRow::ASSIGN_VALUE == m_type) || (TypeOfRow::APPEND_VALUE == m_type))) {
+				if (!target.isVariableDeclaredInManagers(VariableID{std::string(m_stringParameterValue)})) {
+					std::stringstream error;
+					error << "Trying to append/assign value from an unknown variable (variableID = " << m_stringParameterValue << ". Please declare the variable before referencing it.";
+					throw std::runtime_error(error.str());
+				}
+			}
+		}
+	}
+public:
+	TextFeedbackLogicConfigurationProcessor(CommandsInfoContainer::EnvsContainer const & environments)
+		: m_environments(environments)
+	{
+		m_shouldEnableCommandForGivenEnv.assign(
+			m_environments.size(), 0); // setting the flags to 'none of the environments enabled'
+	}
+
+	bool operator()(StringRef const & extractedString, size_t indexForString, bool moreDataInStream)
 	{
 		auto throwErrorOnTooManyStringElements = []()
 		{
@@ -475,6 +689,7 @@ public:
 			throw std::runtime_error(error.str());
 		};
 		
+		m_processedCellsCount = indexForString + 1;
 		if (indexForString == 0) {
 			m_type = getElementOrThrow<TypeOfRow>(getRowTypesMap(), extractedString, "text feedback");
 			if (!moreDataInStream) {
@@ -483,14 +698,8 @@ public:
 		} else if (indexForString == 1) { //determine the environments, for which this command is enabled from the environments string:
 			if (TypeOfRow::VARIABLE_DECLARATION == m_type) {
 				
-				//Note: here we should not verify the existance of the variable (since we are declaring it right now). But we should check the re-definition
-				m_variableID = VariableID::createFromUserString(extractedString);
-				
-				if (m_targetContainerRef.isVariableDeclaredInManagers(m_variableID)) {
-					std::stringstream error;
-					error << "Variable redefinition (variableID = " << m_variableID.getValue() << "). This is not allowed.";
-					throw std::runtime_error(error.str());
-				}
+				//Note: here we should not verify the existance of the variable (since we are declaring it right now). The re-definition is checked before storing the data.
+				m_variableID = VariableID::createFromUserString(std::string(extractedString));
 				if (moreDataInStream) { // last element for this type of row, so if there is more data, we should throw error
 					throwErrorOnTooManyStringElements();
 				}
@@ -500,27 +709,23 @@ public:
 					error << "Error: no environments specified for the variable operation. It will have no effect during runtime. This is not allowed in variable manager's configuratoin. Either add at least one environment, or comment this line out.";
 					throw std::runtime_error(error.str());
 				}
-				util_parseEnvironmentsEnablingString(extractedString, m_shouldEnableCommandForGivenEnv, m_targetContainerRef.getEnvironments(), "input sequences file");
+				util_parseEnvironmentsEnablingString(extractedString, m_shouldEnableCommandForGivenEnv, m_environments, "input sequences file");
 				if (!moreDataInStream) {
 					throwOnNotEnoughArguments();
 				}
 			}
 		} else if (indexForString == 2) {
 			if (TypeOfRow::INITIAL_VALUE_FOR_VARIABLE == m_type) {
-				ensureTargetVariableExistsAndStoreIt(extractedString);
+				m_variableID = VariableID{ std::string(extractedString) };
 				if (!moreDataInStream) {
 					throwOnNotEnoughArguments();
 				}
 			} else {
-				m_triggerCommand = CommandID{extractedString};
-				if (!m_targetContainerRef.hasCommandID(m_triggerCommand)) {
-					std::stringstream error;
-					error << "Unknown trigger command referenced by the variable operation descriptor: " << extractedString;
-					throw std::runtime_error(error.str());
-				}
+				m_triggerCommand = CommandID{std::string(extractedString)};
 			}
 		} else if (indexForString == 3) {
 			if (TypeOfRow::INITIAL_VALUE_FOR_VARIABLE == m_type) {
+				ensureValidUTF8(extractedString); // the value is displayed on the client
 				m_stringParameterValue = extractedString;
 				if (moreDataInStream) { //last element for this type of row, so if there is more data, we should throw error
 					throwErrorOnTooManyStringElements();
@@ -529,25 +734,23 @@ public:
 				if (!moreDataInStream) {
 					throwOnNotEnoughArguments();
 				}
-				ensureTargetVariableExistsAndStoreIt(extractedString);
+				m_variableID = VariableID{ std::string(extractedString) };
 			}
 		} else if (indexForString == 4) {
-			m_stringParameterValue = extractedString;
-			if ((TypeOfRow::ASSIGN_VALUE == m_type) || (TypeOfRow::APPEND_VALUE == m_type)) {
-				if (!m_targetContainerRef.isVariableDeclaredInManagers(VariableID{m_stringParameterValue})) {
-					std::stringstream error;
-					error << "Trying to append/assign value from an unknown variable (variableID = " << m_stringParameterValue << ". Please declare the variable before referencing it.";
-					throw std::runtime_error(error.str());
-				}
+			if ((TypeOfRow::ASSIGN_TEXT == m_type) || (TypeOfRow::APPEND_TEXT == m_type)) {
+				ensureValidUTF8(extractedString); // the text becomes the part of the value, which is displayed on the client
 			}
+			m_stringParameterValue = extractedString;
 			if (moreDataInStream) {
 				throwErrorOnTooManyStringElements();
 			}
 		}
 		return true;
 	}
-	void storeAccumulatedDataTo(CommandsInfoContainer & target)
+	void storeAccumulatedDataTo(CommandsInfoContainer & target) const
 	{
+		ensureReferencedObjectsExist(target);
+
 		// Some sugar: 2 lambdas for making the code below less dense:
 		auto forEachEnabledEnv = [&](std::function<void (VariablesManager & )> operation) {
 			for (size_t i = 0; i < m_shouldEnableCommandForGivenEnv.size(); ++i) {
@@ -570,19 +773,19 @@ public:
 			break;
 		case TypeOfRow::INITIAL_VALUE_FOR_VARIABLE:
 			forEachEnabledEnv([&](VariablesManager & manager) {
-				manager.setVariableInitialValue(m_variableID, m_stringParameterValue);
+				manager.setVariableInitialValue(m_variableID, std::string(m_stringParameterValue));
 			});
 			break;
 		case TypeOfRow::ASSIGN_TEXT:
 			forEachEnabledEnv([&](VariablesManager & manager) {
 				addOnCommandOperation(manager, std::make_shared<AssignText>(
-					m_variableID, m_stringParameterValue));
+					m_variableID, std::string(m_stringParameterValue)));
 			});
 			break;
 		case TypeOfRow::APPEND_TEXT:
 			forEachEnabledEnv([&](VariablesManager & manager) {
 				addOnCommandOperation(manager, std::make_shared<AppendText>(
-					m_variableID, m_stringParameterValue));
+					m_variableID, std::string(m_stringParameterValue)));
 			});
 			break;
 		case TypeOfRow::CLEAR_LAST_CHARACTERS:
@@ -601,43 +804,99 @@ public:
 		case TypeOfRow::ASSIGN_VALUE:
 			forEachEnabledEnv([&](VariablesManager & manager) {
 				addOnCommandOperation(manager, std::make_shared<AssignValue>(
-					m_variableID, VariableID{ m_stringParameterValue }));
+					m_variableID, VariableID{ std::string(m_stringParameterValue) }));
 			});
 			break;
 		case TypeOfRow::APPEND_VALUE:
 			forEachEnabledEnv([&](VariablesManager & manager) {
 				addOnCommandOperation(manager, std::make_shared<AppendValue>(
-					m_variableID, VariableID{ m_stringParameterValue }));
+					m_variableID, VariableID{ std::string(m_stringParameterValue) }));
 			});
 			break;
 		case TypeOfRow::UNKNOWN:
 			throw std::runtime_error("Unsupported text feedback row type. Note: this exception should never be thrown (the issue should've been detected earlier)."); //unreachable code
 		}
 	}
+
+	// Same as storeAccumulatedDataTo(), but the data is stored later (see PreparsedConfigFile).
+	// Note: the string parameter still references the config file contents, so they should outlive the returned operation.
+	PreparsedConfigFile::RowStoringOperation createDelayedStoringOperation() const
+	{
+		auto const rowProcessor = *this;
+		return [rowProcessor](CommandsInfoContainer & target) {
+			rowProcessor.storeAccumulatedDataTo(target);
+		};
+	}
 };
 
 }
 
-LINKAGE_RESTRICTION void CommandsInfoContainer::consumeInputSequencesConfigFile(std::istream & dataSource, HotkeyCombinationFactoryMethod hotkey_builder, MouseInputsFactoryMethod mouse_inputs_builder, SleepInputsFactoryMethod sleep_objects_builder)
+template <typename LinesReader>
+void CommandsInfoContainer::consumeInputSequencesConfigLines(LinesReader & dataSource, HotkeyCombinationFactoryMethod hotkey_builder, MouseInputsFactoryMethod mouse_inputs_builder, SleepInputsFactoryMethod sleep_objects_builder, TextTypingFactoryMethod text_typing_builder)
 {
-	auto dataLineProcessor = [this, &hotkey_builder, &mouse_inputs_builder, &sleep_objects_builder](std::string const & lineToProcess) {
-		MyInputSequencesDataProcessor rowProcessor(*this);
-		auto rowElements = splitTheRow(lineToProcess, '\t', rowProcessor);
-		rowProcessor.storeAccumulatedDataTo(*this, hotkey_builder, mouse_inputs_builder, sleep_objects_builder);
+	auto const factories = detail::InputObjectsFactories{ hotkey_builder, mouse_inputs_builder, sleep_objects_builder, text_typing_builder };
+	auto dataLineProcessor = [this, &factories](StringRef const & lineToProcess) {
+		MyInputSequencesDataProcessor rowProcessor(m_environments);
+		splitTheRow(lineToProcess, '\t', rowProcessor);
+		rowProcessor.storeAccumulatedDataTo(*this, factories);
 	};
 	processFileStream(dataSource, 0, "input sequences", dataLineProcessor, true);
 }
 
-LINKAGE_RESTRICTION void CommandsInfoContainer::consumeVariablesManagersConfig(std::istream & dataSource)
+LINKAGE_RESTRICTION void CommandsInfoContainer::consumeInputSequencesConfigFile(std::istream & dataSource, HotkeyCombinationFactoryMethod hotkey_builder, MouseInputsFactoryMethod mouse_inputs_builder, SleepInputsFactoryMethod sleep_objects_builder, TextTypingFactoryMethod text_typing_builder)
+{
+	StreamLinesReader reader(dataSource);
+	consumeInputSequencesConfigLines(reader, hotkey_builder, mouse_inputs_builder, sleep_objects_builder, text_typing_builder);
+}
+
+LINKAGE_RESTRICTION void CommandsInfoContainer::consumeInputSequencesConfigFile(StringRef const & configContents, HotkeyCombinationFactoryMethod hotkey_builder, MouseInputsFactoryMethod mouse_inputs_builder, SleepInputsFactoryMethod sleep_objects_builder, TextTypingFactoryMethod text_typing_builder)
 {
-	auto dataLineProcessor = [this](std::string const & lineToProcess) {
-		TextFeedbackLogicConfigurationProcessor rowProcessor(*this);
-		auto rowElements = splitTheRow(lineToProcess, '\t', rowProcessor);
+	preparseInputSequencesConfigFile(configContents, m_environments, hotkey_builder, mouse_inputs_builder, sleep_objects_builder, text_typing_builder).storeTo(*this);
+}
+
+LINKAGE_RESTRICTION PreparsedConfigFile CommandsInfoContainer::preparseInputSequencesConfigFile(StringRef const & configContents, EnvsContainer const & environments, HotkeyCombinationFactoryMethod hotkey_builder, MouseInputsFactoryMethod mouse_inputs_builder, SleepInputsFactoryMethod sleep_objects_builder, TextTypingFactoryMethod text_typing_builder)
+{
+	auto const factories = std::make_shared<detail::InputObjectsFactories const>(detail::InputObjectsFactories{ hotkey_builder, mouse_inputs_builder, sleep_objects_builder, text_typing_builder });
+	auto rowPreprocessor = [&environments, &factories](StringRef const & lineToProcess) {
+		MyInputSequencesDataProcessor rowProcessor(environments);
+		splitTheRow(lineToProcess, '\t', rowProcessor);
+		return rowProcessor.createDelayedStoringOperation(factories);
+	};
+	return preparseConfigFile(configContents, "input sequences", rowPreprocessor);
+}
+
+template <typename LinesReader>
+void CommandsInfoContainer::consumeVariablesManagersConfigLines(LinesReader & dataSource)
+{
+	auto dataLineProcessor = [this](StringRef const & lineToProcess) {
+		TextFeedbackLogicConfigurationProcessor rowProcessor(m_environments);
+		splitTheRow(lineToProcess, '\t', rowProcessor);
 		rowProcessor.storeAccumulatedDataTo(*this);
 	};
 	processFileStream(dataSource, 0, "text variables behaviour logic", dataLineProcessor, true);
 }
 
+LINKAGE_RESTRICTION void CommandsInfoContainer::consumeVariablesManagersConfig(std::istream & dataSource)
+{
+	StreamLinesReader reader(dataSource);
+	consumeVariablesManagersConfigLines(reader);
+}
+
+LINKAGE_RESTRICTION void CommandsInfoContainer::consumeVariablesManagersConfig(StringRef const & configContents)
+{
+	preparseVariablesManagersConfig(configContents, m_environments).storeTo(*this);
+}
+
+LINKAGE_RESTRICTION PreparsedConfigFile CommandsInfoContainer::preparseVariablesManagersConfig(StringRef const & configContents, EnvsContainer const & environments)
+{
+	auto rowPreprocessor = [&environments](StringRef const & lineToProcess) {
+		TextFeedbackLogicConfigurationProcessor rowProcessor(environments);
+		splitTheRow(lineToProcess, '\t', rowProcessor);
+		return rowProcessor.createDelayedStoringOperation();
+	};
+	return preparseConfigFile(configContents, "text variables behaviour logic", rowPreprocessor);
+}
+
 LINKAGE_RESTRICTION void CommandsInfoContainer::pushDataRow(hat::core::ParsedCsvRow const & data)
 {
 	auto myLambda =  [] (std::string const & param, CommandID const & commandID, size_t env_index) {
@@ -655,7 +914,7 @@ LINKAGE_RESTRICTION CommandID CommandsInfoContainer::ensureMandatoryCommandAttri
 		throw std::runtime_error(errorMessage.str());
 	}
 	auto commandID = CommandID{ data.m_customColumns[0] };
-	if (m_commandsMap.find(commandID) != m_commandsMap.end()) {
+	if (hasCommandID(commandID)) {
 		std::stringstream errorMessage;
 		errorMessage << "A duplicate command id found: '" << commandID.getValue() << "'. This is not allowed.";
 		throw std::runtime_error(errorMessage.str());
@@ -691,25 +950,54 @@ LINKAGE_RESTRICTION void CommandsInfoContainer::pushDataRowForSystemCallCommand(
 	));
 }
 
+LINKAGE_RESTRICTION void CommandsInfoContainer::pushDataRowForTextTyping(hat::core::ParsedCsvRow const & data, TextTypingFactoryMethod text_typing_builder)
+{
+	auto commandID = ensureMandatoryCommandAttributesAreCorrect(data);
+	storeCommandObject(commandID, Command::create(data, m_environments.size(), text_typing_builder));
+}
+
 LINKAGE_RESTRICTION void CommandsInfoContainer::pushDataRowForAggregatedCommand(hat::core::ParsedCsvRow const & data)
 {
 	auto commandID = ensureMandatoryCommandAttributesAreCorrect(data);
 	auto myLambda = [this](std::string const & commandStringRepresentation, CommandID const & commandID, size_t env_index) {
-		auto commandIDs = splitTheRow(commandStringRepresentation, ',');
 		auto commandsPointers = InputSequencesCollection::CommandsSequence{};
 		auto should_enable = false;
-		for (auto & currentCommandID : commandIDs) {
-			auto key = CommandID{ currentCommandID };
+		auto commandIDsProcessor = [&](StringRef const & currentCommandID, size_t indexForString, bool moreDataInStream) -> bool {
+			auto key = CommandID{ std::string(currentCommandID) };
 			if (hasCommandID(key)) {
-				auto commandPrefs = getCommandPrefs(key);
-				commandsPointers.push_back(commandPrefs.hotkeysForEnvironments[env_index].get());
+				auto const & commandPrefs = getCommandPrefs(key);
+				commandsPointers.push_back(commandPrefs.hotkeysForEnvironments[env_index]);
 				should_enable = true;
 			} else {
 				std::stringstream errorMessage; 
 				errorMessage << "Could not find the command with id '" << currentCommandID << "' during generation of the 'aggregatedCommand' object.";
 				throw std::runtime_error(errorMessage.str());
 			}
+			return true;
+		};
+		splitTheRow(commandStringRepresentation, ',', commandIDsProcessor);
+		return std::make_shared<InputSequencesCollection>(
+			commandsPointers, commandStringRepresentation, should_enable);
+	};
+	storeCommandObject(commandID, Command::create(data, m_environments.size(), myLambda));
+}
+
+LINKAGE_RESTRICTION void CommandsInfoContainer::pushDataRowForAggregatedCommand(hat::core::ParsedCsvRow const & data, std::vector<std::vector<size_t>> const & referencedCommandsIndices)
+{
+	auto commandID = ensureMandatoryCommandAttributesAreCorrect(data);
+	auto myLambda = [this, &referencedCommandsIndices](std::string const & commandStringRepresentation, CommandID const & commandID, size_t env_index) {
+		auto commandsPointers = InputSequencesCollection::CommandsSequence{};
+		if (env_index < referencedCommandsIndices.size()) {
+			for (auto const commandIndex : referencedCommandsIndices[env_index]) {
+				if (commandIndex >= m_commandsList.size()) {
+					std::stringstream errorMessage;
+					errorMessage << "The command with index " << commandIndex << " is referenced by the 'aggregatedCommand' object (id='" << commandID.getValue() << "') before it is defined.";
+					throw std::runtime_error(errorMessage.str());
+				}
+				commandsPointers.push_back(m_commandsList[commandIndex].hotkeysForEnvironments[env_index]);
+			}
 		}
+		auto const should_enable = !commandsPointers.empty();
 		return std::make_shared<InputSequencesCollection>(
 			commandsPointers, commandStringRepresentation, should_enable);
 	};
@@ -718,18 +1006,19 @@ LINKAGE_RESTRICTION void CommandsInfoContainer::pushDataRowForAggregatedCommand(
 
 LINKAGE_RESTRICTION void CommandsInfoContainer::storeCommandObject(CommandID const & commandID, Command const & commandToStore)
 {
-	m_commandsMap.emplace(commandID, m_commandsList.size());
+	m_commandsIndex.add(commandID);
 	m_commandsList.push_back(commandToStore);
+	for (size_t environmentIndex = 0; environmentIndex < m_enabledCommandsForEnvironments.size(); ++environmentIndex) {
+		m_enabledCommandsForEnvironments[environmentIndex].push_back(commandToStore.hotkeysForEnvironments[environmentIndex]->enabled);
+	}
 }
 namespace {
-std::pair<bool, XY_Dimensions> parseXY_dimensionsConfigString(std::string const & toParse)
+std::pair<bool, XY_Dimensions> parseXY_dimensionsConfigString(StringRef const & toParse)
 {
 	try {
-		std::stringstream myStream(toParse);
-		std::string x_str;
-		std::string y_str;
-		std::getline(myStream, x_str, ',');
-		std::getline(myStream, y_str);
+		auto const delimiterPosition = toParse.find(',');
+		auto const x_str = toParse.substr(0, delimiterPosition);
+		auto const y_str = (delimiterPosition == StringRef::npos) ? StringRef{} : toParse.substr(delimiterPosition + 1);
 		if ((x_str.size() == 0) || (y_str.size() == 0)) {
 			throw std::runtime_error("One of the coordinates is empty string.");
 		}
@@ -768,13 +1057,13 @@ public:
 		m_shouldEnableCommandForGivenEnv.assign(
 			environmentsList.size(), 0);
 	}
-	bool operator()(std::string const & extractedString, size_t indexForString, bool moreDataInStream)
+	bool operator()(StringRef const & extractedString, size_t indexForString, bool moreDataInStream)
 	{
 		if (indexForString == 0) {
 			if (extractedString.size() == 0) {
 				throw std::runtime_error("CommandID is an empty string in the configuration file line. This is not allowed. Please provide valid command id.");
 			}
-			m_commandID = CommandID{extractedString};
+			m_commandID = CommandID{std::string(extractedString)};
 			if (!moreDataInStream) { reportErrorForTooLittleParametersCount(1); }
 		} else if (indexForString == 1) { // Environments in which the image should be enabled
 			if (extractedString == "*") {
@@ -789,7 +1078,7 @@ public:
 			if (!moreDataInStream) { reportErrorForTooLittleParametersCount(2); }
 		} else if (indexForString == 2) { // ImageID
 			if (extractedString.size() > 0) {
-				m_imageID = ImageID{extractedString};
+				m_imageID = ImageID{std::string(extractedString)};
 			}
 			if (moreDataInStream) {
 				std::stringstream errorMessage; 
@@ -828,20 +1117,20 @@ class ImageResourceConfigurationProcessor_ImageID2PhysicalImage
 	ImageID m_imageID;
 
 public:
-	bool operator()(std::string const & extractedString, size_t indexForString, bool moreDataInStream)
+	bool operator()(StringRef const & extractedString, size_t indexForString, bool moreDataInStream)
 	{
 		if (indexForString == 0) {
 			if (extractedString.size() == 0) { // ImageID
 				throw std::runtime_error("ImageID is an empty string in the configuration file line. This is not allowed. Please provide valid command id.");
 			}
-			m_imageID = ImageID{extractedString};
+			m_imageID = ImageID{std::string(extractedString)};
 			if (!moreDataInStream) { 
 				util_reportErrorForTooLittleParametersCount(
 					1, "At least 2 parameters are needed (imageID, image file path)");
 			}
 		} else if (indexForString == 1) { // Filename for the image
 			if (extractedString.size() > 0) {
-				m_imagePhysicalInfo.filepath = extractedString;
+				m_imagePhysicalInfo.filepath = std::string(extractedString);
 			} else {
 				throw std::runtime_error("Filename is an empty string in the configuration file line. This is not allowed. Please provide a valid image file name.");
 			}
@@ -890,28 +1179,44 @@ LINKAGE_RESTRICTION ImageResourcesInfosContainer::EnvironmentImagesMapping const
 	return m_mapper.at(environment);
 }
 
-LINKAGE_RESTRICTION void ImageResourcesInfosContainer::consumeImageResourcesConfig(
-	std::istream & imageID2physicalImageConfig, std::istream & commandID2imageIDConfig)
+template <typename LinesReader>
+void ImageResourcesInfosContainer::consumeImageResourcesConfigLines(LinesReader & imageID2physicalImageConfig, LinesReader & commandID2imageIDConfig)
 {
 	{
-		auto dataLineProcessor = [this](std::string const & lineToProcess) {
+		auto dataLineProcessor = [this](StringRef const & lineToProcess) {
 			ImageResourceConfigurationProcessor_ImageID2PhysicalImage rowProcessor{};
-			auto rowElements = splitTheRow(lineToProcess, '\t', rowProcessor);
+			splitTheRow(lineToProcess, '\t', rowProcessor);
 			rowProcessor.storeAccumulatedDataTo(*this);
 		};
 		processFileStream(imageID2physicalImageConfig, 0, "imageID -> physical image info config", dataLineProcessor, true);
 	}
 
 	{
-		auto dataLineProcessor = [this](std::string const & lineToProcess) {
+		auto dataLineProcessor = [this](StringRef const & lineToProcess) {
 			ImageResourceConfigurationProcessor_CommandID2ImageID rowProcessor{m_environments};
-			auto rowElements = splitTheRow(lineToProcess, '\t', rowProcessor);
+			splitTheRow(lineToProcess, '\t', rowProcessor);
 			rowProcessor.storeAccumulatedDataTo(*this);
 		};
 		processFileStream(commandID2imageIDConfig, 0, "commandID+environments -> imageID config", dataLineProcessor, true);
 	}
 }
 
+LINKAGE_RESTRICTION void ImageResourcesInfosContainer::consumeImageResourcesConfig(
+	std::istream & imageID2physicalImageConfig, std::istream & commandID2imageIDConfig)
+{
+	StreamLinesReader imageID2physicalImageReader(imageID2physicalImageConfig);
+	StreamLinesReader commandID2imageIDReader(commandID2imageIDConfig);
+	consumeImageResourcesConfigLines(imageID2physicalImageReader, commandID2imageIDReader);
+}
+
+LINKAGE_RESTRICTION void ImageResourcesInfosContainer::consumeImageResourcesConfig(
+	StringRef const & imageID2physicalImageConfig, StringRef const & commandID2imageIDConfig)
+{
+	BufferLinesReader imageID2physicalImageReader(imageID2physicalImageConfig);
+	BufferLinesReader commandID2imageIDReader(commandID2imageIDConfig);
+	consumeImageResourcesConfigLines(imageID2physicalImageReader, commandID2imageIDReader);
+}
+
 LINKAGE_RESTRICTION void ImageResourcesInfosContainer::mapPhysicalImageInfoToID(ImageID const & imgID, ImagePhysicalInfo const & imgInfo)
 {
 	if (m_imgIDs.find(imgID) != m_imgIDs.end()) {
@@ -959,6 +1264,11 @@ LINKAGE_RESTRICTION std::vector<ImageID> ImageResourcesInfosContainer::getAllReg
 	return result;
 }
 
+LINKAGE_RESTRICTION bool ImageResourcesInfosContainer::operator == (ImageResourcesInfosContainer const & other) const
+{
+	return (m_environments == other.m_environments) && (m_imgIDs == other.m_imgIDs) && (m_mapper == other.m_mapper);
+}
+
 LINKAGE_RESTRICTION void ImageResourcesInfosContainer::addImageReferenceForAllEnvs(CommandID const & command, ImageID const & imgID)
 {
 	for (auto & elem : m_mapper) {
@@ -995,16 +1305,39 @@ LINKAGE_RESTRICTION void AbstractSimulatedUserInput::execute()
 		std::cout << "Processing command request on disabled (for this environment) element. Nothing happened.\n";
 	}
 }
+LINKAGE_RESTRICTION InputTimeline InputSequencesCollection::compileTimeline(CommandsSequence const & commandsToExecute)
+{
+	// Note: the referenced commands are always created before the collection, so the timelines of the nested collections are already compiled here.
+	auto result = InputTimeline{};
+	auto pendingDelay = std::chrono::milliseconds{ 0 };
+	for (auto const & commandToExecute : commandsToExecute) {
+		auto const element = commandToExecute.get();
+		if (!element->enabled) {
+			continue; // the command is not defined for the environment, so nothing is executed for it
+		}
+		if (auto sleepOperation = dynamic_cast<SimpleSleepOperation const *>(element)) {
+			pendingDelay += std::chrono::milliseconds{ sleepOperation->m_delay };
+		} else if (auto nestedCollection = dynamic_cast<InputSequencesCollection const *>(element)) {
+			for (auto const & nestedEvent : nestedCollection->m_timeline.m_events) {
+				result.m_events.push_back(InputTimeline::Event{ pendingDelay + nestedEvent.m_delayBefore, nestedEvent.m_input });
+				pendingDelay = std::chrono::milliseconds{ 0 };
+			}
+			pendingDelay += nestedCollection->m_timeline.m_trailingDelay;
+		} else {
+			result.m_events.push_back(InputTimeline::Event{ pendingDelay, commandToExecute });
+			pendingDelay = std::chrono::milliseconds{ 0 };
+		}
+	}
+	result.m_trailingDelay = pendingDelay;
+	return result;
+}
+
 LINKAGE_RESTRICTION void InputSequencesCollection::execute()
 {
 	if (enabled) {
-		for (auto element : m_commandsToExecute) {
-			element->execute();
-			//TODO: there is a very subtle issue with this code.
-			// We have a command-line parameter for timeout between the each keystroke, 
-			// The way we do the execution of the keystrokes one after another here, this timeout will not be honored between consequent hotkey combinations.
-			// This is a rare issue, but it still has to be addressed
-		}
+		replayInputTimeline(m_timeline, std::chrono::milliseconds{ 0 },
+			[]() { return std::chrono::steady_clock::now(); },
+			[](std::chrono::steady_clock::time_point const & deadline) { std::this_thread::sleep_until(deadline); });
 	}
 }
 } //namespace core
@@ -7,12 +7,16 @@
 #define COMMANDS_DATA_EXTRACTION_HPP
 
 #include "command_id.hpp"
+#include "commands_index.hpp"
 #include "image_id.hpp"
 #include "variables_manager.hpp"
+#include "string_ref.hpp"
+#include "utils.hpp"
 #include <memory>
 #include <utility>
 #include <map>
 #include <string>
+#include <chrono>
 #include <iostream>
 #include <sstream>
 #include <vector>
@@ -30,24 +34,29 @@ namespace core {
 // of the split string and control the process.
 // Note: the CellVerificationFunctor is a callable object, that takes 3 parameters and returns a boolean flag.
 // The 3 parameters are: the current substring to process, index of this substring, a boolean flag, which tells the callback code, if there is any more data to process.
+// The substring is passed as a StringRef, which points inside the 'row' buffer (no copies of the cells are made here), so it is only valid while the 'row' data is alive.
 // The return value is a flag, which tells the system, if it should continue the process, or terminate it before the string is processed fully.
+// The function returns the amount of cells, which were accepted by the functor.
 template<typename CellVerificationFunctor>
-std::vector<std::string> splitTheRow(std::string const & row, char delimiter, CellVerificationFunctor & elementsVerificationFunctor)
+size_t splitTheRow(StringRef const & row, char delimiter, CellVerificationFunctor & elementsVerificationFunctor)
 {
-	using namespace std::string_literals;
-	auto cellValue(""s);
-	std::vector<std::string> elements;
-	std::stringstream mystream(row);
-
-	while (std::getline(mystream, cellValue, delimiter)) {
-		if (elementsVerificationFunctor(cellValue, elements.size(), !mystream.eof())) {
-			elements.push_back(cellValue);
+	size_t acceptedCellsCount = 0;
+	size_t cellStart = 0;
+	while (cellStart < row.size()) {
+		auto cellEnd = row.find(delimiter, cellStart);
+		auto const moreDataInRow = (cellEnd != StringRef::npos); // Note: a trailing delimiter does not produce an empty trailing cell (this mimics the std::getline() behaviour, which was used here previously)
+		if (!moreDataInRow) {
+			cellEnd = row.size();
 		}
+		if (elementsVerificationFunctor(row.substr(cellStart, cellEnd - cellStart), acceptedCellsCount, moreDataInRow)) {
+			++acceptedCellsCount;
+		}
+		cellStart = cellEnd + 1;
 	}
-	return elements;
+	return acceptedCellsCount;
 };
-std::vector<std::string> splitTheRow(std::string const & row, char delimiter);
-std::tuple<bool, size_t> idStringOk(std::string const & toTest);
+std::vector<std::string> splitTheRow(StringRef const & row, char delimiter);
+std::tuple<bool, size_t> idStringOk(StringRef const & toTest);
 
 struct ConfigFilesKeywords
 {
@@ -57,6 +66,7 @@ struct ConfigFilesKeywords
 	static std::string const & aggregatedSetOfCommands() { static std::string const result{ "commandSequence" }; return result; };
 	static std::string const & sleepOperationCommand()   { static std::string const result{ "sleepForTimeout" }; return result; };
 	static std::string const & systemCallCommand()       { static std::string const result{ "systemCall" }; return result; };
+	static std::string const & textTypingCommand()       { static std::string const result{ "typeText" }; return result; };
 	struct MouseEventTypes {
 		static std::string const & LeftButton() { static std::string const result{ "L" }; return result; };
 		static std::string const & RightButton() { static std::string const result{ "R" }; return result; };
@@ -96,14 +106,15 @@ struct ParsedCsvRow
 	ParsedCsvRow(std::vector<std::string> const & customRowsNames) :m_customColumns(customRowsNames) {}
 	bool operator == (ParsedCsvRow const & other) const { return m_customColumns == other.m_customColumns; };
 	bool operator != (ParsedCsvRow const & other) const { return m_customColumns != other.m_customColumns; };
-	static auto parseHeaderString(std::string const & headerString);
-	static auto parseDataRowString(std::string const & rowString); // TODO: add environments count parameter (make sure that the length of m_customColumns is consistent (not bigger and not smaller then expected))
+	static auto parseHeaderString(StringRef const & headerString);
+	static auto parseDataRowString(StringRef const & rowString); // TODO: add environments count parameter (make sure that the length of m_customColumns is consistent (not bigger and not smaller then expected))
 };
 
 struct SimpleHotkeyCombination;
 struct SimpleMouseInput;
 struct SimpleSleepOperation;
 struct SystemCall;
+struct SimpleTextTyping;
 struct InputSequencesCollection;
 struct AbstractSimulatedUserInput
 {
@@ -121,6 +132,7 @@ struct AbstractSimulatedUserInput
 	virtual bool isEquivalentTo_impl(SimpleMouseInput const & other) const  = 0;
 	virtual bool isEquivalentTo_impl(SimpleSleepOperation const & other) const = 0;
 	virtual bool isEquivalentTo_impl(SystemCall const & other) const = 0;
+	virtual bool isEquivalentTo_impl(SimpleTextTyping const & other) const = 0;
 	virtual bool isEquivalentTo_impl(InputSequencesCollection const & other) const = 0;
 };
 
@@ -129,12 +141,15 @@ struct SimpleHotkeyCombination : public AbstractSimulatedUserInput
 	SimpleHotkeyCombination(std::string const & value) : AbstractSimulatedUserInput(value) {};
 	SimpleHotkeyCombination(std::string const & value, bool enable) : AbstractSimulatedUserInput(value, enable) {};
 	void execute() override { AbstractSimulatedUserInput::execute(); };
+	// The value in the compiled form, which is stored in the precompiled configs bundle (see PrecompiledHotkeyCombinationFactoryMethod). Empty, if there is nothing to store.
+	virtual std::string getCompiledData() const { return std::string{}; };
 
 	bool isEquivalentTo_impl(AbstractSimulatedUserInput const & other) const override { return other.isEquivalentTo_impl(*this); };
 	bool isEquivalentTo_impl(SimpleHotkeyCombination const & other) const override;
 	bool isEquivalentTo_impl(SimpleMouseInput const & other) const override { return false; };
 	bool isEquivalentTo_impl(SimpleSleepOperation const & other) const override { return false; };
 	bool isEquivalentTo_impl(SystemCall const & other) const override { return false; };
+	bool isEquivalentTo_impl(SimpleTextTyping const & other) const override { return false; };
 	bool isEquivalentTo_impl(InputSequencesCollection const & other) const override {return false;};
 };
 
@@ -149,6 +164,7 @@ struct SimpleMouseInput : public AbstractSimulatedUserInput
 	bool isEquivalentTo_impl(SimpleMouseInput const & other) const override;
 	bool isEquivalentTo_impl(SimpleSleepOperation const & other) const override { return false; };
 	bool isEquivalentTo_impl(SystemCall const & other) const override { return false; };
+	bool isEquivalentTo_impl(SimpleTextTyping const & other) const override { return false; };
 	bool isEquivalentTo_impl(InputSequencesCollection const & other) const override {return false;};
 };
 struct SimpleSleepOperation : public AbstractSimulatedUserInput
@@ -162,6 +178,7 @@ struct SimpleSleepOperation : public AbstractSimulatedUserInput
 	bool isEquivalentTo_impl(SimpleMouseInput const & other) const override { return false; };
 	bool isEquivalentTo_impl(SimpleSleepOperation const & other) const override;
 	bool isEquivalentTo_impl(SystemCall const & other) const override { return false; };
+	bool isEquivalentTo_impl(SimpleTextTyping const & other) const override { return false; };
 	bool isEquivalentTo_impl(InputSequencesCollection const & other) const override {return false;};
 };
 
@@ -173,39 +190,136 @@ struct SystemCall : AbstractSimulatedUserInput {
 	bool isEquivalentTo_impl(SimpleMouseInput const & other) const override { return false; };
 	bool isEquivalentTo_impl(SimpleSleepOperation const & other) const override { return false; };
 	bool isEquivalentTo_impl(SystemCall const & other) const override;
+	bool isEquivalentTo_impl(SimpleTextTyping const & other) const override { return false; };
+	bool isEquivalentTo_impl(InputSequencesCollection const & other) const override {return false;};
+};
+
+// The text, which is typed character by character (see the 'typeText' rows of the input sequences config).
+// Unlike the SimpleHotkeyCombination, the value is not a keys description: all the characters are typed as they are, so the tool can pick the fastest way to type them.
+// The text is decoded during the creation of the object (the invalid UTF-8 texts are reported at the configs loading).
+struct SimpleTextTyping : public AbstractSimulatedUserInput
+{
+	std::u32string const m_characters;
+	SimpleTextTyping(std::string const & value) : AbstractSimulatedUserInput(value), m_characters(decodeUTF8(value)) {};
+	SimpleTextTyping(std::string const & value, bool enable) : AbstractSimulatedUserInput(value, enable), m_characters(decodeUTF8(value)) {};
+	void execute() override { AbstractSimulatedUserInput::execute(); };
+	bool isEquivalentTo_impl(AbstractSimulatedUserInput const & other) const override { return other.isEquivalentTo_impl(*this); };
+	bool isEquivalentTo_impl(SimpleHotkeyCombination const & other) const override { return false; };
+	bool isEquivalentTo_impl(SimpleMouseInput const & other) const override { return false; };
+	bool isEquivalentTo_impl(SimpleSleepOperation const & other) const override { return false; };
+	bool isEquivalentTo_impl(SystemCall const & other) const override { return false; };
+	bool isEquivalentTo_impl(SimpleTextTyping const & other) const override;
 	bool isEquivalentTo_impl(InputSequencesCollection const & other) const override {return false;};
 };
 
+// The inputs of the aggregated command, compiled into a flat list (see InputSequencesCollection).
+// The sleep operations are not executed as the inputs: they are turned into the delays before the following inputs.
+struct InputTimeline
+{
+	struct Event
+	{
+		std::chrono::milliseconds m_delayBefore; // the time between the end of the previous input (or the start of the timeline) and the start of this one
+		std::shared_ptr<AbstractSimulatedUserInput> m_input; // the timeline shares the ownership of the inputs, so it stays valid after the configs are reloaded
+	};
+	std::vector<Event> m_events;
+	std::chrono::milliseconds m_trailingDelay{ 0 }; // the sleeps after the last input (the next command should not start before it ends)
+};
+
+// The information about the timing accuracy of the InputTimeline replay.
+struct InputTimelineReplayStatistics
+{
+	size_t m_delaysCount{ 0 };
+	std::chrono::nanoseconds m_maxLateness{ 0 }; // the lateness is the difference between the planned and the actual end of the delay
+	std::chrono::nanoseconds m_totalLateness{ 0 };
+};
+
+// Executes the inputs of the timeline. The delayBetweenInputs is added to the delays between the consequent inputs.
+// The deadlines are absolute: the delay before each input is counted from the end of the previous input, so the time spent on the sleeps themselves is not accumulated.
+// The now() function should return the current time (std::chrono::steady_clock::time_point), the sleepUntil(deadline) function should block until that time.
+template <typename NowFunction, typename SleepUntilFunction>
+InputTimelineReplayStatistics replayInputTimeline(InputTimeline const & timeline, std::chrono::milliseconds delayBetweenInputs, NowFunction now, SleepUntilFunction sleepUntil)
+{
+	auto result = InputTimelineReplayStatistics{};
+	auto previousInputEnd = now();
+	auto const waitFor = [&](std::chrono::milliseconds delay) {
+		if (delay.count() <= 0) {
+			return;
+		}
+		auto const deadline = previousInputEnd + delay;
+		sleepUntil(deadline);
+		auto const lateness = std::chrono::duration_cast<std::chrono::nanoseconds>(now() - deadline);
+		++result.m_delaysCount;
+		result.m_maxLateness = (std::max)(result.m_maxLateness, lateness);
+		result.m_totalLateness += lateness;
+	};
+	for (size_t i = 0; i < timeline.m_events.size(); ++i) {
+		auto const & event = timeline.m_events[i];
+		waitFor(event.m_delayBefore + ((i > 0) ? delayBetweenInputs : std::chrono::milliseconds{ 0 }));
+		event.m_input->execute();
+		previousInputEnd = now();
+	}
+	waitFor(timeline.m_trailingDelay);
+	return result;
+}
+
+// Note: the collection shares the ownership of the commands it executes, so it stays valid after the CommandsInfoContainer, which created it, is destroyed
+// (the tool executes the commands on a separate thread, so the configs could be reloaded while the collection is still waiting for the execution).
 struct InputSequencesCollection : public AbstractSimulatedUserInput
 {
-	typedef std::vector<AbstractSimulatedUserInput *> CommandsSequence;
+	typedef std::vector<std::shared_ptr<AbstractSimulatedUserInput>> CommandsSequence;
 private:
 	CommandsSequence const m_commandsToExecute;
+	InputTimeline const m_timeline; // compiled from the m_commandsToExecute during the creation of the object (the nested collections are flattened)
+	static InputTimeline compileTimeline(CommandsSequence const & commandsToExecute);
 public:
-	InputSequencesCollection(CommandsSequence const & commandsToExecute, std::string const & value) : AbstractSimulatedUserInput(value), m_commandsToExecute(commandsToExecute) {};
-	InputSequencesCollection(CommandsSequence const & commandsToExecute, std::string const & value, bool enable) : AbstractSimulatedUserInput(value, enable), m_commandsToExecute(commandsToExecute) {};
-	void execute() override;
+	InputSequencesCollection(CommandsSequence const & commandsToExecute, std::string const & value) : AbstractSimulatedUserInput(value), m_commandsToExecute(commandsToExecute), m_timeline(compileTimeline(commandsToExecute)) {};
+	InputSequencesCollection(CommandsSequence const & commandsToExecute, std::string const & value, bool enable) : AbstractSimulatedUserInput(value, enable), m_commandsToExecute(commandsToExecute), m_timeline(compileTimeline(commandsToExecute)) {};
+	void execute() override; // replays the timeline without the delays between the inputs (the tool replays it with the delay, which is set in the command line)
+	InputTimeline const & getTimeline() const { return m_timeline; };
 
 	bool isEquivalentTo_impl(AbstractSimulatedUserInput const & other) const override { return other.isEquivalentTo_impl(*this); };
 	bool isEquivalentTo_impl(SimpleHotkeyCombination const & other) const override { return false; };
 	bool isEquivalentTo_impl(SimpleMouseInput const & other) const override { return false; };
 	bool isEquivalentTo_impl(SimpleSleepOperation const & other) const override { return false; };
 	bool isEquivalentTo_impl(SystemCall const & other) const override { return false; };
+	bool isEquivalentTo_impl(SimpleTextTyping const & other) const override { return false; };
 	bool isEquivalentTo_impl(InputSequencesCollection const & other) const override;
 };
 
 typedef std::function<std::shared_ptr<AbstractSimulatedUserInput>(std::string const &, CommandID const & , size_t currentEnvironmentIndex)> HotkeyCombinationFactoryMethod;
 typedef std::function<std::shared_ptr<AbstractSimulatedUserInput>(std::string const &, CommandID const & , size_t currentEnvironmentIndex)> MouseInputsFactoryMethod;
 typedef std::function<std::shared_ptr<AbstractSimulatedUserInput>(std::string const &, CommandID const & , size_t currentEnvironmentIndex)> SleepInputsFactoryMethod;
+typedef std::function<std::shared_ptr<AbstractSimulatedUserInput>(std::string const &, CommandID const & , size_t currentEnvironmentIndex)> TextTypingFactoryMethod;
+// Creates the hotkey combination from the precompiled configs bundle: the compiled data is the one, which was returned by the SimpleHotkeyCombination::getCompiledData() (so the value is not compiled again).
+typedef std::function<std::shared_ptr<AbstractSimulatedUserInput>(std::string const & value, std::string const & compiledData, CommandID const & , size_t currentEnvironmentIndex)> PrecompiledHotkeyCombinationFactoryMethod;
 
 
+// The input objects of one command for all the environments.
+// Most of the config cells are usually empty, so the objects are created only for the defined cells. All the empty cells reference one shared disabled object,
+// and the empty cells after the last defined one are not stored at all. The access by the environment index is still O(1).
+class InputsForEnvironments
+{
+	std::vector<std::shared_ptr<AbstractSimulatedUserInput> > m_definedInputs; // up to the last defined cell
+	size_t m_environmentsCount;
+public:
+	explicit InputsForEnvironments(size_t environmentsCount) : m_environmentsCount(environmentsCount) {};
+	static std::shared_ptr<AbstractSimulatedUserInput> const & getDisabledInput(); // the shared object for the empty cells. Note: it should never be modified.
+	void setInput(size_t environmentIndex, std::shared_ptr<AbstractSimulatedUserInput> const & input);
+	std::shared_ptr<AbstractSimulatedUserInput> const & operator [] (size_t environmentIndex) const
+	{
+		return (environmentIndex < m_definedInputs.size()) ? m_definedInputs[environmentIndex] : getDisabledInput();
+	};
+	size_t size() const { return m_environmentsCount; };
+	bool operator == (InputsForEnvironments const & other) const;
+};
+
 struct Command
 {
 	CommandID const commandID;
 	std::string const commandNote;
 	std::string const commandGroup;
 
-	typedef std::vector<std::shared_ptr<AbstractSimulatedUserInput> > HotkeysForDifferentEnvironments;
+	typedef InputsForEnvironments HotkeysForDifferentEnvironments;
 	HotkeysForDifferentEnvironments hotkeysForEnvironments;
 
 	Command(std::string const & c_id, std::string const & c_desc, std::string const & c_gr, HotkeysForDifferentEnvironments const & hkeys);
@@ -247,6 +361,35 @@ private:
 	VariablesManagersForEnvironments m_variablesForEnvironments;
 };
 
+struct CommandsInfoContainer;
+
+// The input sequences and variables managers configs, which are already in memory, are consumed in 2 steps (this allows loading many such files in parallel - see Engine::create()).
+// The first step splits the rows and verifies everything, which does not depend on the other rows and config files (row types, id strings, environments lists etc.).
+// It does not access the CommandsInfoContainer object, so it can be done for several files at the same time.
+// The second step (storeTo()) verifies the references to the commands and variables and stores the rows into the container.
+// It should be done for the files one by one, in the same order as they are listed, so that the references are checked the same way as in the sequential loading.
+// Note: the object can reference the config file contents, so the contents should outlive it.
+class PreparsedConfigFile
+{
+public:
+	typedef std::function<void(CommandsInfoContainer & target)> RowStoringOperation;
+private:
+	struct Row
+	{
+		size_t m_lineNumber;
+		RowStoringOperation m_storingOperation;
+	};
+	std::string m_fileTypeDescription;
+	std::vector<Row> m_rows;
+	bool m_hasError{ false };
+	std::string m_errorMessage; // The error detected during the first step. It is reported after the previous rows are stored (just like the sequential loading would do).
+public:
+	explicit PreparsedConfigFile(std::string const & fileTypeDescription) : m_fileTypeDescription(fileTypeDescription) {};
+	void pushRow(size_t lineNumber, RowStoringOperation const & storingOperation);
+	void setError(std::string const & errorMessage);
+	void storeTo(CommandsInfoContainer & target) const;
+};
+
 //The class, which knows everything about all the hotkey combinations for all the environments
 // It also holds other information that is differentiated by environment.
 // For example it holds separate 'variableManager' object for each of the environments.
@@ -254,7 +397,6 @@ struct CommandsInfoContainer
 {
 	typedef std::vector<std::string> EnvsContainer;
 	typedef std::vector<Command> CommandsContainer;
-	typedef std::map<CommandID, size_t> CommandsMap; //Probably don't need this
 private: //TODO: make all the fields in this class private
 	EnvsContainer m_environments;
 	VariablesDataForEnvironments m_variables;
@@ -262,10 +404,15 @@ public:
 	VariablesDataForEnvironments & getVariablesManagers() { return m_variables; };
 	VariablesDataForEnvironments const & getVariablesManagers_c() const { return m_variables; };
 	bool isVariableDeclaredInManagers(VariableID const & toTest) const { return m_variables.isVariableDeclaredForAll(toTest); };
-	CommandsMap m_commandsMap; // maps string to index (not sure if it is actully needed)
+	CommandsIndex m_commandsIndex; // maps the command id to the index in the m_commandsList
 	CommandsContainer m_commandsList;
+private:
+	// For each of the environments: a bit for each command (by the command index), which is set, if the command is enabled for this environment.
+	// It is filled when the commands are stored, so the layout generation does not need to check the input objects.
+	std::vector<std::vector<bool>> m_enabledCommandsForEnvironments;
+public:
 
-	CommandsInfoContainer(hat::core::ParsedCsvRow const & parsedHeader) : m_environments(parsedHeader.m_customColumns), m_variables(parsedHeader.m_customColumns.size()) {}
+	CommandsInfoContainer(hat::core::ParsedCsvRow const & parsedHeader) : m_environments(parsedHeader.m_customColumns), m_variables(parsedHeader.m_customColumns.size()), m_enabledCommandsForEnvironments(parsedHeader.m_customColumns.size()) {}
 
 	CommandID ensureMandatoryCommandAttributesAreCorrect(hat::core::ParsedCsvRow const & data) const;
 
@@ -273,11 +420,21 @@ public:
 	void pushDataRowForMouseInput(hat::core::ParsedCsvRow const & data, MouseInputsFactoryMethod mouse_inputs_builder);
 	void pushDataRowForSleepOperation(hat::core::ParsedCsvRow const & data, SleepInputsFactoryMethod mouse_inputs_builder);
 	void pushDataRowForSystemCallCommand(hat::core::ParsedCsvRow const & data);
+	void pushDataRowForTextTyping(hat::core::ParsedCsvRow const & data, TextTypingFactoryMethod text_typing_builder);
 	void pushDataRow(hat::core::ParsedCsvRow const & data);
 	void pushDataRowForAggregatedCommand(hat::core::ParsedCsvRow const & data);
+	// The referenced commands are given by their indices for each environment, so they are not looked up by the ids (it is used for the precompiled configs bundle).
+	// Throws, if the referenced command is not stored yet.
+	void pushDataRowForAggregatedCommand(hat::core::ParsedCsvRow const & data, std::vector<std::vector<size_t>> const & referencedCommandsIndices);
 
 private:
 	void storeCommandObject(CommandID const & commandID, Command const & commandToStore);
+	template <typename LinesReader>
+	static CommandsInfoContainer parseConfigLines(LinesReader & dataSource, HotkeyCombinationFactoryMethod hotkey_builder);
+	template <typename LinesReader>
+	void consumeInputSequencesConfigLines(LinesReader & dataSource, HotkeyCombinationFactoryMethod hotkey_builder, MouseInputsFactoryMethod mouse_inputs_builder, SleepInputsFactoryMethod sleep_objects_builder, TextTypingFactoryMethod text_typing_builder);
+	template <typename LinesReader>
+	void consumeVariablesManagersConfigLines(LinesReader & dataSource);
 public:
 
 	//TODO: make this private (the user code should access commands through indices
@@ -285,11 +442,22 @@ public:
 
 	bool hasCommandID(CommandID const & commandID) const;
 	size_t getCommandIndex(CommandID const & commandID) const;
+	std::pair<bool, size_t> findCommandIndex(CommandID const & commandID) const; // the same as the 2 functions above in one lookup
+	bool isCommandEnabled(size_t commandIndex, size_t environmentIndex) const { return (environmentIndex < m_enabledCommandsForEnvironments.size()) && m_enabledCommandsForEnvironments[environmentIndex][commandIndex]; };
 	EnvsContainer const & getEnvironments() const;
 	CommandsContainer const & getAllCommands() const;
 	static CommandsInfoContainer parseConfigFile(std::istream & dataSource, HotkeyCombinationFactoryMethod hotkey_builder);
-	void consumeInputSequencesConfigFile(std::istream & dataSource, HotkeyCombinationFactoryMethod hotkey_builder, MouseInputsFactoryMethod mouse_inputs_builder, SleepInputsFactoryMethod sleep_objects_builder);
+	void consumeInputSequencesConfigFile(std::istream & dataSource, HotkeyCombinationFactoryMethod hotkey_builder, MouseInputsFactoryMethod mouse_inputs_builder, SleepInputsFactoryMethod sleep_objects_builder, TextTypingFactoryMethod text_typing_builder);
 	void consumeVariablesManagersConfig(std::istream & dataSource);
+
+	// These overloads parse the config contents, which are already in memory (see MappedConfigFile). The lines are processed in place, without copying.
+	static CommandsInfoContainer parseConfigFile(StringRef const & configContents, HotkeyCombinationFactoryMethod hotkey_builder);
+	void consumeInputSequencesConfigFile(StringRef const & configContents, HotkeyCombinationFactoryMethod hotkey_builder, MouseInputsFactoryMethod mouse_inputs_builder, SleepInputsFactoryMethod sleep_objects_builder, TextTypingFactoryMethod text_typing_builder);
+	void consumeVariablesManagersConfig(StringRef const & configContents);
+
+	// The first step of the configs consumption (see PreparsedConfigFile). These functions only need the environments list, so they can be called from several threads simultaneously.
+	static PreparsedConfigFile preparseInputSequencesConfigFile(StringRef const & configContents, EnvsContainer const & environments, HotkeyCombinationFactoryMethod hotkey_builder, MouseInputsFactoryMethod mouse_inputs_builder, SleepInputsFactoryMethod sleep_objects_builder, TextTypingFactoryMethod text_typing_builder);
+	static PreparsedConfigFile preparseVariablesManagersConfig(StringRef const & configContents, EnvsContainer const & environments);
 	bool operator == (CommandsInfoContainer const  & other) const;
 };
 
@@ -301,7 +469,7 @@ struct XY_Dimensions
 	size_t y;
 	XY_Dimensions(size_t x, size_t y) : x(x), y(y) {};
 
-	bool operator == (XY_Dimensions const & other) {
+	bool operator == (XY_Dimensions const & other) const {
 		return ((x == other.x) && (y == other.y));
 	}
 };
@@ -309,7 +477,7 @@ struct ImagePhysicalInfo {
 	std::string filepath;
 	XY_Dimensions origin{0, 0};
 	XY_Dimensions size{SIZE_MAX, SIZE_MAX};
-	bool operator == (ImagePhysicalInfo const & other) {
+	bool operator == (ImagePhysicalInfo const & other) const {
 		return ((filepath == other.filepath) && (origin == other.origin) && (size == other.size));
 	}
 };
@@ -323,6 +491,8 @@ private:
 	GlobalImagesMapper m_mapper;
 	CommandsInfoContainer::EnvsContainer m_environments;
 	ImagePhysicalPropertiesToID m_imgIDs;
+	template <typename LinesReader>
+	void consumeImageResourcesConfigLines(LinesReader & imageID2physicalImageConfig, LinesReader & commandID2imageIDConfig);
 public:
 	ImageResourcesInfosContainer(CommandsInfoContainer::EnvsContainer const & environments);
 	void mapPhysicalImageInfoToID(ImageID const & imgID, ImagePhysicalInfo const & imgInfo);
@@ -340,6 +510,8 @@ public:
 	// physical images infos if the imageIDs are consistently chosen.
 	void consumeImageResourcesConfig(
 		std::istream & imageID2physicalImageConfig, std::istream & commandID2imageIDConfig);
+	void consumeImageResourcesConfig(
+		StringRef const & imageID2physicalImageConfig, StringRef const & commandID2imageIDConfig);
 
 	ImagePhysicalInfo const & getImageInfo(ImageID const & ) const;
 	std::pair<bool, ImageID> getImageID(CommandID const &, std::string const &) const;
@@ -349,6 +521,7 @@ public:
 	// Note: if the architecture changes in the future, maybe will need to rework this part of the class's logic.
 	ImagesInfoList getAllRegisteredImages() const;
 	std::vector<ImageID> getAllRegisteredImageIDs() const;
+	bool operator == (ImageResourcesInfosContainer const & other) const;
 };
 
 } //namespace core
@@ -0,0 +1,67 @@
+// This source file is part of the 'hat' open source project.
+// Copyright (c) 2016, Yuriy Vosel.
+// Licensed under Boost Software License.
+// See LICENSE.txt for the licence information.
+
+#ifndef HAT_CORE_HEADERONLY_MODE
+#include "commands_index.hpp"
+#endif
+#include <algorithm>
+
+#ifndef HAT_CORE_HEADERONLY_MODE
+#define LINKAGE_RESTRICTION
+#else
+#define LINKAGE_RESTRICTION inline
+#endif
+
+namespace hat {
+namespace core {
+
+LINKAGE_RESTRICTION size_t CommandsIndex::findSlot(CommandID const & commandID) const
+{
+	auto const mask = m_slots.size() - 1;
+	auto const hash = commandID.getHash();
+	for (auto position = static_cast<size_t>(hash) & mask; ; position = (position + 1) & mask) {
+		auto const & slot = m_slots[position];
+		if ((slot.m_commandIndex == EMPTY_SLOT) || ((slot.m_hash == hash) && (m_commandIDs[slot.m_commandIndex] == commandID))) {
+			return position;
+		}
+	}
+}
+
+LINKAGE_RESTRICTION void CommandsIndex::rebuildSlots(size_t slotsCount)
+{
+	m_slots.assign(slotsCount, Slot{ 0, EMPTY_SLOT });
+	for (size_t commandIndex = 0; commandIndex < m_commandIDs.size(); ++commandIndex) {
+		m_slots[findSlot(m_commandIDs[commandIndex])] = Slot{ m_commandIDs[commandIndex].getHash(), commandIndex };
+	}
+}
+
+LINKAGE_RESTRICTION size_t CommandsIndex::add(CommandID const & commandID)
+{
+	auto const commandIndex = m_commandIDs.size();
+	m_commandIDs.push_back(commandID);
+	if (m_commandIDs.size() * 2 > m_slots.size()) {
+		rebuildSlots((std::max)(m_slots.size() * 2, static_cast<size_t>(16)));
+	} else {
+		m_slots[findSlot(commandID)] = Slot{ commandID.getHash(), commandIndex };
+	}
+	return commandIndex;
+}
+
+LINKAGE_RESTRICTION std::pair<bool, size_t> CommandsIndex::find(CommandID const & commandID) const
+{
+	if (m_slots.empty()) {
+		return { false, 0 };
+	}
+	auto const & slot = m_slots[findSlot(commandID)];
+	if (slot.m_commandIndex == EMPTY_SLOT) {
+		return { false, 0 };
+	}
+	return { true, slot.m_commandIndex };
+}
+
+} //namespace core
+} //namespace hat
+
+#undef LINKAGE_RESTRICTION
@@ -0,0 +1,46 @@
+// This source file is part of the 'hat' open source project.
+// Copyright (c) 2016, Yuriy Vosel.
+// Licensed under Boost Software License.
+// See LICENSE.txt for the licence information.
+
+#ifndef COMMANDS_INDEX_HPP
+#define COMMANDS_INDEX_HPP
+
+#include "command_id.hpp"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace hat {
+namespace core {
+
+// The index for finding the commands by their ids. The commands get the consecutive indices in the order they are added (the same as in the CommandsInfoContainer::m_commandsList).
+// It is an open-addressing hash table (with linear probing), which holds the precomputed hashes of the ids (see CommandID::getHash()),
+// so the id strings are compared only when the hashes match. The table is kept at most half full, so the lookup time does not depend on the number of the commands.
+class CommandsIndex
+{
+	struct Slot
+	{
+		uint64_t m_hash;
+		size_t m_commandIndex; // EMPTY_SLOT for the free slots
+	};
+	static size_t const EMPTY_SLOT = static_cast<size_t>(-1);
+	std::vector<Slot> m_slots; // the size is always a power of 2
+	std::vector<CommandID> m_commandIDs;
+
+	size_t findSlot(CommandID const & commandID) const; // returns the slot with the id or the free slot, where it should be placed
+	void rebuildSlots(size_t slotsCount);
+public:
+	size_t add(CommandID const & commandID); // returns the index assigned to the command. Note: the user code should check, that the id is not in the index yet.
+	std::pair<bool, size_t> find(CommandID const & commandID) const;
+	size_t size() const { return m_commandIDs.size(); };
+};
+
+} //namespace core
+} //namespace hat
+
+#ifdef HAT_CORE_HEADERONLY_MODE
+#include "commands_index.cpp"
+#endif //HAT_CORE_HEADERONLY_MODE
+
+#endif //COMMANDS_INDEX_HPP
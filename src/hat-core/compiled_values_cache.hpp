@@ -0,0 +1,61 @@
+// This source file is part of the 'hat' open source project.
+// Copyright (c) 2016, Yuriy Vosel.
+// Licensed under Boost Software License.
+// See LICENSE.txt for the licence information.
+
+#ifndef COMPILED_VALUES_CACHE_HPP
+#define COMPILED_VALUES_CACHE_HPP
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace hat {
+namespace core {
+
+// The cache for the objects, which are compiled from the config strings (for example, the key sequences, compiled by the input simulation library).
+// Each distinct string is compiled only once, and the compiled object is shared by all the users (this is why it is immutable).
+// The cache is meant to live for the whole process lifetime, so the unchanged strings are not compiled again when the configs are reloaded.
+// Note: the object is thread-safe (the configs could be loaded on different threads).
+template <typename ValueType>
+class CompiledValuesCache
+{
+	mutable std::mutex m_mutex;
+	std::unordered_map<std::string, std::shared_ptr<ValueType const>> m_values;
+	std::atomic<size_t> m_hitsCount{ 0 };
+	std::atomic<size_t> m_missesCount{ 0 };
+public:
+	// The compilationFunction (ValueType(std::string const &)) is called only if there is no object for the key in the cache yet.
+	template <typename CompilationFunction>
+	std::shared_ptr<ValueType const> get(std::string const & key, CompilationFunction compilationFunction)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			auto const foundValue = m_values.find(key);
+			if (foundValue != m_values.end()) {
+				++m_hitsCount;
+				return foundValue->second;
+			}
+		}
+		// The compilation is done without holding the lock. If another thread stores the value for the same key in the meantime, that value is used.
+		auto compiledValue = std::make_shared<ValueType const>(compilationFunction(key));
+		std::lock_guard<std::mutex> lock(m_mutex);
+		++m_missesCount;
+		return m_values.emplace(key, compiledValue).first->second;
+	}
+
+	size_t getHitsCount() const { return m_hitsCount; };
+	size_t getMissesCount() const { return m_missesCount; };
+	size_t size() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_values.size();
+	}
+};
+
+} //namespace core
+} //namespace hat
+
+#endif //COMPILED_VALUES_CACHE_HPP
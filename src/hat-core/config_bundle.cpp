@@ -0,0 +1,546 @@
+// This source file is part of the 'hat' open source project.
+// Copyright (c) 2016, Yuriy Vosel.
+// Licensed under Boost Software License.
+// See LICENSE.txt for the licence information.
+
+#ifndef HAT_CORE_HEADERONLY_MODE
+#include "config_bundle.hpp"
+#endif
+#include "config_file_reader.hpp"
+#include <sstream>
+#include <stdexcept>
+
+#ifndef HAT_CORE_HEADERONLY_MODE
+#define LINKAGE_RESTRICTION
+#else
+#define LINKAGE_RESTRICTION inline
+#endif
+
+namespace hat {
+namespace core {
+
+// Layout of the bundle file (all the numbers are little-endian, the strings are stored as <uint32 length><bytes>):
+//   signature, format version
+//   source files: count, {path, exists flag, contents hash}
+//   environments: count, {name}
+//   commands: count, {kind, id, group, note, count of the stored values, {value, kind-specific data}}
+//     kind-specific data: the compiled data for the keyboard input (see SimpleHotkeyCombination::getCompiledData()),
+//                         the referenced commands count, {command index} for the aggregated commands, nothing for the other kinds
+//   variables managers (one for each environment): variables count, {id, initial value}, commands with operations count, {command index, operations count, {operation kind, target, parameter}}
+//   images: count, {id, filepath, origin x, origin y, size x, size y}, then for each environment: mappings count, {command id, image id}
+//   layout: pages count, {page}, options selector pages count, {command id, page}
+//     page: note, rows count, {elements count, {options count, {is variable label flag, value}}}
+// The format version should be incremented each time this layout changes. The bundles with other versions are rejected (the text configs will be parsed instead).
+namespace {
+std::string const & CONFIG_BUNDLE_SIGNATURE() { static std::string const result{ "HAT_CONFIG_BUNDLE" }; return result; };
+uint32_t const CONFIG_BUNDLE_FORMAT_VERSION = 3;
+
+enum class StoredCommandKind : uint8_t
+{
+	KEYBOARD_INPUT, MOUSE_INPUT, SLEEP_OPERATION, SYSTEM_CALL, AGGREGATE, TEXT_TYPING
+};
+
+enum class StoredVariableOperationKind : uint8_t
+{
+	APPEND_TEXT, ASSIGN_TEXT, APPEND_VALUE, ASSIGN_VALUE, CLEAR_TAIL_CHARACTERS
+};
+
+class ConfigBundleWriter
+{
+	std::ostream & m_target;
+public:
+	explicit ConfigBundleWriter(std::ostream & target) : m_target(target) {};
+
+	void writeUint(uint64_t value, size_t bytesCount)
+	{
+		for (size_t i = 0; i < bytesCount; ++i) {
+			m_target.put(static_cast<char>((value >> (8 * i)) & 0xFF));
+		}
+	}
+	void writeUint8(uint8_t value) { writeUint(value, 1); };
+	void writeUint32(size_t value)
+	{
+		if (value > UINT32_MAX) {
+			throw std::runtime_error("The configs are too big to be stored in the precompiled bundle.");
+		}
+		writeUint(value, 4);
+	}
+	void writeUint64(uint64_t value) { writeUint(value, 8); };
+	void writeString(std::string const & value)
+	{
+		writeUint32(value.size());
+		m_target.write(value.data(), value.size());
+	}
+};
+
+class ConfigBundleReader
+{
+	StringRef m_data;
+	size_t m_position{ 0 };
+
+	StringRef take(size_t bytesCount)
+	{
+		if (bytesCount > m_data.size() - m_position) {
+			throw std::runtime_error("The precompiled configs bundle is truncated or corrupted.");
+		}
+		auto result = m_data.substr(m_position, bytesCount);
+		m_position += bytesCount;
+		return result;
+	}
+public:
+	explicit ConfigBundleReader(StringRef const & data) : m_data(data) {};
+
+	uint64_t readUint(size_t bytesCount)
+	{
+		auto const bytes = take(bytesCount);
+		uint64_t result = 0;
+		for (size_t i = 0; i < bytesCount; ++i) {
+			result |= static_cast<uint64_t>(static_cast<unsigned char>(bytes[i])) << (8 * i);
+		}
+		return result;
+	}
+	uint8_t readUint8() { return static_cast<uint8_t>(readUint(1)); };
+	size_t readUint32() { return static_cast<size_t>(readUint(4)); };
+	uint64_t readUint64() { return readUint(8); };
+	std::string readString() { return std::string(take(readUint32())); };
+	bool isFinished() const { return m_position == m_data.size(); };
+};
+
+void writeSources(ConfigBundleWriter & writer, ConfigBundleSources const & sources)
+{
+	writer.writeUint32(sources.size());
+	for (auto const & source : sources) {
+		writer.writeString(source.m_path);
+		writer.writeUint8(source.m_exists ? 1 : 0);
+		writer.writeUint64(source.m_contentsHash);
+	}
+}
+
+ConfigBundleSources readHeaderAndSources(ConfigBundleReader & reader)
+{
+	if (reader.readString() != CONFIG_BUNDLE_SIGNATURE()) {
+		throw std::runtime_error("The file is not a precompiled configs bundle.");
+	}
+	auto const version = reader.readUint32();
+	if (version != CONFIG_BUNDLE_FORMAT_VERSION) {
+		std::stringstream error;
+		error << "The precompiled configs bundle has unsupported format version " << version << " (expected version: " << CONFIG_BUNDLE_FORMAT_VERSION << "). It should be recompiled.";
+		throw std::runtime_error(error.str());
+	}
+	auto result = ConfigBundleSources{};
+	auto const sourcesCount = reader.readUint32();
+	for (size_t i = 0; i < sourcesCount; ++i) {
+		auto path = reader.readString();
+		auto const exists = (reader.readUint8() != 0);
+		auto const hash = reader.readUint64();
+		result.push_back(ConfigBundleSourceFile{ path, exists, hash });
+	}
+	return result;
+}
+
+StoredCommandKind getStoredCommandKind(AbstractSimulatedUserInput const & input)
+{
+	// Note: the tool's input classes are derived from the core ones, so the kind is detected by the base class.
+	if (dynamic_cast<InputSequencesCollection const *>(&input) != nullptr) {
+		return StoredCommandKind::AGGREGATE;
+	} else if (dynamic_cast<SystemCall const *>(&input) != nullptr) {
+		return StoredCommandKind::SYSTEM_CALL;
+	} else if (dynamic_cast<SimpleTextTyping const *>(&input) != nullptr) {
+		return StoredCommandKind::TEXT_TYPING;
+	} else if (dynamic_cast<SimpleSleepOperation const *>(&input) != nullptr) {
+		return StoredCommandKind::SLEEP_OPERATION;
+	} else if (dynamic_cast<SimpleMouseInput const *>(&input) != nullptr) {
+		return StoredCommandKind::MOUSE_INPUT;
+	} else if (dynamic_cast<SimpleHotkeyCombination const *>(&input) != nullptr) {
+		return StoredCommandKind::KEYBOARD_INPUT;
+	}
+	throw std::runtime_error("Unknown type of the input object. It can't be stored in the precompiled configs bundle.");
+}
+
+// The Command::create() function uses the shared disabled object for the empty cells (it is not created by the factory method).
+// It is stored as an empty value, so that the factory method is called on loading for exactly the same values as during the text parsing.
+bool isPlaceholderForMissingEnvironmentValue(AbstractSimulatedUserInput const & input)
+{
+	return &input == InputsForEnvironments::getDisabledInput().get();
+}
+
+// The referenced commands are resolved the same way as during the text parsing (see CommandsInfoContainer::pushDataRowForAggregatedCommand()), so that they are not looked up on loading.
+std::vector<size_t> getReferencedCommandsIndices(CommandsInfoContainer const & commandsConfig, std::string const & aggregatedCommandValue)
+{
+	auto result = std::vector<size_t>{};
+	auto commandIDsProcessor = [&](StringRef const & commandID, size_t, bool) -> bool {
+		result.push_back(commandsConfig.getCommandIndex(CommandID{ std::string(commandID) }));
+		return true;
+	};
+	splitTheRow(aggregatedCommandValue, ',', commandIDsProcessor);
+	return result;
+}
+
+void writeCommands(ConfigBundleWriter & writer, CommandsInfoContainer const & commandsConfig)
+{
+	auto const & commands = commandsConfig.getAllCommands();
+	writer.writeUint32(commands.size());
+	for (auto const & command : commands) {
+		auto const & inputs = command.hotkeysForEnvironments;
+		auto storedValuesCount = inputs.size();
+		while ((storedValuesCount > 0) && isPlaceholderForMissingEnvironmentValue(*inputs[storedValuesCount - 1])) {
+			--storedValuesCount;
+		}
+		auto kind = StoredCommandKind::KEYBOARD_INPUT;
+		for (size_t i = 0; i < storedValuesCount; ++i) {
+			if (!isPlaceholderForMissingEnvironmentValue(*inputs[i])) {
+				kind = getStoredCommandKind(*inputs[i]);
+				break;
+			}
+		}
+		writer.writeUint8(static_cast<uint8_t>(kind));
+		writer.writeString(command.commandID.getValue());
+		writer.writeString(command.commandGroup);
+		writer.writeString(command.commandNote);
+		writer.writeUint32(storedValuesCount);
+		for (size_t i = 0; i < storedValuesCount; ++i) {
+			writer.writeString(inputs[i]->m_value);
+			if (StoredCommandKind::KEYBOARD_INPUT == kind) {
+				auto const hotkeyCombination = dynamic_cast<SimpleHotkeyCombination const *>(inputs[i].get()); // the placeholders for the missing values are not the hotkey combinations
+				writer.writeString((hotkeyCombination != nullptr) ? hotkeyCombination->getCompiledData() : std::string{});
+			} else if (StoredCommandKind::AGGREGATE == kind) {
+				auto const indices = isPlaceholderForMissingEnvironmentValue(*inputs[i]) ? std::vector<size_t>{} : getReferencedCommandsIndices(commandsConfig, inputs[i]->m_value);
+				writer.writeUint32(indices.size());
+				for (auto const index : indices) {
+					writer.writeUint32(index);
+				}
+			}
+		}
+	}
+}
+
+void readCommands(ConfigBundleReader & reader, CommandsInfoContainer & target, PrecompiledHotkeyCombinationFactoryMethod hotkey_builder, MouseInputsFactoryMethod mouse_inputs_builder, SleepInputsFactoryMethod sleep_objects_builder, TextTypingFactoryMethod text_typing_builder)
+{
+	auto compiledData = std::vector<std::string>{}; // for the keyboard input, by the environment index
+	auto referencedCommandsIndices = std::vector<std::vector<size_t>>{}; // for the aggregated commands, by the environment index
+	auto const precompiledHotkeyBuilder = [&hotkey_builder, &compiledData](std::string const & param, CommandID const & commandID, size_t environmentIndex) {
+		return hotkey_builder(param, compiledData[environmentIndex], commandID, environmentIndex);
+	};
+	auto const commandsCount = reader.readUint32();
+	for (size_t i = 0; i < commandsCount; ++i) {
+		auto const kind = static_cast<StoredCommandKind>(reader.readUint8());
+		auto rowData = std::vector<std::string>{};
+		rowData.push_back(reader.readString()); // id
+		rowData.push_back(reader.readString()); // group
+		rowData.push_back(reader.readString()); // note
+		rowData.push_back(""); // description (it is not used after parsing, so it is not stored)
+		auto const valuesCount = reader.readUint32();
+		compiledData.clear();
+		referencedCommandsIndices.clear();
+		for (size_t valueIndex = 0; valueIndex < valuesCount; ++valueIndex) {
+			rowData.push_back(reader.readString());
+			if (StoredCommandKind::KEYBOARD_INPUT == kind) {
+				compiledData.push_back(reader.readString());
+			} else if (StoredCommandKind::AGGREGATE == kind) {
+				referencedCommandsIndices.emplace_back();
+				auto const indicesCount = reader.readUint32();
+				for (size_t j = 0; j < indicesCount; ++j) {
+					referencedCommandsIndices.back().push_back(reader.readUint32());
+				}
+			}
+		}
+		auto const row = ParsedCsvRow(rowData);
+		// The rows are pushed in the same order as they were parsed, so the aggregated commands reference the commands, which are already stored.
+		if (StoredCommandKind::KEYBOARD_INPUT == kind) {
+			target.pushDataRow(row, precompiledHotkeyBuilder);
+		} else if (StoredCommandKind::MOUSE_INPUT == kind) {
+			target.pushDataRowForMouseInput(row, mouse_inputs_builder);
+		} else if (StoredCommandKind::SLEEP_OPERATION == kind) {
+			target.pushDataRowForSleepOperation(row, sleep_objects_builder);
+		} else if (StoredCommandKind::SYSTEM_CALL == kind) {
+			target.pushDataRowForSystemCallCommand(row);
+		} else if (StoredCommandKind::TEXT_TYPING == kind) {
+			target.pushDataRowForTextTyping(row, text_typing_builder);
+		} else if (StoredCommandKind::AGGREGATE == kind) {
+			target.pushDataRowForAggregatedCommand(row, referencedCommandsIndices);
+		} else {
+			throw std::runtime_error("Unknown type of the command in the precompiled configs bundle.");
+		}
+	}
+}
+
+void writeVariableOperation(ConfigBundleWriter & writer, VariableOperation const & operation)
+{
+	if (auto appendText = dynamic_cast<AppendText const *>(&operation)) {
+		writer.writeUint8(static_cast<uint8_t>(StoredVariableOperationKind::APPEND_TEXT));
+		writer.writeString(appendText->m_targetVariable.getValue());
+		writer.writeString(appendText->m_stringValue);
+	} else if (auto assignText = dynamic_cast<AssignText const *>(&operation)) {
+		writer.writeUint8(static_cast<uint8_t>(StoredVariableOperationKind::ASSIGN_TEXT));
+		writer.writeString(assignText->m_targetVariable.getValue());
+		writer.writeString(assignText->m_stringValue);
+	} else if (auto appendValue = dynamic_cast<AppendValue const *>(&operation)) {
+		writer.writeUint8(static_cast<uint8_t>(StoredVariableOperationKind::APPEND_VALUE));
+		writer.writeString(appendValue->m_targetVariable.getValue());
+		writer.writeString(appendValue->m_sourceVariableID.getValue());
+	} else if (auto assignValue = dynamic_cast<AssignValue const *>(&operation)) {
+		writer.writeUint8(static_cast<uint8_t>(StoredVariableOperationKind::ASSIGN_VALUE));
+		writer.writeString(assignValue->m_targetVariable.getValue());
+		writer.writeString(assignValue->m_sourceVariableID.getValue());
+	} else if (auto clearTail = dynamic_cast<ClearTailCharacters const *>(&operation)) {
+		writer.writeUint8(static_cast<uint8_t>(StoredVariableOperationKind::CLEAR_TAIL_CHARACTERS));
+		writer.writeString(clearTail->m_targetVariable.getValue());
+		writer.writeString(std::to_string(clearTail->getCharactersCountToClear()));
+	} else {
+		throw std::runtime_error("Unknown type of the variable operation. It can't be stored in the precompiled configs bundle.");
+	}
+}
+
+std::shared_ptr<VariableOperation> readVariableOperation(ConfigBundleReader & reader)
+{
+	auto const kind = static_cast<StoredVariableOperationKind>(reader.readUint8());
+	auto const target = VariableID{ reader.readString() };
+	auto const parameter = reader.readString();
+	if (StoredVariableOperationKind::APPEND_TEXT == kind) {
+		return std::make_shared<AppendText>(target, parameter);
+	} else if (StoredVariableOperationKind::ASSIGN_TEXT == kind) {
+		return std::make_shared<AssignText>(target, parameter);
+	} else if (StoredVariableOperationKind::APPEND_VALUE == kind) {
+		return std::make_shared<AppendValue>(target, VariableID{ parameter });
+	} else if (StoredVariableOperationKind::ASSIGN_VALUE == kind) {
+		return std::make_shared<AssignValue>(target, VariableID{ parameter });
+	} else if (StoredVariableOperationKind::CLEAR_TAIL_CHARACTERS == kind) {
+		return std::make_shared<ClearTailCharacters>(target, static_cast<size_t>(std::stoull(parameter)));
+	}
+	throw std::runtime_error("Unknown type of the variable operation in the precompiled configs bundle.");
+}
+
+void writeVariablesManagers(ConfigBundleWriter & writer, CommandsInfoContainer const & commandsConfig)
+{
+	auto const & variablesData = commandsConfig.getVariablesManagers_c();
+	for (size_t envIndex = 0; envIndex < commandsConfig.getEnvironments().size(); ++envIndex) {
+		auto const & manager = variablesData.getManagerForEnv_c(envIndex);
+		auto const & variables = manager.getVariablesWithValues();
+		writer.writeUint32(variables.size());
+		for (auto const & variable : variables) {
+			writer.writeString(variable.first.getValue());
+			writer.writeString(variable.second);
+		}
+		auto const & operations = manager.getOperationsToExecute();
+		writer.writeUint32(operations.size());
+		for (auto const & commandOperations : operations) {
+			writer.writeUint64(commandOperations.first);
+			auto const & operationsList = commandOperations.second.data();
+			writer.writeUint32(operationsList.size());
+			for (auto const & operation : operationsList) {
+				writeVariableOperation(writer, *operation);
+			}
+		}
+	}
+}
+
+void readVariablesManagers(ConfigBundleReader & reader, CommandsInfoContainer & target)
+{
+	auto & variablesData = target.getVariablesManagers();
+	for (size_t envIndex = 0; envIndex < target.getEnvironments().size(); ++envIndex) {
+		auto & manager = variablesData.getManagerForEnv(envIndex);
+		auto const variablesCount = reader.readUint32();
+		for (size_t i = 0; i < variablesCount; ++i) {
+			auto const variableID = VariableID{ reader.readString() };
+			manager.declareVariable(variableID);
+			manager.setVariableInitialValue(variableID, reader.readString());
+		}
+		auto const commandsWithOperationsCount = reader.readUint32();
+		for (size_t i = 0; i < commandsWithOperationsCount; ++i) {
+			auto const commandIndex = static_cast<size_t>(reader.readUint64());
+			auto const operationsCount = reader.readUint32();
+			for (size_t operationIndex = 0; operationIndex < operationsCount; ++operationIndex) {
+				manager.addOperationToExecuteOnCommand(commandIndex, readVariableOperation(reader));
+			}
+		}
+	}
+}
+
+void writeImages(ConfigBundleWriter & writer, ImageResourcesInfosContainer const & imagesConfig, CommandsInfoContainer::EnvsContainer const & environments)
+{
+	auto const images = imagesConfig.getAllRegisteredImages();
+	writer.writeUint32(images.size());
+	for (auto const & image : images) {
+		writer.writeString(image.first.getValue());
+		writer.writeString(image.second.filepath);
+		writer.writeUint64(image.second.origin.x);
+		writer.writeUint64(image.second.origin.y);
+		writer.writeUint64(image.second.size.x);
+		writer.writeUint64(image.second.size.y);
+	}
+	for (auto const & environment : environments) {
+		auto const & mappings = imagesConfig.getImagesInfo(environment);
+		writer.writeUint32(mappings.size());
+		for (auto const & mapping : mappings) {
+			writer.writeString(mapping.first.getValue());
+			writer.writeString(mapping.second.getValue());
+		}
+	}
+}
+
+void readImages(ConfigBundleReader & reader, ImageResourcesInfosContainer & target, CommandsInfoContainer::EnvsContainer const & environments)
+{
+	auto const imagesCount = reader.readUint32();
+	for (size_t i = 0; i < imagesCount; ++i) {
+		auto const imageID = ImageID{ reader.readString() };
+		auto imageInfo = ImagePhysicalInfo{};
+		imageInfo.filepath = reader.readString();
+		imageInfo.origin.x = static_cast<size_t>(reader.readUint64());
+		imageInfo.origin.y = static_cast<size_t>(reader.readUint64());
+		imageInfo.size.x = static_cast<size_t>(reader.readUint64());
+		imageInfo.size.y = static_cast<size_t>(reader.readUint64());
+		target.mapPhysicalImageInfoToID(imageID, imageInfo);
+	}
+	for (auto const & environment : environments) {
+		auto const mappingsCount = reader.readUint32();
+		for (size_t i = 0; i < mappingsCount; ++i) {
+			auto const commandID = CommandID{ reader.readString() };
+			auto const imageID = ImageID{ reader.readString() };
+			target.addImageReferenceForEnv(commandID, environment, imageID);
+		}
+	}
+}
+
+void writeLayoutPage(ConfigBundleWriter & writer, LayoutPageTemplate const & page)
+{
+	writer.writeString(page.get_note());
+	auto const & rows = page.get_rows();
+	writer.writeUint32(rows.size());
+	for (auto const & row : rows) {
+		writer.writeUint32(row.size());
+		for (auto const & element : row) {
+			auto const & options = element.getOptions();
+			writer.writeUint32(options.size());
+			for (auto const & option : options) {
+				writer.writeUint8(option.isVariableLabel() ? 1 : 0);
+				writer.writeString(option.getValue());
+			}
+		}
+	}
+}
+
+LayoutPageTemplate readLayoutPage(ConfigBundleReader & reader)
+{
+	auto result = LayoutPageTemplate{ reader.readString() };
+	auto const rowsCount = reader.readUint32();
+	for (size_t rowIndex = 0; rowIndex < rowsCount; ++rowIndex) {
+		auto row = std::vector<LayoutElementTemplate>{};
+		auto const elementsCount = reader.readUint32();
+		for (size_t elementIndex = 0; elementIndex < elementsCount; ++elementIndex) {
+			auto options = LayoutElementTemplate::OptionsContainer{};
+			auto const optionsCount = reader.readUint32();
+			for (size_t optionIndex = 0; optionIndex < optionsCount; ++optionIndex) {
+				auto const isVariableLabel = (reader.readUint8() != 0);
+				auto const value = reader.readString();
+				if (isVariableLabel) {
+					options.push_back(LayoutElementOptionToDisplay{ VariableID{ value } });
+				} else {
+					options.push_back(LayoutElementOptionToDisplay{ CommandID{ value } });
+				}
+			}
+			row.push_back(LayoutElementTemplate{ options });
+		}
+		result.push_row(row);
+	}
+	return result;
+}
+
+void writeLayout(ConfigBundleWriter & writer, LayoutUserInformation const & layout)
+{
+	auto const & pages = layout.getLayoutPages();
+	writer.writeUint32(pages.size());
+	for (auto const & page : pages) {
+		writeLayoutPage(writer, page);
+	}
+	auto const & selectorPages = layout.getOptionsSelectorPages();
+	writer.writeUint32(selectorPages.size());
+	for (auto const & selectorPage : selectorPages) {
+		writer.writeString(selectorPage.first.getValue());
+		writeLayoutPage(writer, selectorPage.second);
+	}
+}
+
+LayoutUserInformation readLayout(ConfigBundleReader & reader)
+{
+	auto result = LayoutUserInformation{};
+	auto const pagesCount = reader.readUint32();
+	for (size_t i = 0; i < pagesCount; ++i) {
+		result.push(readLayoutPage(reader));
+	}
+	auto const selectorPagesCount = reader.readUint32();
+	for (size_t i = 0; i < selectorPagesCount; ++i) {
+		auto const commandID = CommandID{ reader.readString() };
+		result.insert_selector_page(commandID, readLayoutPage(reader));
+	}
+	return result;
+}
+} //namespace
+
+LINKAGE_RESTRICTION uint64_t calculateConfigContentsHash(StringRef const & contents)
+{
+	return calculateStringHash(contents);
+}
+
+LINKAGE_RESTRICTION bool ConfigBundleSourceFile::operator == (ConfigBundleSourceFile const & other) const
+{
+	return (m_path == other.m_path) && (m_exists == other.m_exists) && (m_contentsHash == other.m_contentsHash);
+}
+
+LINKAGE_RESTRICTION ConfigBundleSourceFile ConfigBundleSourceFile::create(std::string const & path)
+{
+	MappedConfigFile file(path);
+	if (!file.is_open()) {
+		return ConfigBundleSourceFile{ path, false, 0 };
+	}
+	return ConfigBundleSourceFile{ path, true, calculateConfigContentsHash(file.getContents()) };
+}
+
+LINKAGE_RESTRICTION void writeConfigBundle(std::ostream & target, ConfigBundleSources const & sources,
+	CommandsInfoContainer const & commandsConfig, ImageResourcesInfosContainer const & imagesConfig, LayoutUserInformation const & layout)
+{
+	ConfigBundleWriter writer(target);
+	writer.writeString(CONFIG_BUNDLE_SIGNATURE());
+	writer.writeUint32(CONFIG_BUNDLE_FORMAT_VERSION);
+	writeSources(writer, sources);
+	auto const & environments = commandsConfig.getEnvironments();
+	writer.writeUint32(environments.size());
+	for (auto const & environment : environments) {
+		writer.writeString(environment);
+	}
+	writeCommands(writer, commandsConfig);
+	writeVariablesManagers(writer, commandsConfig);
+	writeImages(writer, imagesConfig, environments);
+	writeLayout(writer, layout);
+}
+
+LINKAGE_RESTRICTION ConfigBundleSources readConfigBundleSources(StringRef const & bundleData)
+{
+	ConfigBundleReader reader(bundleData);
+	return readHeaderAndSources(reader);
+}
+
+LINKAGE_RESTRICTION ConfigBundleContents readConfigBundle(StringRef const & bundleData, PrecompiledHotkeyCombinationFactoryMethod hotkey_builder, MouseInputsFactoryMethod mouse_inputs_builder, SleepInputsFactoryMethod sleep_objects_builder, TextTypingFactoryMethod text_typing_builder)
+{
+	ConfigBundleReader reader(bundleData);
+	readHeaderAndSources(reader);
+	auto environments = CommandsInfoContainer::EnvsContainer{};
+	auto const environmentsCount = reader.readUint32();
+	for (size_t i = 0; i < environmentsCount; ++i) {
+		environments.push_back(reader.readString());
+	}
+	auto commandsConfig = CommandsInfoContainer{ ParsedCsvRow{ environments } };
+	readCommands(reader, commandsConfig, hotkey_builder, mouse_inputs_builder, sleep_objects_builder, text_typing_builder);
+	readVariablesManagers(reader, commandsConfig);
+	auto imagesConfig = ImageResourcesInfosContainer{ environments };
+	readImages(reader, imagesConfig, environments);
+	auto layout = readLayout(reader);
+	if (!reader.isFinished()) {
+		throw std::runtime_error("Unexpected data at the end of the precompiled configs bundle.");
+	}
+	return ConfigBundleContents{ commandsConfig, imagesConfig, layout };
+}
+
+} //namespace core
+} //namespace hat
+
+#undef LINKAGE_RESTRICTION
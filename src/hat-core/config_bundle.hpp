@@ -0,0 +1,66 @@
+// This source file is part of the 'hat' open source project.
+// Copyright (c) 2016, Yuriy Vosel.
+// Licensed under Boost Software License.
+// See LICENSE.txt for the licence information.
+
+#ifndef CONFIG_BUNDLE_HPP
+#define CONFIG_BUNDLE_HPP
+
+#include "commands_data_extraction.hpp"
+#include "user_defined_layout.hpp"
+#include "string_ref.hpp"
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// The code here is responsible for the precompiled configs bundle - a binary file, which holds all the already parsed and validated configs.
+// Loading this file is much faster than parsing the text configs, because no text processing and no verifications are done.
+// The bundle also holds the list of the config files it was compiled from (with the hashes of their contents), so the user code can
+// check if the bundle is still up to date, and parse the text configs if it is not.
+namespace hat {
+namespace core {
+
+// 64-bit FNV-1a hash of the config file contents. It is not a cryptographic hash - it is only used for detecting the changes in the config files.
+uint64_t calculateConfigContentsHash(StringRef const & contents);
+
+struct ConfigBundleSourceFile
+{
+	std::string m_path;
+	bool m_exists;
+	uint64_t m_contentsHash; // 0 if the file does not exist
+	bool operator == (ConfigBundleSourceFile const & other) const;
+	bool operator != (ConfigBundleSourceFile const & other) const { return !(*this == other); };
+	static ConfigBundleSourceFile create(std::string const & path); // reads the file and calculates the hash of its contents
+};
+typedef std::vector<ConfigBundleSourceFile> ConfigBundleSources;
+
+// All the configs data, which is stored inside the bundle.
+struct ConfigBundleContents
+{
+	CommandsInfoContainer m_commandsConfig;
+	ImageResourcesInfosContainer m_imagesConfig;
+	LayoutUserInformation m_layout;
+};
+
+void writeConfigBundle(std::ostream & target, ConfigBundleSources const & sources,
+	CommandsInfoContainer const & commandsConfig, ImageResourcesInfosContainer const & imagesConfig, LayoutUserInformation const & layout);
+
+// Reads only the list of the source files from the bundle header (this is enough for checking, if the bundle is up to date).
+// Throws, if the data is not a bundle, or if it was written by another version of the tool.
+ConfigBundleSources readConfigBundleSources(StringRef const & bundleData);
+
+// Note: the input objects for the commands can't be stored in the file as they are (for example, the tool's objects hold the data from the platform-dependent input simulation library).
+// That is why their text representations are stored. On loading, the command objects are recreated through the same factory methods, which are used during the text configs parsing.
+// The hotkey combinations are stored together with their compiled data, so they are recreated without compiling them again (see PrecompiledHotkeyCombinationFactoryMethod),
+// and the aggregated commands are stored with the indices of the commands they reference.
+ConfigBundleContents readConfigBundle(StringRef const & bundleData, PrecompiledHotkeyCombinationFactoryMethod hotkey_builder, MouseInputsFactoryMethod mouse_inputs_builder, SleepInputsFactoryMethod sleep_objects_builder, TextTypingFactoryMethod text_typing_builder);
+
+} //namespace core
+} //namespace hat
+
+#ifdef HAT_CORE_HEADERONLY_MODE
+#include "config_bundle.cpp"
+#endif //HAT_CORE_HEADERONLY_MODE
+
+#endif //CONFIG_BUNDLE_HPP
@@ -0,0 +1,150 @@
+// This source file is part of the 'hat' open source project.
+// Copyright (c) 2016, Yuriy Vosel.
+// Licensed under Boost Software License.
+// See LICENSE.txt for the licence information.
+
+#ifndef HAT_CORE_HEADERONLY_MODE
+#include "config_file_reader.hpp"
+#endif
+#include "utils.hpp"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif //_WIN32
+
+#ifndef HAT_CORE_HEADERONLY_MODE
+#define LINKAGE_RESTRICTION
+#else
+#define LINKAGE_RESTRICTION inline
+#endif
+
+namespace hat {
+namespace core {
+
+#ifdef _WIN32
+LINKAGE_RESTRICTION MappedConfigFile::MappedConfigFile(std::string const & filePath)
+{
+	auto fileHandle = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (fileHandle == INVALID_HANDLE_VALUE) {
+		return;
+	}
+	m_fileHandle = fileHandle;
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(fileHandle, &fileSize)) {
+		release();
+		return;
+	}
+	if (fileSize.QuadPart == 0) { // Empty file can't be mapped, but it is still a valid (empty) config.
+		m_isOpen = true;
+		return;
+	}
+	m_mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (m_mappingHandle == NULL) {
+		release();
+		return;
+	}
+	m_data = static_cast<char const *>(MapViewOfFile(m_mappingHandle, FILE_MAP_READ, 0, 0, 0));
+	if (m_data == nullptr) {
+		release();
+		return;
+	}
+	m_size = static_cast<size_t>(fileSize.QuadPart);
+	m_isOpen = true;
+}
+
+LINKAGE_RESTRICTION void MappedConfigFile::release()
+{
+	if (m_data != nullptr) {
+		UnmapViewOfFile(m_data);
+	}
+	if (m_mappingHandle != nullptr) {
+		CloseHandle(m_mappingHandle);
+	}
+	if (m_fileHandle != nullptr) {
+		CloseHandle(m_fileHandle);
+	}
+	m_data = nullptr;
+	m_mappingHandle = nullptr;
+	m_fileHandle = nullptr;
+	m_size = 0;
+	m_isOpen = false;
+}
+#else
+LINKAGE_RESTRICTION MappedConfigFile::MappedConfigFile(std::string const & filePath)
+{
+	auto fileDescriptor = open(filePath.c_str(), O_RDONLY);
+	if (fileDescriptor == -1) {
+		return;
+	}
+	struct stat fileInfo;
+	if ((fstat(fileDescriptor, &fileInfo) != 0) || !S_ISREG(fileInfo.st_mode)) {
+		close(fileDescriptor);
+		return;
+	}
+	if (fileInfo.st_size > 0) { // Empty file can't be mapped, but it is still a valid (empty) config.
+		auto mappedData = mmap(nullptr, static_cast<size_t>(fileInfo.st_size), PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+		if (mappedData == MAP_FAILED) {
+			close(fileDescriptor);
+			return;
+		}
+		m_data = static_cast<char const *>(mappedData);
+		m_size = static_cast<size_t>(fileInfo.st_size);
+	}
+	close(fileDescriptor); // The mapping stays valid after the descriptor is closed.
+	m_isOpen = true;
+}
+
+LINKAGE_RESTRICTION void MappedConfigFile::release()
+{
+	if (m_data != nullptr) {
+		munmap(const_cast<char *>(m_data), m_size);
+	}
+	m_data = nullptr;
+	m_size = 0;
+	m_isOpen = false;
+}
+#endif //_WIN32
+
+LINKAGE_RESTRICTION MappedConfigFile::~MappedConfigFile()
+{
+	release();
+}
+
+LINKAGE_RESTRICTION bool BufferLinesReader::getLine(StringRef & target)
+{
+	if (m_position >= m_data.size()) {
+		return false;
+	}
+	auto lineEnd = m_data.find('\n', m_position);
+	if (lineEnd == StringRef::npos) {
+		lineEnd = m_data.size();
+	}
+	target = m_data.substr(m_position, lineEnd - m_position);
+	if (!target.empty() && (target.back() == '\r')) {
+		target = target.substr(0, target.size() - 1);
+	}
+	m_position = lineEnd + 1;
+	return true;
+}
+
+LINKAGE_RESTRICTION bool StreamLinesReader::getLine(StringRef & target)
+{
+	if (!getLineFromFile(m_dataSource, m_currentLine)) {
+		return false;
+	}
+	target = m_currentLine;
+	return true;
+}
+
+} //namespace core
+} //namespace hat
+
+#undef LINKAGE_RESTRICTION
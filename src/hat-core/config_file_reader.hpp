@@ -0,0 +1,70 @@
+// This source file is part of the 'hat' open source project.
+// Copyright (c) 2016, Yuriy Vosel.
+// Licensed under Boost Software License.
+// See LICENSE.txt for the licence information.
+
+#ifndef CONFIG_FILE_READER_HPP
+#define CONFIG_FILE_READER_HPP
+
+#include "string_ref.hpp"
+#include <istream>
+#include <string>
+
+namespace hat {
+namespace core {
+
+// Read-only memory mapping of the whole config file.
+// The file is mapped once, and the parsing code walks over the mapped bytes without copying them.
+// Similar to the std::fstream, the constructor does not throw, if the file can't be opened. The user code should check the is_open() result.
+class MappedConfigFile
+{
+	char const * m_data{ nullptr };
+	size_t m_size{ 0 };
+	bool m_isOpen{ false };
+#ifdef _WIN32
+	void * m_fileHandle{ nullptr };
+	void * m_mappingHandle{ nullptr };
+#endif //_WIN32
+	void release();
+public:
+	explicit MappedConfigFile(std::string const & filePath);
+	~MappedConfigFile();
+	MappedConfigFile(MappedConfigFile const &) = delete;
+	MappedConfigFile & operator = (MappedConfigFile const &) = delete;
+
+	bool is_open() const { return m_isOpen; };
+	StringRef getContents() const { return StringRef(m_data, m_size); };
+};
+
+// These classes provide the lines of the config file one by one for the parsing code.
+// Both of them strip the trailing '\r' symbol (the config files could be edited on windows).
+// The returned line reference stays valid until the next getLine() call.
+
+// Finds the lines in place inside the already loaded buffer (for example, the contents of the MappedConfigFile).
+class BufferLinesReader
+{
+	StringRef m_data;
+	size_t m_position{ 0 };
+public:
+	explicit BufferLinesReader(StringRef const & data) : m_data(data) {};
+	bool getLine(StringRef & target);
+};
+
+// Reads the lines from the stream (kept for the code, which does not work with files directly - the unit tests, for example).
+class StreamLinesReader
+{
+	std::istream & m_dataSource;
+	std::string m_currentLine;
+public:
+	explicit StreamLinesReader(std::istream & dataSource) : m_dataSource(dataSource) {};
+	bool getLine(StringRef & target);
+};
+
+} //namespace core
+} //namespace hat
+
+#ifdef HAT_CORE_HEADERONLY_MODE
+#include "config_file_reader.cpp"
+#endif //HAT_CORE_HEADERONLY_MODE
+
+#endif //CONFIG_FILE_READER_HPP
@@ -7,6 +7,10 @@
 #include "configs_abstraction_layer.hpp"
 #endif
 
+#include "utils.hpp"
+#include <algorithm>
+#include <functional>
+#include <map>
 #include <set>
 #include <sstream>
 
@@ -19,78 +23,254 @@
 namespace hat {
 namespace core {
 
-LINKAGE_RESTRICTION ConfigsAbstractionLayer::ConfigsAbstractionLayer(LayoutUserInformation const & layoutInfo, CommandsInfoContainer const & commandsConfig, ImageResourcesInfosContainer const & imagesConfig)
-	: m_layoutInfo(layoutInfo), m_commandsConfig(commandsConfig), m_imagesConfig(imagesConfig)
+LINKAGE_RESTRICTION ResolvedLayout ResolvedLayout::resolve(LayoutUserInformation const & layoutInfo, CommandsInfoContainer const & commandsConfig)
 {
-	for (auto const & command : m_commandsConfig.m_commandsList) {
-		if (m_layoutInfo.contains_selector(command.commandID)) {
+	for (auto const & command : commandsConfig.getAllCommands()) {
+		if (layoutInfo.contains_selector(command.commandID)) {
 			std::stringstream error;
 			error << "A conflict of IDs: the same string is used as an ID for a command and a options picker page. This is not allowed. The problem ID='" << command.commandID.getValue() << '\'';
 			throw std::runtime_error(error.str()); //TODO: test this
 		}
 	}
 	//TODO: add the verification code here (verify that there are no duplicates in IDs), verify the commands referencing images exist
+
+	auto result = ResolvedLayout{};
+
+	// The indices of the selector pages are assigned in the topological order (the referenced pages get their indices first):
+	auto selectorPagesIndices = std::map<CommandID, size_t>{};
+	auto selectorsPath = std::vector<CommandID>{}; // the selector pages, which are currently being visited (each next one is referenced from the previous one)
+	std::function<void(LayoutUserInformation::OptionsSelctorsContainer::const_iterator)> visitSelectorPage = [&](LayoutUserInformation::OptionsSelctorsContainer::const_iterator selectorPage) {
+		if (selectorPagesIndices.count(selectorPage->first) > 0) {
+			return;
+		}
+		auto const cycleStart = std::find(selectorsPath.begin(), selectorsPath.end(), selectorPage->first);
+		if (cycleStart != selectorsPath.end()) {
+			std::stringstream error;
+			error << "The options selector pages reference each other cyclically. This is not allowed. The problem pages IDs: ";
+			for (auto pathElement = cycleStart; pathElement != selectorsPath.end(); ++pathElement) {
+				error << '\'' << pathElement->getValue() << "' -> ";
+			}
+			error << '\'' << selectorPage->first.getValue() << '\'';
+			throw std::runtime_error(error.str());
+		}
+		selectorsPath.push_back(selectorPage->first);
+		for (auto const & row : selectorPage->second.get_rows()) {
+			for (auto const & elem : row) {
+				for (auto const & option : elem.getOptions()) {
+					if (!option.isVariableLabel()) {
+						auto const referencedSelectorPage = layoutInfo.find_selector(option.getComandID());
+						if (referencedSelectorPage != layoutInfo.non_existent_selector()) {
+							visitSelectorPage(referencedSelectorPage);
+						}
+					}
+				}
+			}
+		}
+		selectorsPath.pop_back();
+		selectorPagesIndices.emplace(selectorPage->first, selectorPagesIndices.size());
+	};
+	for (auto selectorPage = layoutInfo.getOptionsSelectorPages().begin(); selectorPage != layoutInfo.getOptionsSelectorPages().end(); ++selectorPage) {
+		visitSelectorPage(selectorPage);
+	}
+
+	auto variablesIndices = std::map<VariableID, size_t>{};
+	auto unknownIDs = std::set<std::string>{};
+
+	auto const resolveOption = [&](LayoutElementOptionToDisplay const & option) -> Option {
+		if (option.isVariableLabel()) {
+			auto const variableIndex = variablesIndices.emplace(option.getVariableID(), variablesIndices.size());
+			if (variableIndex.second) {
+				result.m_variables.push_back(option.getVariableID());
+			}
+			return Option{ Option::Type::VARIABLE, variableIndex.first->second };
+		}
+		auto const commandIndex = commandsConfig.findCommandIndex(option.getComandID());
+		if (commandIndex.first) {
+			return Option{ Option::Type::COMMAND, commandIndex.second };
+		}
+		auto const selectorPageIndex = selectorPagesIndices.find(option.getComandID());
+		if (selectorPageIndex != selectorPagesIndices.end()) {
+			return Option{ Option::Type::SELECTOR_PAGE, selectorPageIndex->second };
+		}
+		unknownIDs.insert(option.getComandID().getValue());
+		return Option{ Option::Type::UNKNOWN_ID, 0 };
+	};
+	auto const resolvePage = [&](LayoutPageTemplate const & pageTemplate) {
+		auto page = Page{ escapeRawUTF8_forJson(pageTemplate.get_note()), {} };
+		page.m_rows.reserve(pageTemplate.get_rows().size());
+		for (auto const & row : pageTemplate.get_rows()) {
+			page.m_rows.emplace_back();
+			page.m_rows.back().reserve(row.size());
+			for (auto const & elem : row) {
+				auto resolvedElement = Element{};
+				resolvedElement.reserve(elem.getOptions().size());
+				for (auto const & option : elem.getOptions()) {
+					resolvedElement.push_back(resolveOption(option));
+				}
+				page.m_rows.back().push_back(resolvedElement);
+			}
+		}
+		return page;
+	};
+
+	for (auto const & pageTemplate : layoutInfo.getLayoutPages()) {
+		result.m_pages.push_back(resolvePage(pageTemplate));
+	}
+	result.m_selectorPages.resize(selectorPagesIndices.size());
+	for (auto const & selectorPage : layoutInfo.getOptionsSelectorPages()) {
+		result.m_selectorPages[selectorPagesIndices[selectorPage.first]] = resolvePage(selectorPage.second);
+	}
+
+	// The variables are declared separately for each of the environments:
+	auto const environmentsCount = commandsConfig.getEnvironments().size();
+	result.m_definedVariablesForEnvironments.assign(environmentsCount, std::vector<bool>(result.m_variables.size(), false));
+	auto definedForAnyEnvironment = std::vector<bool>(result.m_variables.size(), false);
+	for (size_t environmentIndex = 0; environmentIndex < environmentsCount; ++environmentIndex) {
+		auto const & variablesManager = commandsConfig.getVariablesManagers_c().getManagerForEnv_c(environmentIndex);
+		for (size_t variableIndex = 0; variableIndex < result.m_variables.size(); ++variableIndex) {
+			if (variablesManager.variableExists(result.m_variables[variableIndex])) {
+				result.m_definedVariablesForEnvironments[environmentIndex][variableIndex] = true;
+				definedForAnyEnvironment[variableIndex] = true;
+			}
+		}
+	}
+	for (size_t variableIndex = 0; variableIndex < result.m_variables.size(); ++variableIndex) {
+		if (!definedForAnyEnvironment[variableIndex]) {
+			unknownIDs.insert(LayoutElementOptionToDisplay::VARIABLE_DEF_CONFIG_PREFIX() + result.m_variables[variableIndex].getValue());
+		}
+	}
+	result.m_unknownIDs.assign(unknownIDs.begin(), unknownIDs.end());
+
+	result.m_commandsNotes.reserve(commandsConfig.getAllCommands().size());
+	for (auto const & command : commandsConfig.getAllCommands()) {
+		result.m_commandsNotes.push_back(escapeRawUTF8_forJson(command.commandNote));
+	}
+	result.m_environmentsNames.reserve(environmentsCount);
+	for (auto const & environmentName : commandsConfig.getEnvironments()) {
+		result.m_environmentsNames.push_back(escapeRawUTF8_forJson(environmentName));
+	}
+
+	// The activity of the pages does not depend on anything but the enabled commands, so it is calculated here once (bottom-up, see the order of the selector pages).
+	result.m_activeSelectorPagesForEnvironments.assign(environmentsCount, std::vector<bool>(result.m_selectorPages.size(), false));
+	result.m_activePagesForEnvironments.assign(environmentsCount, std::vector<bool>(result.m_pages.size(), false));
+	for (size_t environmentIndex = 0; environmentIndex < environmentsCount; ++environmentIndex) {
+		for (size_t selectorPageIndex = 0; selectorPageIndex < result.m_selectorPages.size(); ++selectorPageIndex) {
+			result.m_activeSelectorPagesForEnvironments[environmentIndex][selectorPageIndex] = result.isPageActive(result.m_selectorPages[selectorPageIndex], environmentIndex, commandsConfig);
+		}
+		for (size_t pageIndex = 0; pageIndex < result.m_pages.size(); ++pageIndex) {
+			result.m_activePagesForEnvironments[environmentIndex][pageIndex] = result.isPageActive(result.m_pages[pageIndex], environmentIndex, commandsConfig);
+		}
+	}
+	return result;
 }
 
-LINKAGE_RESTRICTION InternalLayoutRepresentation ConfigsAbstractionLayer::generateLayoutPresentation(size_t selectedEnv, bool isEnv_selected)
+// The element displays the first option, which is enabled for the environment (the variables are always displayed, but as labels, which are not active).
+LINKAGE_RESTRICTION bool ResolvedLayout::isElementActive(Element const & element, size_t environmentIndex, CommandsInfoContainer const & commandsConfig) const
+{
+	for (auto const & option : element) {
+		switch (option.m_type) {
+		case Option::Type::VARIABLE:
+			return false;
+		case Option::Type::COMMAND:
+			if (commandsConfig.isCommandEnabled(option.m_index, environmentIndex)) {
+				return true;
+			}
+			break;
+		case Option::Type::SELECTOR_PAGE:
+			if (isSelectorPageActive(option.m_index, environmentIndex)) {
+				return true;
+			}
+			break;
+		case Option::Type::UNKNOWN_ID:
+			break;
+		}
+	}
+	return false;
+}
+
+LINKAGE_RESTRICTION bool ResolvedLayout::isPageActive(Page const & page, size_t environmentIndex, CommandsInfoContainer const & commandsConfig) const
 {
-	std::set<CommandID> activeIDs;
-	for (auto const & command : m_commandsConfig.m_commandsList) {
-		if (command.hotkeysForEnvironments[selectedEnv]->enabled) {
-			activeIDs.insert(command.commandID);
+	for (auto const & row : page.m_rows) {
+		for (auto const & elem : row) {
+			if (isElementActive(elem, environmentIndex, commandsConfig)) {
+				return true;
+			}
 		}
 	}
+	return false;
+}
+
+LINKAGE_RESTRICTION ConfigsAbstractionLayer::ConfigsAbstractionLayer(LayoutUserInformation const & layoutInfo, CommandsInfoContainer const & commandsConfig, ImageResourcesInfosContainer const & imagesConfig)
+	: ConfigsAbstractionLayer(std::make_shared<ResolvedLayout const>(ResolvedLayout::resolve(layoutInfo, commandsConfig)), commandsConfig, imagesConfig)
+{
+}
+
+LINKAGE_RESTRICTION ConfigsAbstractionLayer::ConfigsAbstractionLayer(std::shared_ptr<ResolvedLayout const> const & resolvedLayout, CommandsInfoContainer const & commandsConfig, ImageResourcesInfosContainer const & imagesConfig)
+	: m_resolvedLayout(resolvedLayout), m_commandsConfig(commandsConfig), m_imagesConfig(imagesConfig)
+{
+}
+
+LINKAGE_RESTRICTION InternalLayoutRepresentation ConfigsAbstractionLayer::generateLayoutPresentation(size_t selectedEnv, bool isEnv_selected)
+{
 	std::string const selectedEnvID = isEnv_selected ? m_commandsConfig.getEnvironments()[selectedEnv] : "";
-	
+	auto const & resolvedLayout = *m_resolvedLayout;
+	auto const & commands = m_commandsConfig.getAllCommands();
+
+	// The options selector pages are generated only once for each selector (the environment is fixed within this call), and the result is shared
+	// by all the buttons, which reference it (also from the nested selector pages). This keeps the generation cost linear in the number of distinct selector pages.
+	// Note: the result is not kept between the calls, because the generated pages contain the current variables values.
+	auto generatedSelectorPages = std::vector<std::shared_ptr<InternalLayoutPageRepresentation>>(resolvedLayout.getSelectorPages().size());
+	std::function<std::shared_ptr<InternalLayoutPageRepresentation>(ResolvedLayout::Page const &)> createLayoutPage;
+	auto getSelectorPage = [&](size_t selectorPageIndex) -> std::shared_ptr<InternalLayoutPageRepresentation>
+	{
+		auto & generatedPage = generatedSelectorPages[selectorPageIndex];
+		if (!generatedPage) {
+			generatedPage = createLayoutPage(resolvedLayout.getSelectorPages()[selectorPageIndex]);
+		}
+		return generatedPage;
+	};
+
 	//cannot leave the type of this lambda as 'auto' because of it's recursive nature. TODO: maybe will extract this code outside, so it is easier to maintain and reason about it
-	std::function<std::shared_ptr<InternalLayoutPageRepresentation>(LayoutPageTemplate const &)> createLayoutPage
-		= [&](LayoutPageTemplate const & templateToUse) -> std::shared_ptr<InternalLayoutPageRepresentation>
+	createLayoutPage = [&](ResolvedLayout::Page const & pageToUse) -> std::shared_ptr<InternalLayoutPageRepresentation>
 	{
-		//TODO!!! add protection from the cyclical dependencies for the options pages selectors!!!!
-		std::shared_ptr<InternalLayoutPageRepresentation> result = std::make_shared<InternalLayoutPageRepresentation>(templateToUse.get_note());
-		for (auto const & row : templateToUse.get_rows()) {
+		std::shared_ptr<InternalLayoutPageRepresentation> result = std::make_shared<InternalLayoutPageRepresentation>(pageToUse.m_note);
+		for (auto const & row : pageToUse.m_rows) {
 			std::vector<InternalLayoutElementRepresentation> currentRow;
 			for (auto const & elem : row) {
 				bool foundActiveElementForThisPosition = false;
 				std::string firstNonEmptyNote(""); //This is a fallback element, which will be used, if we don't find any suitable active command (or variable) for this position
-				for (auto const & currentOption : elem.getOptions()) {
+				for (auto const & currentOption : elem) {
 
 					//TODO: refactor and clean up the logic here (after adding the unit tests for it).
 					InternalLayoutElementRepresentation testElement;
 
+					//NOTE: here we don't need to check variables (because they are always active), so, if we find a variable, we will not need the fallback string for inactive button.
 					if (firstNonEmptyNote.size() == 0) {
-						if (!currentOption.isVariableLabel()) { //NOTE: here we don't need to check variables (because they are always active), so, if we find a variable, we will not need the fallback string for inactive button.
-							auto const & commandID = currentOption.getComandID();
-							if (m_commandsConfig.hasCommandID(commandID)) {
-								firstNonEmptyNote = m_commandsConfig.getCommandPrefs(commandID).commandNote;
-							} else {
-								auto foundIter = m_layoutInfo.find_selector(commandID);
-								if (foundIter != m_layoutInfo.non_existent_selector()) {
-									//TODO: get rid of this copy-paste (see code below)
-									firstNonEmptyNote = foundIter->second.get_note();
-								}
-							}
+						if (currentOption.m_type == ResolvedLayout::Option::Type::COMMAND) {
+							firstNonEmptyNote = resolvedLayout.getCommandNote(currentOption.m_index);
+						} else if (currentOption.m_type == ResolvedLayout::Option::Type::SELECTOR_PAGE) {
+							firstNonEmptyNote = resolvedLayout.getSelectorPages()[currentOption.m_index].m_note;
 						}
 					}
-					if (currentOption.isVariableLabel()) {
+					if (currentOption.m_type == ResolvedLayout::Option::Type::VARIABLE) {
 						auto & variablesManager = m_commandsConfig.getVariablesManagers_c().getManagerForEnv_c(selectedEnv);
-						auto variableID = currentOption.getVariableID();
+						auto const & variableID = resolvedLayout.getVariables()[currentOption.m_index];
 						testElement.setButtonFlag(false);
-						if (variablesManager.variableExists(variableID)) {
-							testElement.setNote(variablesManager.getValue(variableID));
+						if (resolvedLayout.isVariableDefined(currentOption.m_index, selectedEnv)) {
+							testElement.setNote(escapeRawUTF8_forJson_replacingInvalid(variablesManager.getValue(variableID))); // the values of the variables are changed at runtime, so they are escaped here
 							testElement.setReferencingVariableID(variableID);
 						} else {
-							testElement.setNote("<UNKNOWN_VARIABLE>"); // TODO: add warnings during configs parsing that the variable is undefined
+							testElement.setNote("<UNKNOWN_VARIABLE>"); // the variables, which are undefined for all the environments, are reported during the layout resolving (see ResolvedLayout::getUnknownIDs())
 						}
 						currentRow.push_back(testElement);
 						foundActiveElementForThisPosition = true;
 						break;
-					} else {
-						auto const & commandID = currentOption.getComandID();
-						if (activeIDs.find(commandID) != activeIDs.end()) { // found the element, for which the button should be created
-							testElement.setCommandButtonAttrs(m_commandsConfig.getCommandPrefs(commandID).commandNote, commandID);
+					} else if (currentOption.m_type == ResolvedLayout::Option::Type::COMMAND) {
+						if (m_commandsConfig.isCommandEnabled(currentOption.m_index, selectedEnv)) { // found the element, for which the button should be created
+							auto const & command = commands[currentOption.m_index];
+							testElement.setCommandButtonAttrs(resolvedLayout.getCommandNote(currentOption.m_index), command.commandID);
 							if (isEnv_selected) {
-								auto const imageID = m_imagesConfig.getImageID(commandID, selectedEnvID);
+								auto const imageID = m_imagesConfig.getImageID(command.commandID, selectedEnvID);
 								if (imageID.first) {
 									testElement.setImageID(imageID.second);
 								}
@@ -98,24 +278,21 @@ LINKAGE_RESTRICTION InternalLayoutRepresentation ConfigsAbstractionLayer::genera
 							currentRow.push_back(testElement);
 							foundActiveElementForThisPosition = true;
 							break;
-						} else { //try to find the options selection page:
-							auto foundIter = m_layoutInfo.find_selector(commandID);
-							if (foundIter != m_layoutInfo.non_existent_selector()) {
-								testElement.setSelectorButtonAttrs(foundIter->second.get_note(), createLayoutPage(foundIter->second));
-								if (testElement.isActive()) {
-									currentRow.push_back(testElement);
-									foundActiveElementForThisPosition = true;
-									break;
-								}
-							}
+						}
+					} else if (currentOption.m_type == ResolvedLayout::Option::Type::SELECTOR_PAGE) {
+						if (resolvedLayout.isSelectorPageActive(currentOption.m_index, selectedEnv)) { // the selector pages without the active buttons are not generated at all
+							testElement.setSelectorButtonAttrs(resolvedLayout.getSelectorPages()[currentOption.m_index].m_note, getSelectorPage(currentOption.m_index));
+							currentRow.push_back(testElement);
+							foundActiveElementForThisPosition = true;
+							break;
 						}
 					}
 				}
 				if (!foundActiveElementForThisPosition) {
 					InternalLayoutElementRepresentation testElement;
-					if (elem.getOptions().size() > 0) {
+					if (elem.size() > 0) {
 						if (firstNonEmptyNote.size() == 0) {
-							firstNonEmptyNote = "UNKNOWN ID"; // we should not get here (an exception should be thrown before that - during the configuration files processing)
+							firstNonEmptyNote = "UNKNOWN ID"; // the unknown IDs are reported during the layout resolving (see ResolvedLayout::getUnknownIDs())
 						}
 						testElement.setButtonFlag(true).setNote(firstNonEmptyNote);
 					} else {
@@ -146,7 +323,7 @@ LINKAGE_RESTRICTION InternalLayoutRepresentation ConfigsAbstractionLayer::genera
 				InternalLayoutElementRepresentation toPush;
 
 				if (currentEnvIndex < env_count) {
-					toPush.setButtonFlag(true).setNote(m_commandsConfig.getEnvironments()[currentEnvIndex]);
+					toPush.setButtonFlag(true).setNote(resolvedLayout.getEnvironmentName(currentEnvIndex));
 					if ((currentEnvIndex != selectedEnv) || (!isEnv_selected)) {
 						toPush.setSwitchToAnotherEnv(currentEnvIndex);
 					}
@@ -161,10 +338,9 @@ LINKAGE_RESTRICTION InternalLayoutRepresentation ConfigsAbstractionLayer::genera
 	}
 
 	if (isEnv_selected) {
-		for (auto const & layoutPage : m_layoutInfo.getLayoutPages()) {
-			std::shared_ptr<InternalLayoutPageRepresentation> page = createLayoutPage(layoutPage);
-			if (page->hasActiveUserDefinedButtons()) {
-				result.push_page(*page);
+		for (size_t pageIndex = 0; pageIndex < resolvedLayout.getPages().size(); ++pageIndex) {
+			if (resolvedLayout.isPageActive(pageIndex, selectedEnv)) {
+				result.push_page(*createLayoutPage(resolvedLayout.getPages()[pageIndex]));
 			}
 		}
 	}
@@ -10,16 +10,76 @@
 #include "user_defined_layout.hpp"
 #include "preprocessed_layout.hpp"
 
+#include <memory>
+#include <string>
+#include <vector>
+
 namespace hat {
 namespace core {
 
+// The user-defined layout (see LayoutUserInformation), in which all the string IDs are resolved into the indices of the commands, options selector pages and variables.
+// The resolving is done once per configs loading, so the layout generation does not have to look up anything by the string IDs.
+// The options selector pages are sorted topologically: a selector page references only the selector pages with the smaller indices (the cyclic references are not allowed).
+// This allows to find out, which of the pages have active buttons for each of the environments, in one pass over the pages.
+class ResolvedLayout
+{
+public:
+	struct Option
+	{
+		enum class Type
+		{
+			COMMAND,       // m_index is the index of the command in the CommandsInfoContainer
+			SELECTOR_PAGE, // m_index is the index of the page in getSelectorPages()
+			VARIABLE,      // m_index is the index of the variable in getVariables()
+			UNKNOWN_ID     // the ID is not defined in the configs (see getUnknownIDs()). Such option is never displayed.
+		};
+		Type m_type;
+		size_t m_index;
+	};
+	typedef std::vector<Option> Element; // the options are in the same order, as in the layout config (the first enabled one is displayed)
+	struct Page
+	{
+		std::string m_note; // in the json-ready (escaped) form
+		std::vector<std::vector<Element>> m_rows;
+	};
+private:
+	std::vector<Page> m_pages;
+	std::vector<Page> m_selectorPages;
+	std::vector<VariableID> m_variables;
+	std::vector<std::vector<bool>> m_definedVariablesForEnvironments; // indexed by the environment index and the variable index
+	std::vector<std::vector<bool>> m_activePagesForEnvironments; // the pages, which have active buttons (indexed by the environment index and the page index)
+	std::vector<std::vector<bool>> m_activeSelectorPagesForEnvironments; // the same for the selector pages
+	std::vector<std::string> m_unknownIDs;
+	// The texts, which are displayed in the layouts, are escaped for json only once here (see escapeRawUTF8_forJson()):
+	std::vector<std::string> m_commandsNotes; // indexed by the command index
+	std::vector<std::string> m_environmentsNames;
+
+	bool isElementActive(Element const & element, size_t environmentIndex, CommandsInfoContainer const & commandsConfig) const;
+	bool isPageActive(Page const & page, size_t environmentIndex, CommandsInfoContainer const & commandsConfig) const;
+public:
+	// Throws std::runtime_error, if the same ID is used for a command and an options selector page, or if the options selector pages reference each other cyclically.
+	static ResolvedLayout resolve(LayoutUserInformation const & layoutInfo, CommandsInfoContainer const & commandsConfig);
+
+	std::vector<Page> const & getPages() const { return m_pages; };
+	std::vector<Page> const & getSelectorPages() const { return m_selectorPages; };
+	std::vector<VariableID> const & getVariables() const { return m_variables; };
+	bool isVariableDefined(size_t variableIndex, size_t environmentIndex) const { return (environmentIndex < m_definedVariablesForEnvironments.size()) && m_definedVariablesForEnvironments[environmentIndex][variableIndex]; };
+	bool isPageActive(size_t pageIndex, size_t environmentIndex) const { return (environmentIndex < m_activePagesForEnvironments.size()) && m_activePagesForEnvironments[environmentIndex][pageIndex]; };
+	bool isSelectorPageActive(size_t selectorPageIndex, size_t environmentIndex) const { return (environmentIndex < m_activeSelectorPagesForEnvironments.size()) && m_activeSelectorPagesForEnvironments[environmentIndex][selectorPageIndex]; };
+	std::vector<std::string> const & getUnknownIDs() const { return m_unknownIDs; }; // the IDs, which are referenced in the layout, but are not defined for any of the environments
+	std::string const & getCommandNote(size_t commandIndex) const { return m_commandsNotes[commandIndex]; }; // in the json-ready (escaped) form
+	std::string const & getEnvironmentName(size_t environmentIndex) const { return m_environmentsNames[environmentIndex]; }; // in the json-ready (escaped) form
+};
+
 class ConfigsAbstractionLayer
 {
-	LayoutUserInformation const & m_layoutInfo;
+	std::shared_ptr<ResolvedLayout const> m_resolvedLayout;
 	CommandsInfoContainer const & m_commandsConfig;
 	ImageResourcesInfosContainer const & m_imagesConfig;
 public:
 	ConfigsAbstractionLayer(LayoutUserInformation const & layoutInfo, CommandsInfoContainer const & commandsConfig, ImageResourcesInfosContainer const & imagesConfig);
+	// The resolvedLayout should be resolved for the same commandsConfig (see ResolvedLayout::resolve()).
+	ConfigsAbstractionLayer(std::shared_ptr<ResolvedLayout const> const & resolvedLayout, CommandsInfoContainer const & commandsConfig, ImageResourcesInfosContainer const & imagesConfig);
 	InternalLayoutRepresentation generateLayoutPresentation(size_t selectedEnv, bool isEnv_selected);
 };
 } //namespace core
@@ -0,0 +1,63 @@
+// This source file is part of the 'hat' open source project.
+// Copyright (c) 2016, Yuriy Vosel.
+// Licensed under Boost Software License.
+// See LICENSE.txt for the licence information.
+
+#ifndef HAT_CORE_HEADERONLY_MODE
+#include "configs_reload_cache.hpp"
+#endif
+#include <sstream>
+#include <stdexcept>
+
+#ifndef HAT_CORE_HEADERONLY_MODE
+#define LINKAGE_RESTRICTION
+#else
+#define LINKAGE_RESTRICTION inline
+#endif
+
+namespace hat {
+namespace core {
+
+LINKAGE_RESTRICTION ConfigPartsDependencies calculateConfigPartsDependencies(ConfigBundleSources const & allSources, size_t inputSequencesConfigsCount, size_t variablesManagersConfigsCount, size_t imagesConfigsCount)
+{
+	auto const commandsSourcesCount = 1 + inputSequencesConfigsCount;
+	auto const variablesSourcesCount = commandsSourcesCount + variablesManagersConfigsCount;
+	auto const layoutSourceIndex = variablesSourcesCount + imagesConfigsCount;
+	if (allSources.size() != layoutSourceIndex + 1) {
+		std::stringstream errorDescription;
+		errorDescription << "Unexpected count of the config sources: " << allSources.size() << " (expected " << (layoutSourceIndex + 1) << ")";
+		throw std::runtime_error(errorDescription.str());
+	}
+	auto const getSourcesRange = [&allSources](size_t first, size_t count) {
+		return ConfigBundleSources(allSources.begin() + first, allSources.begin() + first + count);
+	};
+	return ConfigPartsDependencies{
+		ConfigPartDependencies{ getSourcesRange(0, commandsSourcesCount), {} },
+		ConfigPartDependencies{ getSourcesRange(0, variablesSourcesCount), {} },
+		getSourcesRange(variablesSourcesCount, imagesConfigsCount),
+		ConfigPartDependencies{ getSourcesRange(layoutSourceIndex, 1), {} } };
+}
+
+LINKAGE_RESTRICTION ConfigPartsToParse ConfigsReloadCache::getConfigPartsToParse(ConfigPartsDependencies const & dependencies) const
+{
+	auto const shouldParseVariables = !m_commandsWithVariables.isUpToDate(dependencies.m_variables);
+	return ConfigPartsToParse{
+		shouldParseVariables && !m_commands.isUpToDate(dependencies.m_commands), // The commands are needed only as the base for the variables
+		shouldParseVariables,
+		!m_layout.isUpToDate(dependencies.m_layout) };
+}
+
+LINKAGE_RESTRICTION bool ConfigsReloadCache::shouldParseImages(ConfigPartsDependencies const & dependencies, CommandsInfoContainer::EnvsContainer const & environments) const
+{
+	return !m_images.isUpToDate(dependencies.getImagesDependencies(environments));
+}
+
+LINKAGE_RESTRICTION void ConfigsReloadCache::storeConfigBundle(ConfigPartsDependencies const & dependencies, ConfigBundleContents const & configs)
+{
+	m_commandsWithVariables.store(dependencies.m_variables, configs.m_commandsConfig);
+	m_images.store(dependencies.getImagesDependencies(configs.m_commandsConfig.getEnvironments()), configs.m_imagesConfig);
+	m_layout.store(dependencies.m_layout, configs.m_layout);
+}
+
+} //namespace core
+} //namespace hat
@@ -0,0 +1,89 @@
+// This source file is part of the 'hat' open source project.
+// Copyright (c) 2016, Yuriy Vosel.
+// Licensed under Boost Software License.
+// See LICENSE.txt for the licence information.
+
+#ifndef CONFIGS_RELOAD_CACHE_HPP
+#define CONFIGS_RELOAD_CACHE_HPP
+
+#include "config_bundle.hpp"
+#include "commands_data_extraction.hpp"
+#include "user_defined_layout.hpp"
+#include <memory>
+
+namespace hat {
+namespace core {
+
+// Everything, that the parsing result of a config part depends on: the contents of its config files (through the hashes) and, optionally, the list of the environments.
+struct ConfigPartDependencies
+{
+	ConfigBundleSources m_sources;
+	CommandsInfoContainer::EnvsContainer m_environments;
+	bool operator == (ConfigPartDependencies const & other) const { return (m_sources == other.m_sources) && (m_environments == other.m_environments); };
+};
+
+// The parsing result for one part of the configs, together with the dependencies it was built from.
+template <typename ValueType>
+class CachedConfigPart
+{
+	ConfigPartDependencies m_dependencies;
+	std::shared_ptr<ValueType const> m_value;
+public:
+	bool isUpToDate(ConfigPartDependencies const & dependencies) const { return m_value && (m_dependencies == dependencies); };
+	ValueType const & get() const { return *m_value; };
+	void store(ConfigPartDependencies const & dependencies, ValueType const & value)
+	{
+		m_dependencies = dependencies;
+		m_value = std::make_shared<ValueType const>(value);
+	}
+};
+
+// The dependencies of all the config parts for one configs set.
+struct ConfigPartsDependencies
+{
+	ConfigPartDependencies m_commands;
+	ConfigPartDependencies m_variables; // The variables operations depend on the commands, so the commands sources are included here
+	ConfigBundleSources m_imagesSources; // The environments list becomes known only after the commands config is read, see getImagesDependencies()
+	ConfigPartDependencies m_layout;
+	ConfigPartDependencies getImagesDependencies(CommandsInfoContainer::EnvsContainer const & environments) const { return ConfigPartDependencies{ m_imagesSources, environments }; };
+};
+
+// Splits the sources of all the config files into the dependencies of the config parts.
+// The sources are expected in the loading order: the commands config, the input sequences configs, the variables managers configs, the image resources configs, the layout config.
+ConfigPartsDependencies calculateConfigPartsDependencies(ConfigBundleSources const & allSources, size_t inputSequencesConfigsCount, size_t variablesManagersConfigsCount, size_t imagesConfigsCount);
+
+// The config parts, which should be parsed from the config files. The images are not listed here, because their dependencies include the environments from the commands config (see ConfigsReloadCache::shouldParseImages()).
+struct ConfigPartsToParse
+{
+	bool m_commands; // The commands config and the input sequences configs
+	bool m_variables;
+	bool m_layout;
+};
+
+// Keeps the results of the previous configs loading, so that the next reload re-parses only the config files, which were changed, and the parts, which depend on them.
+// The configs are split into the parts according to the dependencies between them:
+//  - commands: the commands config and the input sequences configs (they can reference the commands from the previous files);
+//  - variables: the variables managers configs applied on top of the commands (the operations are bound to the command indices, so any change of the commands invalidates them);
+//  - images: the image resources configs (the mappings are done per environment, so they depend on the environments list from the commands config header);
+//  - layout: the layout config (it is parsed independently - the command ids are resolved only when the layout is presented).
+// Note: the object is not thread-safe. The user code should not load several configs sets with the same cache at the same time.
+struct ConfigsReloadCache
+{
+	CachedConfigPart<CommandsInfoContainer> m_commands; // The state before the variables managers configs are applied
+	CachedConfigPart<CommandsInfoContainer> m_commandsWithVariables;
+	CachedConfigPart<ImageResourcesInfosContainer> m_images;
+	CachedConfigPart<LayoutUserInformation> m_layout;
+
+	ConfigPartsToParse getConfigPartsToParse(ConfigPartsDependencies const & dependencies) const;
+	bool shouldParseImages(ConfigPartsDependencies const & dependencies, CommandsInfoContainer::EnvsContainer const & environments) const;
+	void storeConfigBundle(ConfigPartsDependencies const & dependencies, ConfigBundleContents const & configs); // The bundle does not keep the commands without the variables, so the next change of the variables managers configs will re-parse the commands too
+};
+
+} //namespace core
+} //namespace hat
+
+#ifdef HAT_CORE_HEADERONLY_MODE
+#include "configs_reload_cache.cpp"
+#endif //HAT_CORE_HEADERONLY_MODE
+
+#endif //CONFIGS_RELOAD_CACHE_HPP
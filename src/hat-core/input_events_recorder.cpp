@@ -0,0 +1,130 @@
+// This source file is part of the 'hat' open source project.
+// Copyright (c) 2016, Yuriy Vosel.
+// Licensed under Boost Software License.
+// See LICENSE.txt for the licence information.
+
+#ifndef HAT_CORE_HEADERONLY_MODE
+#include "input_events_recorder.hpp"
+#endif
+#include <algorithm>
+#include <stdexcept>
+
+#ifndef HAT_CORE_HEADERONLY_MODE
+#define LINKAGE_RESTRICTION
+#else
+#define LINKAGE_RESTRICTION inline
+#endif
+
+namespace hat {
+namespace core {
+
+LINKAGE_RESTRICTION RecordedCommandsStatisticsAccumulator::RecordedCommandsStatisticsAccumulator(size_t pendingRequestsSlotsCount)
+{
+	if (pendingRequestsSlotsCount == 0) {
+		throw std::runtime_error("The count of the pending requests slots of the recorded commands statistics should not be 0");
+	}
+	m_pendingRequests.resize(pendingRequestsSlotsCount, PendingRequest{ false, 0, std::chrono::steady_clock::time_point{} });
+}
+
+LINKAGE_RESTRICTION void RecordedCommandsStatisticsAccumulator::add(RecordedInputEvent const & event)
+{
+	typedef RecordedInputEvent::Type Type;
+	if (event.m_type == Type::COMMAND_REQUESTED) {
+		m_pendingRequests[static_cast<uint64_t>(event.m_value) % m_pendingRequests.size()] = PendingRequest{ true, event.m_value, event.m_time };
+	} else if (event.m_type == Type::COMMAND_STARTED) {
+		auto & request = m_pendingRequests[static_cast<uint64_t>(event.m_value) % m_pendingRequests.size()];
+		m_isCommandStarted = true;
+		m_isRequestKnown = request.m_isSet && (request.m_id == event.m_value); // the slot could be reused by the newer request
+		if (m_isRequestKnown) {
+			m_requestTime = request.m_time;
+			request.m_isSet = false;
+		}
+		m_startTime = event.m_time;
+		m_hasInputEvents = false;
+		m_inputEventsCount = 0;
+	} else if (event.m_type == Type::COMMAND_FINISHED) {
+		if (!m_isCommandStarted || !m_isRequestKnown) {
+			m_isCommandStarted = false;
+			return;
+		}
+		m_isCommandStarted = false;
+		++m_statistics.m_commandsCount;
+		m_statistics.m_inputEventsCount += m_inputEventsCount;
+		m_statistics.m_totalExecutionTime += std::chrono::duration_cast<std::chrono::nanoseconds>(event.m_time - m_startTime);
+		if (m_hasInputEvents) {
+			m_statistics.m_minLatency = (m_statistics.m_latenciesCount == 0) ? m_latency : (std::min)(m_statistics.m_minLatency, m_latency);
+			m_statistics.m_maxLatency = (std::max)(m_statistics.m_maxLatency, m_latency);
+			m_statistics.m_totalLatency += m_latency;
+			++m_statistics.m_latenciesCount;
+		}
+	} else if (m_isCommandStarted && (event.m_type != Type::SLEEP)) {
+		if (!m_hasInputEvents) {
+			m_hasInputEvents = true;
+			m_latency = std::chrono::duration_cast<std::chrono::nanoseconds>(event.m_time - m_requestTime);
+		}
+		++m_inputEventsCount;
+	}
+}
+
+// Note: the statistics keep as many pending requests as the buffer keeps events (the capacity is checked in the body, so the error is reported for the capacity).
+LINKAGE_RESTRICTION InputEventsRecorder::InputEventsRecorder(size_t capacity)
+	: m_statistics((std::max)(capacity, size_t{ 1 }))
+{
+	if (capacity == 0) {
+		throw std::runtime_error("The capacity of the input events recorder should not be 0");
+	}
+	m_events.resize(capacity);
+}
+
+LINKAGE_RESTRICTION void InputEventsRecorder::record(RecordedInputEvent::Type type, int64_t value)
+{
+	record(RecordedInputEvent{ type, value, std::chrono::steady_clock::now() });
+}
+
+LINKAGE_RESTRICTION void InputEventsRecorder::record(RecordedInputEvent const & event)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_events[m_nextIndex] = event;
+	m_nextIndex = (m_nextIndex + 1) % m_events.size();
+	++m_recordedCount;
+	m_statistics.add(event);
+}
+
+LINKAGE_RESTRICTION std::vector<RecordedInputEvent> InputEventsRecorder::getEvents() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto result = std::vector<RecordedInputEvent>{};
+	if (m_recordedCount < m_events.size()) {
+		result.assign(m_events.begin(), m_events.begin() + m_nextIndex);
+	} else {
+		result.reserve(m_events.size());
+		result.insert(result.end(), m_events.begin() + m_nextIndex, m_events.end());
+		result.insert(result.end(), m_events.begin(), m_events.begin() + m_nextIndex);
+	}
+	return result;
+}
+
+LINKAGE_RESTRICTION uint64_t InputEventsRecorder::getRecordedCount() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_recordedCount;
+}
+
+LINKAGE_RESTRICTION RecordedCommandsStatistics InputEventsRecorder::getStatistics() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_statistics.getStatistics();
+}
+
+LINKAGE_RESTRICTION RecordedCommandsStatistics calculateRecordedCommandsStatistics(std::vector<RecordedInputEvent> const & events)
+{
+	// Note: there are not more pending requests than the events, so the requests with the sequential ids never share the slots here.
+	auto accumulator = RecordedCommandsStatisticsAccumulator{ (std::max)(events.size(), size_t{ 1 }) };
+	for (auto const & event : events) {
+		accumulator.add(event);
+	}
+	return accumulator.getStatistics();
+}
+
+} //namespace core
+} //namespace hat
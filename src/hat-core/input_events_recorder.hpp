@@ -0,0 +1,112 @@
+// This source file is part of the 'hat' open source project.
+// Copyright (c) 2016, Yuriy Vosel.
+// Licensed under Boost Software License.
+// See LICENSE.txt for the licence information.
+
+#ifndef INPUT_EVENTS_RECORDER_HPP
+#define INPUT_EVENTS_RECORDER_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace hat {
+namespace core {
+
+// The simulated input event, which is recorded instead of being sent to the system (see InputEventsRecorder).
+struct RecordedInputEvent
+{
+	enum class Type : uint8_t
+	{
+		// The markers of the commands processing (they are not the input events). Their value is the id of the command request.
+		COMMAND_REQUESTED, COMMAND_STARTED, COMMAND_FINISHED,
+		// The input events:
+		KEY_PRESS, KEY_RELEASE, // the value is the key
+		TEXT_CHARACTER, // the value is the code point
+		MOUSE_MOVE, // the value is the x coordinate in the high 32 bits and the y coordinate in the low ones
+		MOUSE_CLICK, // the value is the button
+		MOUSE_SCROLL_V, MOUSE_SCROLL_H, // the value is the scroll amount
+		SLEEP // the value is the duration in microseconds
+	};
+	Type m_type;
+	int64_t m_value;
+	std::chrono::steady_clock::time_point m_time;
+
+	bool isCommandMarker() const { return (m_type == Type::COMMAND_REQUESTED) || (m_type == Type::COMMAND_STARTED) || (m_type == Type::COMMAND_FINISHED); };
+};
+
+// The timings of the commands, which were recorded completely (from the request to the end of the execution).
+struct RecordedCommandsStatistics
+{
+	size_t m_commandsCount{ 0 };
+	size_t m_inputEventsCount{ 0 }; // the input events of these commands (the sleeps are not counted)
+	// The latency is the time from the command request to its first input event (the commands without the input events are not counted):
+	size_t m_latenciesCount{ 0 };
+	std::chrono::nanoseconds m_minLatency{ 0 };
+	std::chrono::nanoseconds m_maxLatency{ 0 };
+	std::chrono::nanoseconds m_totalLatency{ 0 };
+	std::chrono::nanoseconds m_totalExecutionTime{ 0 }; // from the start to the end of the execution (the time, which the commands spent in the queue, is not included)
+};
+
+// Updates the statistics with the recorded events one by one, so the statistics are always available without going through all the recorded events.
+// The events of each command should go between its COMMAND_STARTED and COMMAND_FINISHED markers (the commands are executed one after another).
+// The commands, which were requested but not executed, are ignored.
+// Note: the requests, which are waiting for the execution, are kept in the slots, which are allocated once. The slot of the request is reused by the newer requests,
+// so the command is not counted, if too many commands were requested before its execution was started.
+class RecordedCommandsStatisticsAccumulator
+{
+	struct PendingRequest
+	{
+		bool m_isSet;
+		int64_t m_id;
+		std::chrono::steady_clock::time_point m_time;
+	};
+	std::vector<PendingRequest> m_pendingRequests; // the slot of the request is chosen by its id
+	RecordedCommandsStatistics m_statistics;
+
+	// The state of the command, which is being executed:
+	bool m_isCommandStarted{ false };
+	bool m_isRequestKnown{ false };
+	bool m_hasInputEvents{ false };
+	size_t m_inputEventsCount{ 0 };
+	std::chrono::steady_clock::time_point m_requestTime;
+	std::chrono::steady_clock::time_point m_startTime;
+	std::chrono::nanoseconds m_latency{ 0 };
+public:
+	explicit RecordedCommandsStatisticsAccumulator(size_t pendingRequestsSlotsCount); // throws, if the slots count is 0
+	void add(RecordedInputEvent const & event);
+	RecordedCommandsStatistics const & getStatistics() const { return m_statistics; };
+};
+
+// Records the events into the ring buffer, which is allocated once (so the recording does not allocate the memory). When the buffer is full, the oldest events are overwritten.
+// The statistics of all the recorded commands are updated during the recording (see RecordedCommandsStatisticsAccumulator), so they include the commands, which events were already overwritten.
+// Note: the object is thread-safe (the commands are requested on the thread, which serves the connections, while the input is simulated on the commands execution thread).
+class InputEventsRecorder
+{
+	mutable std::mutex m_mutex;
+	std::vector<RecordedInputEvent> m_events;
+	size_t m_nextIndex{ 0 };
+	uint64_t m_recordedCount{ 0 };
+	RecordedCommandsStatisticsAccumulator m_statistics;
+public:
+	explicit InputEventsRecorder(size_t capacity); // throws, if the capacity is 0
+	void record(RecordedInputEvent::Type type, int64_t value); // the event is recorded with the current time
+	void record(RecordedInputEvent const & event);
+	std::vector<RecordedInputEvent> getEvents() const; // the events, which are still in the buffer, from the oldest to the newest
+	uint64_t getRecordedCount() const; // all the recorded events (including the overwritten ones)
+	RecordedCommandsStatistics getStatistics() const;
+	size_t getCapacity() const { return m_events.size(); };
+};
+
+// Calculates the statistics of the given events at once (see RecordedCommandsStatisticsAccumulator).
+RecordedCommandsStatistics calculateRecordedCommandsStatistics(std::vector<RecordedInputEvent> const & events);
+
+} //namespace core
+} //namespace hat
+
+#ifdef HAT_CORE_HEADERONLY_MODE
+#include "input_events_recorder.cpp"
+#endif //HAT_CORE_HEADERONLY_MODE
+
+#endif //INPUT_EVENTS_RECORDER_HPP
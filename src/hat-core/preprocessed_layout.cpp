@@ -32,6 +32,7 @@ LINKAGE_RESTRICTION	InternalLayoutElementRepresentation & InternalLayoutElementR
 LINKAGE_RESTRICTION InternalLayoutElementRepresentation & InternalLayoutElementRepresentation::resetOptionsPage(std::shared_ptr<InternalLayoutPageRepresentation> optionsPage)
 {
 	m_optionsPage = optionsPage;
+	m_hasActiveOptionsPage = optionsPage && optionsPage->hasActiveUserDefinedButtons();
 	return *this;
 }
 
@@ -67,6 +68,7 @@ LINKAGE_RESTRICTION InternalLayoutElementRepresentation & InternalLayoutElementR
 	m_isButton = true;
 	m_note = note;
 	m_optionsPage = options;
+	m_hasActiveOptionsPage = options && options->hasActiveUserDefinedButtons();
 	return *this;
 }
 
@@ -167,7 +169,7 @@ LINKAGE_RESTRICTION bool InternalLayoutPageRepresentation::operator == (Internal
 }
 
 LINKAGE_RESTRICTION bool InternalLayoutElementRepresentation::isActive() const {
-	return m_isButton && ((m_referencedCommandID.nonEmpty()) || (m_optionsPage && m_optionsPage->hasActiveUserDefinedButtons()) || shouldSwitchToAnotherEnvironment);
+	return m_isButton && ((m_referencedCommandID.nonEmpty()) || m_hasActiveOptionsPage || shouldSwitchToAnotherEnvironment);
 }
 
 LINKAGE_RESTRICTION bool InternalLayoutPageRepresentation::hasActiveUserDefinedButtons() const
@@ -220,6 +222,70 @@ LINKAGE_RESTRICTION void InternalLayoutRepresentation::push_page(InternalLayoutP
 {
 	m_topPagesList.push_back(page);
 }
+namespace {
+	// Returns false, if the structure of the pages is different. The element indices are counted in the elementsCount.
+	bool collectPageNotesChanges(InternalLayoutPageRepresentation const & oldPage, InternalLayoutPageRepresentation const & newPage, size_t & elementsCount, LayoutNotesChanges & result)
+	{
+		if (oldPage.getNote() != newPage.getNote()) {
+			return false;
+		}
+		auto const & oldRows = oldPage.getLayout();
+		auto const & newRows = newPage.getLayout();
+		if (oldRows.size() != newRows.size()) {
+			return false;
+		}
+		for (size_t rowIndex = 0; rowIndex < oldRows.size(); ++rowIndex) {
+			if (oldRows[rowIndex].size() != newRows[rowIndex].size()) {
+				return false;
+			}
+			for (size_t elementIndex = 0; elementIndex < oldRows[rowIndex].size(); ++elementIndex) {
+				auto const & oldElement = oldRows[rowIndex][elementIndex];
+				auto const & newElement = newRows[rowIndex][elementIndex];
+				auto const oldOptionsPage = oldElement.getOptionsPagePtr();
+				auto const newOptionsPage = newElement.getOptionsPagePtr();
+				auto const isStructureTheSame = (oldElement.is_button() == newElement.is_button())
+					&& (oldElement.isActive() == newElement.isActive())
+					&& (oldElement.getReferencedCommand() == newElement.getReferencedCommand())
+					&& (oldElement.switchingToAnotherEnvironment_info() == newElement.switchingToAnotherEnvironment_info())
+					&& (oldElement.getImageID() == newElement.getImageID())
+					&& (oldElement.referencesVariable() == newElement.referencesVariable())
+					&& (oldElement.getReferencedVariable() == newElement.getReferencedVariable())
+					&& ((oldOptionsPage == nullptr) == (newOptionsPage == nullptr));
+				if (!isStructureTheSame) {
+					return false;
+				}
+				auto const currentElementIndex = elementsCount++;
+				if (oldElement.getNote() != newElement.getNote()) {
+					auto const canUpdateNote = (oldOptionsPage == nullptr) && (oldElement.isActive() || !oldElement.is_button());
+					if (!canUpdateNote) {
+						return false;
+					}
+					result.m_changedNotes.emplace_back(currentElementIndex, newElement.getNote());
+				}
+				if ((oldOptionsPage != nullptr) && oldElement.isActive() && !collectPageNotesChanges(*oldOptionsPage, *newOptionsPage, elementsCount, result)) {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+}
+
+LINKAGE_RESTRICTION LayoutNotesChanges calculateLayoutNotesChanges(InternalLayoutRepresentation const & oldLayout, InternalLayoutRepresentation const & newLayout)
+{
+	auto result = LayoutNotesChanges{};
+	auto const & oldPages = oldLayout.getPages();
+	auto const & newPages = newLayout.getPages();
+	result.m_isStructureTheSame = (oldPages.size() == newPages.size());
+	auto elementsCount = size_t{ 0 };
+	for (size_t pageIndex = 0; result.m_isStructureTheSame && (pageIndex < oldPages.size()); ++pageIndex) {
+		result.m_isStructureTheSame = collectPageNotesChanges(oldPages[pageIndex], newPages[pageIndex], elementsCount, result);
+	}
+	if (!result.m_isStructureTheSame) {
+		result.m_changedNotes.clear();
+	}
+	return result;
+}
 } //namespace core
 } //namespace hat
 #undef LINKAGE_RESTRICTION
\ No newline at end of file
@@ -25,7 +25,7 @@ struct InternalLayoutElementRepresentation
 {
 	friend std::ostream & operator << (std::ostream & target, InternalLayoutElementRepresentation const & toDump);
 private:
-	size_t switchToAnotherEnvironment;
+	size_t switchToAnotherEnvironment{ 0 };
 	bool shouldSwitchToAnotherEnvironment{ false }; // this is the last possible option - if the button does not reference any command, or shows the options selection page, we will use this.
 	std::string m_note;
 	ImageID m_imageID;
@@ -38,6 +38,9 @@ private:
 
 	// This page (if provided) is shown when the given button is pressed. When a button is pressed on the options page, it is automatically switched back to the original page.
 	std::shared_ptr<InternalLayoutPageRepresentation> m_optionsPage; // TODO: make this unique_ptr (will have to add move constructors, so it can compile with unique ptr)
+	// Calculated once, when the options page is attached, so isActive() does not walk the nested options pages again for each level of nesting.
+	// Note: the options pages should not be changed after they are attached to the elements.
+	bool m_hasActiveOptionsPage{ false };
 public:
 	bool isActive() const;
 
@@ -90,6 +93,7 @@ public:
 //This class stores all the data needed for generation of the layout json. It is totally independent from everything else (the user does not need anything else to build the json from this)
 //On the other hand, it does not have any information, which is specific to json (e.g. it does not contain string IDs for elements and pages, which will end up in the result json)
 //Also it does not contain any excessive data - all the information, which should not be in the json, is not here.
+//Note: the notes of the pages and the elements are stored in the json-ready (escaped) form.
 //For example, if the element is selected from a set of different options, the unselected stuff is not in this object.
 class InternalLayoutRepresentation
 {
@@ -105,6 +109,20 @@ public:
 	void push_page(InternalLayoutPageRepresentation const & page);
 };
 
+// The result of the comparison of two layouts (see calculateLayoutNotesChanges()).
+struct LayoutNotesChanges
+{
+	bool m_isStructureTheSame{ true };
+	std::vector<std::pair<size_t, std::string>> m_changedNotes; // indices of the elements (in the layout traversal order) with their new notes
+};
+
+// Compares the layouts and finds out, if the new one differs from the old one only by the notes of the elements, which could be updated on the client separately
+// (the active buttons without the options pages and the labels. The notes of the other elements are duplicated in the layout decorations, or the elements don't have IDs).
+// The elements are numbered in the depth-first traversal order: page by page, row by row, and the elements of the options page go right after the element, which opens it.
+// Note: the options pages, which are shared between several elements, are traversed for each of them, and the options pages of the inactive buttons are not traversed at all
+// (the same way as they are generated for the client).
+LayoutNotesChanges calculateLayoutNotesChanges(InternalLayoutRepresentation const & oldLayout, InternalLayoutRepresentation const & newLayout);
+
 } //namespace core
 } //namespace hat
 
@@ -0,0 +1,141 @@
+// This source file is part of the 'hat' open source project.
+// Copyright (c) 2016, Yuriy Vosel.
+// Licensed under Boost Software License.
+// See LICENSE.txt for the licence information.
+
+#ifndef STRING_REF_HPP
+#define STRING_REF_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string>
+
+namespace hat {
+namespace core {
+
+// This is a non-owning reference to a range of characters (pointer + length).
+// It is used by the config parsing code, so that the cells of the config file lines could be passed around without copying them into std::string objects.
+// The project is compiled as c++14, so std::string_view is not available. The interface of this class mimics the subset of std::string_view, which is used in the project,
+// so it could be replaced with the standard class later without touching the user code.
+// Note: the object does not own the data. The user code should make sure that the referenced buffer outlives it.
+class StringRef
+{
+	char const * m_data{ nullptr };
+	size_t m_size{ 0 };
+public:
+	static size_t const npos = std::string::npos;
+
+	StringRef() = default;
+	StringRef(char const * data, size_t size) : m_data(data), m_size(size) {};
+	StringRef(char const * nullTerminatedString) : m_data(nullTerminatedString), m_size(std::strlen(nullTerminatedString)) {};
+	StringRef(std::string const & source) : m_data(source.data()), m_size(source.size()) {};
+
+	explicit operator std::string() const { return std::string(m_data, m_size); };
+
+	char const * data() const { return m_data; };
+	size_t size() const { return m_size; };
+	bool empty() const { return m_size == 0; };
+	char const * begin() const { return m_data; };
+	char const * end() const { return m_data + m_size; };
+	char operator [] (size_t index) const { return m_data[index]; };
+	char back() const { return m_data[m_size - 1]; };
+
+	StringRef substr(size_t pos, size_t count = npos) const
+	{
+		pos = std::min(pos, m_size);
+		return StringRef(m_data + pos, std::min(count, m_size - pos));
+	}
+
+	size_t find(char toFind, size_t pos = 0) const
+	{
+		for (size_t i = pos; i < m_size; ++i) {
+			if (m_data[i] == toFind) {
+				return i;
+			}
+		}
+		return npos;
+	}
+
+	size_t find(StringRef const & toFind, size_t pos = 0) const
+	{
+		if (toFind.m_size > m_size) {
+			return npos;
+		}
+		for (size_t i = pos; i + toFind.m_size <= m_size; ++i) {
+			if (std::equal(toFind.begin(), toFind.end(), m_data + i)) {
+				return i;
+			}
+		}
+		return npos;
+	}
+
+	size_t find_first_not_of(StringRef const & characters, size_t pos = 0) const
+	{
+		for (size_t i = pos; i < m_size; ++i) {
+			if (characters.find(m_data[i]) == npos) {
+				return i;
+			}
+		}
+		return npos;
+	}
+
+	size_t find_last_not_of(StringRef const & characters) const
+	{
+		for (size_t i = m_size; i > 0; --i) {
+			if (characters.find(m_data[i - 1]) == npos) {
+				return i - 1;
+			}
+		}
+		return npos;
+	}
+
+	int compare(StringRef const & other) const
+	{
+		auto const commonLength = std::min(m_size, other.m_size);
+		auto const result = (commonLength == 0) ? 0 : std::memcmp(m_data, other.m_data, commonLength);
+		if (result != 0) {
+			return result;
+		}
+		return (m_size < other.m_size) ? -1 : ((m_size > other.m_size) ? 1 : 0);
+	}
+};
+
+inline bool operator == (StringRef const & left, StringRef const & right)
+{
+	return (left.size() == right.size()) && (left.compare(right) == 0);
+}
+inline bool operator != (StringRef const & left, StringRef const & right) { return !(left == right); }
+inline bool operator < (StringRef const & left, StringRef const & right) { return left.compare(right) < 0; }
+
+// These overloads are needed, so that the comparisons with std::string don't become ambiguous (and so that the std::less<> transparent comparator could find them).
+inline bool operator == (StringRef const & left, std::string const & right) { return left == StringRef(right); }
+inline bool operator == (std::string const & left, StringRef const & right) { return StringRef(left) == right; }
+inline bool operator != (StringRef const & left, std::string const & right) { return !(left == right); }
+inline bool operator != (std::string const & left, StringRef const & right) { return !(left == right); }
+inline bool operator < (StringRef const & left, std::string const & right) { return left < StringRef(right); }
+inline bool operator < (std::string const & left, StringRef const & right) { return StringRef(left) < right; }
+inline bool operator == (StringRef const & left, char const * right) { return left == StringRef(right); }
+inline bool operator != (StringRef const & left, char const * right) { return !(left == right); }
+
+inline std::ostream & operator << (std::ostream & target, StringRef const & toDump)
+{
+	return target.write(toDump.data(), toDump.size());
+}
+
+// 64-bit FNV-1a hash of the characters. It is not a cryptographic hash - it is used for the hash tables and for detecting the changes in the data.
+inline uint64_t calculateStringHash(StringRef const & toHash)
+{
+	uint64_t result = 14695981039346656037ULL;
+	for (auto symbol : toHash) {
+		result ^= static_cast<unsigned char>(symbol);
+		result *= 1099511628211ULL;
+	}
+	return result;
+}
+
+} //namespace core
+} //namespace hat
+
+#endif //STRING_REF_HPP
@@ -9,6 +9,7 @@
 
 #include "commands_data_extraction.hpp"
 #include "utils.hpp"
+#include "config_file_reader.hpp"
 #include <algorithm>
 #include <sstream>
 
@@ -64,7 +65,7 @@ LINKAGE_RESTRICTION bool LayoutElementTemplate::operator == (LayoutElementTempla
 	return m_optionsForElements == other.m_optionsForElements;
 }
 
-LINKAGE_RESTRICTION void LayoutPageTemplate::decode_and_store_row_description_string(std::string const & row)
+LINKAGE_RESTRICTION void LayoutPageTemplate::decode_and_store_row_description_string(StringRef const & row)
 {
 	if (row.size() == 0) {
 		throw std::runtime_error("The data row should contain at least one element id. This row contains none.");
@@ -108,26 +109,26 @@ LINKAGE_RESTRICTION auto LayoutPageTemplate::create(std::string const & page_hea
 	return LayoutPageTemplate(page_header_caption);
 }
 
-LINKAGE_RESTRICTION bool LayoutPageTemplate::isStartOfNewPage(std::string const & line)
+LINKAGE_RESTRICTION bool LayoutPageTemplate::isStartOfNewPage(StringRef const & line)
 {
 	return (line.find(REQUIRED_PREFIX_()) == 0);
 }
 
-LINKAGE_RESTRICTION std::string LayoutPageTemplate::getNormalPageCaptionFromHeader(std::string const & line)
+LINKAGE_RESTRICTION std::string LayoutPageTemplate::getNormalPageCaptionFromHeader(StringRef const & line)
 {
 	if (!isStartOfNewPage(line)) {
 		throw std::runtime_error("Trying to process the line as a layout page declaration. It is ill-formed. It should start with 'page:<name>' line.");
 	}
-	return line.substr(REQUIRED_PREFIX_().size(), line.size());
+	return std::string(line.substr(REQUIRED_PREFIX_().size()));
 }
 
-LINKAGE_RESTRICTION LayoutPageTemplate::SelectorPageOptions LayoutPageTemplate::getSelectorPageCaptionAndID(std::string const & line)
+LINKAGE_RESTRICTION LayoutPageTemplate::SelectorPageOptions LayoutPageTemplate::getSelectorPageCaptionAndID(StringRef const & line)
 {
 	if (!isStartOfSelectorPage(line)) {
 		throw std::runtime_error("Trying to process the line as the start of the selector page, which is not correctly formed.");
 	}
 
-	auto dataToParse = line.substr(REQUIRED_OPTIONS_SELECTOR_PREFIX_().size(), line.size());
+	auto dataToParse = line.substr(REQUIRED_OPTIONS_SELECTOR_PREFIX_().size());
 	auto result = splitTheRow(dataToParse, ';');
 	if (result.size() != 2) {
 		throw std::runtime_error("Selector page start line is ill-formed. It should be ID and caption split by ';' sign."); // TODO: rework this - make sure that the captions could have ';' in them.
@@ -136,7 +137,7 @@ LINKAGE_RESTRICTION LayoutPageTemplate::SelectorPageOptions LayoutPageTemplate::
 	return SelectorPageOptions{ result[1], CommandID{result[0]} };
 }
 
-LINKAGE_RESTRICTION bool LayoutPageTemplate::isStartOfSelectorPage(std::string const & line)
+LINKAGE_RESTRICTION bool LayoutPageTemplate::isStartOfSelectorPage(StringRef const & line)
 {
 	return (line.find(REQUIRED_OPTIONS_SELECTOR_PREFIX_()) == 0);
 }
@@ -166,6 +167,11 @@ LINKAGE_RESTRICTION std::vector<LayoutPageTemplate> const & LayoutUserInformatio
 	return m_layoutPages;
 }
 
+LINKAGE_RESTRICTION LayoutUserInformation::OptionsSelctorsContainer const & LayoutUserInformation::getOptionsSelectorPages() const
+{
+	return m_optionsSelectionPages;
+}
+
 LINKAGE_RESTRICTION void LayoutUserInformation::push(LayoutPageTemplate const & toPush)
 {
 	m_layoutPages.push_back(toPush);
@@ -201,19 +207,34 @@ LINKAGE_RESTRICTION void LayoutUserInformation::insert_selector_page(CommandID c
 	m_optionsSelectionPages[id] = toInsert;
 }
 
-LINKAGE_RESTRICTION auto LayoutUserInformation::parseConfigFile(std::istream & dataToParse)
+template <typename LinesReader>
+LayoutUserInformation LayoutUserInformation::parseConfigLines(LinesReader & dataToParse)
 {
 	LayoutUserInformation result;
-	std::string tmpString;
+	StringRef tmpString;
 	LayoutPageTemplate * currentlyConstructedPage = nullptr;
 	bool firstLine = true;
-	while (getLineFromFile(dataToParse, tmpString)) {
+	size_t lineNumber = 0;
+	// The captions are displayed on the client, so their texts are checked here (the errors are reported with the line number).
+	auto const ensureCaptionIsValid = [&lineNumber](std::string const & caption) {
+		try {
+			ensureValidUTF8(caption);
+		} catch (std::runtime_error & e) {
+			std::stringstream errorMessage;
+			errorMessage << "Error parsing the layout configuration file at line " << lineNumber << ":\n\t" << e.what();
+			throw std::runtime_error(errorMessage.str());
+		}
+	};
+	while (dataToParse.getLine(tmpString)) {
+		++lineNumber;
 		if (firstLine) {
 			tmpString = clearUTF8_byteOrderMark(tmpString);
 			firstLine = false;
 		}
 		if (LayoutPageTemplate::isStartOfNewPage(tmpString)) {
-			result.m_layoutPages.push_back(LayoutPageTemplate::create(LayoutPageTemplate::getNormalPageCaptionFromHeader(tmpString)));
+			auto const caption = LayoutPageTemplate::getNormalPageCaptionFromHeader(tmpString);
+			ensureCaptionIsValid(caption);
+			result.m_layoutPages.push_back(LayoutPageTemplate::create(caption));
 			currentlyConstructedPage = &(result.m_layoutPages.back());
 		} else if (LayoutPageTemplate::isStartOfSelectorPage(tmpString)) {
 			auto selectorPageOptions = LayoutPageTemplate::getSelectorPageCaptionAndID(tmpString);
@@ -222,7 +243,7 @@ LINKAGE_RESTRICTION auto LayoutUserInformation::parseConfigFile(std::istream & d
 				errorMessage << "Duplicate id for the selector page: " << selectorPageOptions.m_id.getValue(); //TOOD: add test for this error
 				throw std::runtime_error(errorMessage.str().c_str());
 			}
-			//TODO: call the escapeRawUTF8_forJson(extractedString) here - make sure that an exception is not thrown here (actual convertion is done in the json generation)
+			ensureCaptionIsValid(selectorPageOptions.m_caption);
 			result.m_optionsSelectionPages[selectorPageOptions.m_id] = LayoutPageTemplate::create(selectorPageOptions.m_caption);
 			currentlyConstructedPage = &(result.m_optionsSelectionPages.at(selectorPageOptions.m_id));
 		} else {
@@ -235,6 +256,18 @@ LINKAGE_RESTRICTION auto LayoutUserInformation::parseConfigFile(std::istream & d
 	return result;
 }
 
+LINKAGE_RESTRICTION auto LayoutUserInformation::parseConfigFile(std::istream & dataToParse)
+{
+	StreamLinesReader reader(dataToParse);
+	return parseConfigLines(reader);
+}
+
+LINKAGE_RESTRICTION auto LayoutUserInformation::parseConfigFile(StringRef const & configContents)
+{
+	BufferLinesReader reader(configContents);
+	return parseConfigLines(reader);
+}
+
 LINKAGE_RESTRICTION bool LayoutUserInformation::operator == (LayoutUserInformation const & other) const
 {
 	return ((other.m_layoutPages == m_layoutPages) && (m_optionsSelectionPages == other.m_optionsSelectionPages));
@@ -8,6 +8,7 @@
 
 #include "command_id.hpp"
 #include "variables_manager.hpp"
+#include "string_ref.hpp"
 #include <ostream>
 #include <string>
 #include <map>
@@ -92,7 +93,7 @@ public:
 	LayoutPageTemplate(std::string const & note) :m_name(note) {};
 	LayoutPageTemplate() = default;
 
-	void decode_and_store_row_description_string(std::string const & row);
+	void decode_and_store_row_description_string(StringRef const & row);
 	void push_row(std::vector<LayoutElementTemplate> const & rows);
 	void push_elem_into_last_row(LayoutElementTemplate const & toAdd);
 	Rows const & get_rows() const;
@@ -103,9 +104,9 @@ public:
 
 
 	static auto create(std::string const & name);
-	static bool isStartOfNewPage(std::string const & name);
-	static std::string getNormalPageCaptionFromHeader(std::string const & line);
-	static bool isStartOfSelectorPage(std::string const & line);
+	static bool isStartOfNewPage(StringRef const & name);
+	static std::string getNormalPageCaptionFromHeader(StringRef const & line);
+	static bool isStartOfSelectorPage(StringRef const & line);
 
 	struct SelectorPageOptions
 	{
@@ -113,7 +114,7 @@ public:
 		CommandID const m_id;
 		SelectorPageOptions(std::string const & caption, CommandID const & id) : m_caption(caption), m_id(id) {};
 	};
-	static SelectorPageOptions getSelectorPageCaptionAndID(std::string const & line);
+	static SelectorPageOptions getSelectorPageCaptionAndID(StringRef const & line);
 private:
 	static std::string & REQUIRED_PREFIX_() { static auto result = std::string{ "page:" }; return result; }
 	static std::string & REQUIRED_OPTIONS_SELECTOR_PREFIX_() { static auto result = std::string{ "optionsSelectorPage:" }; return result; }
@@ -129,8 +130,11 @@ struct LayoutUserInformation
 private:
 	std::vector<LayoutPageTemplate> m_layoutPages; // TODO: maybe will switch to std::list, so the references don't get invalidated (more stable code, but currently this feature is not necessary)
 	OptionsSelctorsContainer m_optionsSelectionPages;
+	template <typename LinesReader>
+	static LayoutUserInformation parseConfigLines(LinesReader & dataToParse);
 public:
 	std::vector<LayoutPageTemplate> const & getLayoutPages() const;
+	OptionsSelctorsContainer const & getOptionsSelectorPages() const;
 	void push(LayoutPageTemplate const & toPush);
 	void insert_selector_page(CommandID const & id, LayoutPageTemplate const & toInsert);
 
@@ -142,6 +146,7 @@ public:
 	OptionsSelctorsContainer::const_iterator non_existent_selector() const;
 
 	static auto parseConfigFile(std::istream & dataToParse);
+	static auto parseConfigFile(StringRef const & configContents); // Parses the config contents, which are already in memory (see MappedConfigFile).
 	bool operator == (LayoutUserInformation const & other) const;
 };
 } //namespace core
@@ -8,8 +8,15 @@
 #endif
 #include <sstream>
 #include <fstream>
-#include <iomanip>
 #include <cctype> //toupper
+#include <algorithm>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define HAT_CORE_SSE2_SUPPORT
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h> //_BitScanForward
+#endif
+#endif
 #ifndef HAT_CORE_HEADERONLY_MODE
 #define LINKAGE_RESTRICTION 
 #else
@@ -23,7 +30,7 @@ LINKAGE_RESTRICTION std::istream & getLineFromFile(std::istream & filestream, st
 {
 	std::getline(filestream, target);
 	if ((target.size() > 0) && (target.back() == '\r')) {
-		target = target.substr(0, target.size() - 1);
+		target.pop_back();
 	}
 	return filestream;
 }
@@ -38,61 +45,179 @@ LINKAGE_RESTRICTION std::string clearUTF8_byteOrderMark(std::string const & firs
 	return firstLineOfFile;
 }
 
-LINKAGE_RESTRICTION std::string escapeRawUTF8_forJson(std::string const & stringToProcess)
+LINKAGE_RESTRICTION StringRef clearUTF8_byteOrderMark(StringRef const & firstLineOfFile)
 {
-	using namespace std::string_literals;
-	std::stringstream result;
+	static const char UTF_8_BOM[] = {char(0xEF), char(0xBB), char(0xBF)};
+	static const auto UTF_8_BOM_SIZE = sizeof(UTF_8_BOM);
+	if ((firstLineOfFile.size() >= UTF_8_BOM_SIZE) && std::equal(UTF_8_BOM, UTF_8_BOM + UTF_8_BOM_SIZE, firstLineOfFile.begin())) {
+		return firstLineOfFile.substr(UTF_8_BOM_SIZE);
+	}
+	return firstLineOfFile;
+}
 
-	static char SINGLE_BYTE_CODEPOINT_MASK = char(0b10000000);
-	static char MULTI_BYTE_CODEPOINT_MASK =  char(0b11000000);
+namespace {
+	void throwInvalidUTF8Error(StringRef const & text, size_t position, bool isLeadingByteInvalid)
+	{
+		std::stringstream errorMessage;
+		if (isLeadingByteInvalid) {
+			errorMessage << "Invalid UTF-8 text: unexpected byte 0x" << std::hex << static_cast<unsigned int>(static_cast<unsigned char>(text[position])) << " at position " << std::dec << position << ". The text: '" << text << "'.";
+		} else {
+			errorMessage << "Invalid UTF-8 text: incomplete multi-byte character at position " << position << ". The text: '" << text << "'.";
+		}
+		throw std::runtime_error(errorMessage.str());
+	}
 
+	size_t const INVALID_UTF8_LEADING_BYTE = 0;
+	size_t const INCOMPLETE_UTF8_CHARACTER = static_cast<size_t>(-1);
 
-	//UTF-8 characters do not need escaping for the TAU client. The escaped unicode is more portable (if I will decide to support other encodings, it will make the generated json not rely on the underlying encoding)
-	static const auto DONT_ESCAPE_UTF_8_SYMBOLS = bool{true};
-	
-	for (size_t i = 0; i < stringToProcess.size(); ++i) {
-		char current = stringToProcess[i];
-		// Find out the bytecount of the pending character in UTF-8 encoding:
-		auto isSingleByte = (SINGLE_BYTE_CODEPOINT_MASK & current) == 0;
-		if (isSingleByte || DONT_ESCAPE_UTF_8_SYMBOLS) { //simple character, will put it as-is (escape only the '"' symbol, because it will screw up the json parsing)
-			if ((current =='"') || (current =='\\')) {
-				result << '\\';
-			}
-			result << current;
+	// Returns the size of the UTF-8 character, which starts at the position (or one of the two values above, if the character is malformed).
+	inline size_t getUTF8CharacterSize(char const * data, size_t size, size_t position)
+	{
+		auto const leadingByte = static_cast<unsigned char>(data[position]);
+		size_t extraBytes = 0;
+		if (leadingByte < 0x80) {
+			return 1;
+		} else if ((leadingByte & 0xE0) == 0xC0) {
+			extraBytes = 1;
+		} else if ((leadingByte & 0xF0) == 0xE0) {
+			extraBytes = 2;
+		} else if ((leadingByte & 0xF8) == 0xF0) {
+			extraBytes = 3;
 		} else {
-			//TODO: maybe rewrite this code (use the standard multi-byte character conversions - http://en.cppreference.com/w/cpp/string/multibyte)
-			size_t extraBytes = 0;
-			char firstByteMask = char(0b00111111); //0x3f // this mask will represent the significant bits in the first byte of the multi-byte sequence
-			{
-				char currentTmp = current;
-				while ((currentTmp & MULTI_BYTE_CODEPOINT_MASK) == MULTI_BYTE_CODEPOINT_MASK) {
-					++extraBytes;
-					currentTmp = currentTmp << 1;
-					firstByteMask = firstByteMask >> 1; // Clear the significant bits mask of the first byte one by one
-				}
+			return INVALID_UTF8_LEADING_BYTE;
+		}
+		for (size_t j = 1; j <= extraBytes; ++j) {
+			if (((position + j) >= size) || ((static_cast<unsigned char>(data[position + j]) & 0xC0) != 0x80)) {
+				return INCOMPLETE_UTF8_CHARACTER;
 			}
-			long int resultUnicodeCodepoint = firstByteMask & current;
-			const int ADDITIONAL_BYTES_MASK = 0b00111111;//0x3f // this mask represents the significant bits in the all the additional bytes of the multi-byte sequence
-			for (size_t j = 1; j <= extraBytes; ++j) {
-				// Clear the first two bits of the current character, add the 6 left bits it to the end of the accumulated value:
-				if ((i+j) >= stringToProcess.size()) {
-					throw std::runtime_error("Unicode parsing error: premature end of the string detected."); //TODO: add more details here
-				}
-				resultUnicodeCodepoint = (resultUnicodeCodepoint << 6) | (stringToProcess[i+j] & ADDITIONAL_BYTES_MASK);
+		}
+		return extraBytes + 1;
+	}
+
+	// Returns the size of the UTF-8 character, which starts at the position (throws, if the character is malformed).
+	inline size_t getValidUTF8CharacterSize(char const * data, size_t size, size_t position)
+	{
+		auto const characterSize = getUTF8CharacterSize(data, size, position);
+		if ((characterSize == INVALID_UTF8_LEADING_BYTE) || (characterSize == INCOMPLETE_UTF8_CHARACTER)) {
+			throwInvalidUTF8Error(StringRef(data, size), position, characterSize == INVALID_UTF8_LEADING_BYTE);
+		}
+		return characterSize;
+	}
+
+	// Returns the position of the first byte, which can not be copied to the json string as-is: '"', '\\', the control characters and the non-ASCII bytes
+	// (the last ones are fine for json, but they have to be validated).
+	inline size_t findFirstByteToProcessForJson(char const * data, size_t position, size_t size)
+	{
+#ifdef HAT_CORE_SSE2_SUPPORT
+		// 16 bytes are checked at once. The signed comparison with 0x20 catches both the control characters and the bytes with the high bit set.
+		auto const quotes = _mm_set1_epi8('"');
+		auto const backslashes = _mm_set1_epi8('\\');
+		auto const firstPrintable = _mm_set1_epi8(0x20);
+		for (; position + 16 <= size; position += 16) {
+			auto const chunk = _mm_loadu_si128(reinterpret_cast<__m128i const *>(data + position));
+			auto const toProcess = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quotes), _mm_cmpeq_epi8(chunk, backslashes)), _mm_cmplt_epi8(chunk, firstPrintable));
+			auto const mask = static_cast<unsigned int>(_mm_movemask_epi8(toProcess));
+			if (mask != 0) {
+#ifdef _MSC_VER
+				unsigned long firstSetBit;
+				_BitScanForward(&firstSetBit, mask);
+				return position + firstSetBit;
+#else
+				return position + __builtin_ctz(mask);
+#endif
+			}
+		}
+#endif //HAT_CORE_SSE2_SUPPORT
+		for (; position < size; ++position) {
+			auto const current = static_cast<unsigned char>(data[position]);
+			if ((current == '"') || (current == '\\') || (current < 0x20) || (current >= 0x80)) {
+				return position;
 			}
-			i += extraBytes;
-			if (resultUnicodeCodepoint <= 0xFFFF) { // the codepoint can be presented as '\u****'
-				result << "\\u" << std::setw(4) << std::setfill('0') << std::hex << resultUnicodeCodepoint;
-			} else {
-				throw std::runtime_error("can't escape the unicode codepoint above 0xFFFF. The functionality not implemented.");
+		}
+		return size;
+	}
+}
+
+LINKAGE_RESTRICTION void ensureValidUTF8(StringRef const & text)
+{
+	for (size_t i = 0; i < text.size(); ) {
+		i += getValidUTF8CharacterSize(text.data(), text.size(), i);
+	}
+}
+
+LINKAGE_RESTRICTION std::u32string decodeUTF8(StringRef const & text)
+{
+	static unsigned char const LEADING_BYTE_VALUE_MASKS[] = { 0, 0x7F, 0x1F, 0x0F, 0x07 }; // by the size of the character
+	auto result = std::u32string{};
+	result.reserve(text.size());
+	for (size_t i = 0; i < text.size(); ) {
+		auto const characterSize = getValidUTF8CharacterSize(text.data(), text.size(), i);
+		auto codePoint = static_cast<char32_t>(static_cast<unsigned char>(text[i]) & LEADING_BYTE_VALUE_MASKS[characterSize]);
+		for (size_t j = 1; j < characterSize; ++j) {
+			codePoint = (codePoint << 6) | (static_cast<unsigned char>(text[i + j]) & 0x3F);
+		}
+		result.push_back(codePoint);
+		i += characterSize;
+	}
+	return result;
+}
+
+namespace {
+	// The malformed UTF-8 characters are either reported (see getValidUTF8CharacterSize()) or replaced with the U+FFFD replacement character (one for each byte, which does not start a valid character).
+	inline std::string escapeUTF8_forJson(std::string const & stringToProcess, bool shouldReplaceInvalidCharacters)
+	{
+		//UTF-8 characters do not need escaping for the TAU client, so the multi-byte characters are copied as-is (they are validated on the way).
+		//Only the symbols, which would break the json string, are escaped here.
+		//The runs of the bytes, which do not need any processing, are found by findFirstByteToProcessForJson() and copied at once.
+		static char const HEX_DIGITS[] = "0123456789abcdef";
+		auto const data = stringToProcess.data();
+		auto const size = stringToProcess.size();
+		auto result = std::string{};
+		result.reserve(size + size / 8);
+		size_t position = 0;
+		while (position < size) {
+			auto const runEnd = findFirstByteToProcessForJson(data, position, size);
+			if (runEnd != position) {
+				result.append(data + position, runEnd - position);
+				position = runEnd;
+			}
+			// The bytes, which need processing, often go together (for example, the non-ASCII texts), so they are processed here until the next plain byte:
+			while (position < size) {
+				auto const current = static_cast<unsigned char>(data[position]);
+				if ((current == '"') || (current == '\\')) {
+					result.push_back('\\');
+					result.push_back(static_cast<char>(current));
+					++position;
+				} else if (current < 0x20) { // the control characters are not allowed inside the json strings
+					char const escapedCharacter[] = { '\\', 'u', '0', '0', HEX_DIGITS[current >> 4], HEX_DIGITS[current & 0x0F] };
+					result.append(escapedCharacter, sizeof(escapedCharacter));
+					++position;
+				} else if (current >= 0x80) {
+					auto const characterSize = shouldReplaceInvalidCharacters ? getUTF8CharacterSize(data, size, position) : getValidUTF8CharacterSize(data, size, position);
+					if ((characterSize == INVALID_UTF8_LEADING_BYTE) || (characterSize == INCOMPLETE_UTF8_CHARACTER)) {
+						result.append("\xEF\xBF\xBD");
+						++position;
+						continue;
+					}
+					result.append(data + position, characterSize);
+					position += characterSize;
+				} else {
+					break;
+				}
 			}
-			// There is a way to encode any unicode codepoint, but it does not work in android:
-			//result << "\\u{" << std::hex << resultUnicodeCodepoint << '}';
 		}
-		
+		return result;
 	}
-	auto toReturn = result.str();
-	return toReturn;
+}
+
+LINKAGE_RESTRICTION std::string escapeRawUTF8_forJson(std::string const & stringToProcess)
+{
+	return escapeUTF8_forJson(stringToProcess, false);
+}
+
+LINKAGE_RESTRICTION std::string escapeRawUTF8_forJson_replacingInvalid(std::string const & stringToProcess)
+{
+	return escapeUTF8_forJson(stringToProcess, true);
 }
 
 
@@ -127,4 +252,5 @@ LINKAGE_RESTRICTION std::string loadSvgFromFile(std::string const & file_path)
 } //namespace core
 } //namespace hat
 
-#undef LINKAGE_RESTRICTION
\ No newline at end of file
+#undef LINKAGE_RESTRICTION
+#undef HAT_CORE_SSE2_SUPPORT
\ No newline at end of file
@@ -8,11 +8,22 @@
 
 #include <string>
 #include <istream>
+#include "string_ref.hpp"
 namespace hat {
 namespace core {
 	std::istream & getLineFromFile(std::istream & filestream, std::string & target);
 	std::string clearUTF8_byteOrderMark(std::string const & firstLineOfFile);
+	StringRef clearUTF8_byteOrderMark(StringRef const & firstLineOfFile);
+	// Throws std::runtime_error, if the text is not a well-formed UTF-8 string.
+	void ensureValidUTF8(StringRef const & text);
+	// Returns the code points of the UTF-8 text (throws std::runtime_error, if it is not well-formed, just like ensureValidUTF8()).
+	std::u32string decodeUTF8(StringRef const & text);
+	// Returns the text in the form, which can be put inside the json string (the text is validated with ensureValidUTF8()).
+	// Note: the configs texts are escaped once during the configs loading (see ResolvedLayout), so this should not be called during the layouts generation.
 	std::string escapeRawUTF8_forJson(std::string const & stringToProcess);
+	// The same as escapeRawUTF8_forJson(), but the malformed UTF-8 characters are replaced with U+FFFD instead of throwing.
+	// It is used for the values of the variables, which are changed at runtime (the command should not fail because of the text, which was cut in the middle of a character).
+	std::string escapeRawUTF8_forJson_replacingInvalid(std::string const & stringToProcess);
 	bool isSvgFile(std::string const & file_path);
 	std::string loadSvgFromFile(std::string const & file_path);
 } //namespace core
@@ -143,13 +143,17 @@ namespace {
 
 	LINKAGE_RESTRICTION void ClearTailCharacters::preformOperation(VariablesManager & targetVariablesManager)
 	{
-		auto currentValue = targetVariablesManager.getValue(m_targetVariable);
-		if (currentValue.size() <= m_charactersCountToClear) {
-			targetVariablesManager.updateValue(m_targetVariable, "");
-		} else {
-			size_t const newLengthOfValueString = currentValue.size() - m_charactersCountToClear; // Note: the result of this operation is always > 0 here (see the if statements's condition)
-			targetVariablesManager.updateValue(m_targetVariable, currentValue.substr(0, newLengthOfValueString));
+		// The values are UTF-8 texts, so the whole multi-byte characters are cleared (the continuation bytes of the character are cleared together with its leading byte).
+		// Note: the malformed characters are cleared by the bytes (not more than 3 continuation bytes are taken together with the preceding byte).
+		auto const currentValue = targetVariablesManager.getValue(m_targetVariable);
+		auto newLengthOfValueString = currentValue.size();
+		for (size_t i = 0; (i < m_charactersCountToClear) && (newLengthOfValueString > 0); ++i) {
+			--newLengthOfValueString;
+			for (size_t continuationBytes = 0; (continuationBytes < 3) && (newLengthOfValueString > 0) && ((static_cast<unsigned char>(currentValue[newLengthOfValueString]) & 0xC0) == 0x80); ++continuationBytes) {
+				--newLengthOfValueString;
+			}
 		}
+		targetVariablesManager.updateValue(m_targetVariable, currentValue.substr(0, newLengthOfValueString));
 	}
 
 	LINKAGE_RESTRICTION bool AppendText::operator == (AppendText const & other) const
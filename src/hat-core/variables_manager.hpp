@@ -117,6 +117,7 @@ private:
 public:
 	ClearTailCharacters(VariableID const & targetVariable, size_t amountOfCharactersToClear) :
 		SingleTargetVariableOperation(targetVariable), m_charactersCountToClear(amountOfCharactersToClear) {}
+	size_t getCharactersCountToClear() const { return m_charactersCountToClear; };
 	void preformOperation(VariablesManager & targetVariablesManager) override;
 	bool operator == (VariableOperation const & other) const override { return other.operator==(*this); }
 	bool operator == (ClearTailCharacters const & other) const override;
@@ -130,6 +131,7 @@ private:
 	InternalData m_data;
 public:
 	InternalData & data() { return m_data; };
+	InternalData const & data() const { return m_data; };
 	bool operator == (OperationsList const & other) const;
 };
 
@@ -150,6 +152,10 @@ public:
 	void updateValue(VariableID const & targetVariableID, std::string const & newValue);
 	//TODO: refactoring, optimisation : return std::vector<std::pair<VariableID, std::string>> here. It is easier for the user code - we don't have to query the variables updated values in separate call
 	std::vector<VariableID> executeCommandAndGetChangedVariablesList(size_t triggeredCommandIndex);
+
+	// Read-only access to the whole state of the manager (used for storing it into the precompiled configs bundle)
+	std::map<VariableID, std::string> const & getVariablesWithValues() const { return m_variablesWithValues; };
+	std::map<size_t, OperationsList> const & getOperationsToExecute() const { return m_operationsToExecute; };
 	bool operator == (VariablesManager const & other) const;
 };
 
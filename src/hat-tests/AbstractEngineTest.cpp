@@ -18,7 +18,7 @@ TEST_CASE("ID encode/decode") {
 	for (size_t i = 0; i < 10000; ++i) {
 		myTestData.push_back(std::make_pair(hat::core::encodeNumberInTauIdentifier('a', i), i));
 		size_t j = 10000 - i;
-		myTestData.push_back(std::make_pair(hat::core::encodeNumberInTauIdentifier('a', j), j));
+		myTestData.push_back(std::make_pair(hat::core::encodeNumberInTauIdentifier('a', j, "e" + std::to_string(i) + ".12.3"), j));
 	}
 
 	std::random_shuffle(myTestData.begin(), myTestData.end());
@@ -32,6 +32,39 @@ TEST_CASE("ID encode/decode") {
 	}
 }
 
+TEST_CASE("IDs are defined by the position in the layout") {
+	using hat::core::AbstractEngine;
+	// The same element gets the same ID on each layout generation:
+	REQUIRE(AbstractEngine::generateTauIdentifierForCommand(12, "e0.1.2") == AbstractEngine::generateTauIdentifierForCommand(12, "e0.1.2"));
+	REQUIRE(AbstractEngine::generateTrowawayTauIdentifier("p1") == AbstractEngine::generateTrowawayTauIdentifier("p1"));
+	REQUIRE(AbstractEngine::generateReloadButtonID() == AbstractEngine::generateReloadButtonID());
+
+	// The same command on different positions:
+	REQUIRE(AbstractEngine::generateTauIdentifierForCommand(12, "e0.1.2") != AbstractEngine::generateTauIdentifierForCommand(12, "e0.1.2.0.0"));
+	REQUIRE(hat::core::getEncodedNumberFromTauIdentifier(AbstractEngine::generateTauIdentifierForCommand(12, "e0.1.2.0.0")) == 12);
+	REQUIRE(hat::core::getEncodedNumberFromTauIdentifier(AbstractEngine::generateTauIdentifierForEnvSwitching(3, "e0.1.2")) == 3);
+}
+
+TEST_CASE("The actions of the buttons are decoded from their IDs") {
+	using hat::core::AbstractEngine;
+	using hat::core::ButtonClickAction;
+	auto const commandAction = AbstractEngine::decodeButtonClickAction(AbstractEngine::generateTauIdentifierForCommand(12, "e0.1.2.0.0"));
+	REQUIRE(commandAction.m_type == ButtonClickAction::Type::COMMAND);
+	REQUIRE(commandAction.m_index == 12);
+
+	auto const envSwitchAction = AbstractEngine::decodeButtonClickAction(AbstractEngine::generateTauIdentifierForEnvSwitching(3, "e0.1.2"));
+	REQUIRE(envSwitchAction.m_type == ButtonClickAction::Type::ENV_SWITCH);
+	REQUIRE(envSwitchAction.m_index == 3);
+
+	auto const reloadAction = AbstractEngine::decodeButtonClickAction(AbstractEngine::generateReloadButtonID());
+	REQUIRE(reloadAction.m_type == ButtonClickAction::Type::UTIL);
+	REQUIRE(AbstractEngine::decodeButtonClickAction(AbstractEngine::generateClearPendingCommandButtonID()).m_index != reloadAction.m_index);
+
+	// The navigation buttons don't have any actions on the server side:
+	REQUIRE(AbstractEngine::decodeButtonClickAction(AbstractEngine::generateTrowawayTauIdentifier("jumps1")).m_type == ButtonClickAction::Type::NONE);
+	REQUIRE(AbstractEngine::decodeButtonClickAction("").m_type == ButtonClickAction::Type::NONE);
+}
+
 namespace {
 //NOTE: this is a very non-generic implementation. It could be implemented much better. Should be not very hard to add variadic templates to ensure that any set of parameters can be tested.
 class CallExpectationTester
@@ -170,6 +203,17 @@ SCENARIO("AbstractEngine's basic commands processsing")
 				CHECK(eng.m_callsExpectationsTester.allExpectationsFulfilled());
 			}
 		}
+		WHEN("Command button with the pre-decoded action is pressed") {
+			auto encodedCommandIndex = size_t{ 11 };
+			auto const action = AbstractEngine::decodeButtonClickAction(AbstractEngine::generateTauIdentifierForCommand(encodedCommandIndex, "e0.0.0"));
+			eng.m_callsExpectationsTester.expect(eng.FUNC_ID_canSendTheCommmandForEnvironment);
+			eng.m_callsExpectationsTester.expect(eng.FUNC_ID_executeCommandForCurrentlySelectedEnvironment, encodedCommandIndex);
+			auto callResult = eng.buttonOnLayoutClicked(action);
+			THEN("The result is the same as for the click processed by the ID") {
+				REQUIRE(callResult == FeedbackFromButtonClick::NONE);
+				CHECK(eng.m_callsExpectationsTester.allExpectationsFulfilled());
+			}
+		}
 		WHEN("Environment switch button is pressed") {
 			auto environmentToSwitchTo = size_t{ 23 };
 			auto buttonIdRepresentingAction = AbstractEngine::generateTauIdentifierForEnvSwitching(environmentToSwitchTo);
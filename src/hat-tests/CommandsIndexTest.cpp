@@ -0,0 +1,35 @@
+// This source file is part of the 'hat' open source project.
+// Copyright (c) 2016, Yuriy Vosel.
+// Licensed under Boost Software License.
+// See LICENSE.txt for the licence information.
+
+#include "../hat-core/commands_index.hpp"
+#include "../external_dependencies/Catch/single_include/catch.hpp"
+
+TEST_CASE("Commands index lookups", "[commands_index]")
+{
+	auto index = hat::core::CommandsIndex{};
+	REQUIRE_FALSE(index.find(hat::core::CommandID{ "run" }).first);
+
+	// Enough commands to make the table grow several times:
+	size_t const commandsCount = 1000;
+	for (size_t i = 0; i < commandsCount; ++i) {
+		REQUIRE(index.add(hat::core::CommandID{ "command_" + std::to_string(i) }) == i);
+	}
+	REQUIRE(index.size() == commandsCount);
+
+	for (size_t i = 0; i < commandsCount; ++i) {
+		auto const findResult = index.find(hat::core::CommandID{ "command_" + std::to_string(i) });
+		REQUIRE(findResult.first);
+		REQUIRE(findResult.second == i);
+	}
+	REQUIRE_FALSE(index.find(hat::core::CommandID{ "command_" + std::to_string(commandsCount) }).first);
+	REQUIRE_FALSE(index.find(hat::core::CommandID{ "command_" }).first);
+	REQUIRE_FALSE(index.find(hat::core::CommandID{}).first);
+
+	// The copy of the index is independent from the original:
+	auto indexCopy = index;
+	indexCopy.add(hat::core::CommandID{ "new_command" });
+	REQUIRE(indexCopy.find(hat::core::CommandID{ "new_command" }).second == commandsCount);
+	REQUIRE_FALSE(index.find(hat::core::CommandID{ "new_command" }).first);
+}
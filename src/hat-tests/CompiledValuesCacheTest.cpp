@@ -0,0 +1,36 @@
+// This source file is part of the 'hat' open source project.
+// Copyright (c) 2016, Yuriy Vosel.
+// Licensed under Boost Software License.
+// See LICENSE.txt for the licence information.
+
+#include "../hat-core/compiled_values_cache.hpp"
+#include "../external_dependencies/Catch/single_include/catch.hpp"
+#include <vector>
+
+TEST_CASE("Compiled values cache", "[compiled_values_cache]")
+{
+	auto compilationsCount = size_t{ 0 };
+	auto const compileToLength = [&compilationsCount](std::string const & toCompile) {
+		++compilationsCount;
+		return toCompile.size();
+	};
+
+	hat::core::CompiledValuesCache<size_t> cache;
+	auto const first = cache.get("^S", compileToLength);
+	REQUIRE(*first == 2);
+	REQUIRE(compilationsCount == 1);
+	REQUIRE(cache.getMissesCount() == 1);
+	REQUIRE(cache.getHitsCount() == 0);
+
+	// The same string is not compiled again, and the same object is returned:
+	auto const second = cache.get("^S", compileToLength);
+	REQUIRE(second == first);
+	REQUIRE(compilationsCount == 1);
+	REQUIRE(cache.getHitsCount() == 1);
+
+	auto const third = cache.get("{F5}", compileToLength);
+	REQUIRE(*third == 4);
+	REQUIRE(compilationsCount == 2);
+	REQUIRE(cache.getMissesCount() == 2);
+	REQUIRE(cache.size() == 2);
+}
@@ -0,0 +1,169 @@
+// This source file is part of the 'hat' open source project.
+// Copyright (c) 2016, Yuriy Vosel.
+// Licensed under Boost Software License.
+// See LICENSE.txt for the licence information.
+
+#include "../hat-core/config_bundle.hpp"
+#include "../external_dependencies/Catch/single_include/catch.hpp"
+#include <sstream>
+
+using namespace std::string_literals;
+
+namespace {
+	// The hotkey combination, which is compiled during the creation (like the tool's ones).
+	struct CompiledHotkeyCombination : public hat::core::SimpleHotkeyCombination
+	{
+		std::string m_compiledData;
+		CompiledHotkeyCombination(std::string const & value, std::string const & compiledData) : hat::core::SimpleHotkeyCombination(value), m_compiledData(compiledData) {};
+		std::string getCompiledData() const override { return m_compiledData; };
+	};
+	std::string compileHotkey(std::string const & param) { return "compiled " + param; };
+
+	auto const hotkeysBuilder = [](std::string const & param, hat::core::CommandID const &, size_t) {
+		return std::make_shared<CompiledHotkeyCombination>(param, compileHotkey(param));
+	};
+	// The hotkeys are not compiled again, when they are loaded from the bundle:
+	auto const precompiledHotkeysBuilder = [](std::string const & param, std::string const & compiledData, hat::core::CommandID const &, size_t) {
+		REQUIRE(compiledData == compileHotkey(param));
+		return std::make_shared<CompiledHotkeyCombination>(param, compiledData);
+	};
+	auto const mouseInputsBuilder = [](std::string const & param, hat::core::CommandID const &, size_t) {
+		return std::make_shared<hat::core::SimpleMouseInput>(param);
+	};
+	auto const sleepObjectsBuilder = [](std::string const & param, hat::core::CommandID const &, size_t) {
+		return std::make_shared<hat::core::SimpleSleepOperation>(param, std::stoi(param), true);
+	};
+	auto const textTypingBuilder = [](std::string const & param, hat::core::CommandID const &, size_t) {
+		return std::make_shared<hat::core::SimpleTextTyping>(param);
+	};
+
+	std::string const COMMANDS_CONFIG{ hat::core::ConfigFilesKeywords::mandatoryCellsNamesInCommandsCSV() + "ENV0\tENV1\n"
+		"run\tdebugger\trun note\trun description\t{F5}\t{F6}\n"
+		"build\tbuild\tbuild note\tbuild description\t{F7}\n" // The value for the ENV1 is missing
+		"empty\tbuild\tempty note\tempty description\n" };
+
+	std::string const INPUT_SEQUENCES_CONFIG{
+		"mouseInput\tclick\tmouse\tclick note\tclick description\tENV0\tL:10,20\n"
+		"sleepForTimeout\twait\tsleep\twait note\twait description\t*\t100\n"
+		"systemCall\tlist\tsystem\tlist note\tlist description\tENV1\tls -l\n"
+		"simpleTypingJob\ttype\ttyping\ttype note\ttype description\t*\thello\n"
+		"typeText\tsnippet\ttyping\tsnippet note\tsnippet description\tENV1\tHello, \xC3\xA9t\xC3\xA9 {F5}+^%\n"
+		"commandSequence\tsequence\tsequences\tsequence note\tsequence description\t*\trun,wait,snippet,click\n" };
+
+	std::string const VARIABLES_CONFIG{
+		"defineVariable\tVAR_0\n"
+		"defineVariable\tVAR_1\n"
+		"initValueForVar\tENV0\tVAR_0\tinitial value\n"
+		"variableUpdate_append\t*\trun\tVAR_0\tappended text\n"
+		"variableUpdate_reset\tENV1\tbuild\tVAR_0\tassigned text\n"
+		"variableUpdate_backspace\t*\trun\tVAR_0\t3\n"
+		"variableUpdate_appendValueFromAnotherLabel\t*\tsequence\tVAR_1\tVAR_0\n"
+		"variableUpdate_assignValueFromAnotherLabel\tENV0\tsequence\tVAR_0\tVAR_1\n" };
+
+	std::string const IMAGE_RESOURCES_CONFIG{ "IMAGE_0\timage0.png\n" "IMAGE_1\timage1.png\t10,20\t30,40\n" };
+	std::string const IMAGES_TO_COMMANDS_CONFIG{ "run\t*\tIMAGE_0\n" "build\tENV1\tIMAGE_1\n" };
+
+	std::string const LAYOUT_CONFIG{
+		"page:main page\n"
+		"run,build;text:VAR_0\n"
+		";sequence;selector\n"
+		"optionsSelectorPage:selector;selector caption\n"
+		"click;wait\n"
+		"list\n" };
+
+	hat::core::ConfigBundleContents parseTextConfigs()
+	{
+		auto commandsConfig = hat::core::CommandsInfoContainer::parseConfigFile(hat::core::StringRef(COMMANDS_CONFIG), hotkeysBuilder);
+		commandsConfig.consumeInputSequencesConfigFile(hat::core::StringRef(INPUT_SEQUENCES_CONFIG), hotkeysBuilder, mouseInputsBuilder, sleepObjectsBuilder, textTypingBuilder);
+		commandsConfig.consumeVariablesManagersConfig(hat::core::StringRef(VARIABLES_CONFIG));
+		auto imagesConfig = hat::core::ImageResourcesInfosContainer{ commandsConfig.getEnvironments() };
+		imagesConfig.consumeImageResourcesConfig(hat::core::StringRef(IMAGE_RESOURCES_CONFIG), hat::core::StringRef(IMAGES_TO_COMMANDS_CONFIG));
+		auto layout = hat::core::LayoutUserInformation::parseConfigFile(hat::core::StringRef(LAYOUT_CONFIG));
+		return hat::core::ConfigBundleContents{ commandsConfig, imagesConfig, layout };
+	}
+
+	std::string writeBundle(hat::core::ConfigBundleSources const & sources, hat::core::ConfigBundleContents const & configs)
+	{
+		std::stringstream result;
+		hat::core::writeConfigBundle(result, sources, configs.m_commandsConfig, configs.m_imagesConfig, configs.m_layout);
+		return result.str();
+	}
+}
+
+TEST_CASE("Precompiled configs bundle round trip", "[config_bundle]")
+{
+	auto const sources = hat::core::ConfigBundleSources{
+		{ "commands.csv", true, hat::core::calculateConfigContentsHash(COMMANDS_CONFIG) },
+		{ "input_sequences.csv", true, hat::core::calculateConfigContentsHash(INPUT_SEQUENCES_CONFIG) },
+		{ "missing_config.csv", false, 0 } };
+	auto const textConfigs = parseTextConfigs();
+	auto const bundle = writeBundle(sources, textConfigs);
+
+	REQUIRE(hat::core::readConfigBundleSources(bundle) == sources);
+
+	auto const loadedConfigs = hat::core::readConfigBundle(bundle, precompiledHotkeysBuilder, mouseInputsBuilder, sleepObjectsBuilder, textTypingBuilder);
+	REQUIRE(loadedConfigs.m_commandsConfig == textConfigs.m_commandsConfig);
+	for (size_t i = 0; i < textConfigs.m_commandsConfig.getEnvironments().size(); ++i) {
+		REQUIRE(loadedConfigs.m_commandsConfig.getVariablesManagers_c().getManagerForEnv_c(i) == textConfigs.m_commandsConfig.getVariablesManagers_c().getManagerForEnv_c(i));
+	}
+	REQUIRE(loadedConfigs.m_imagesConfig == textConfigs.m_imagesConfig);
+	REQUIRE(loadedConfigs.m_layout == textConfigs.m_layout);
+
+	// The commands in the sequence should reference the loaded objects:
+	auto const & loadedCommands = loadedConfigs.m_commandsConfig;
+	REQUIRE(loadedCommands.getCommandIndex(hat::core::CommandID{ "sequence"s }) == textConfigs.m_commandsConfig.getCommandIndex(hat::core::CommandID{ "sequence"s }));
+	auto const loadedSequence = std::dynamic_pointer_cast<hat::core::InputSequencesCollection>(loadedCommands.getCommandPrefs(hat::core::CommandID{ "sequence"s }).hotkeysForEnvironments[0]);
+	REQUIRE(loadedSequence);
+	REQUIRE(loadedSequence->getTimeline().m_events.size() == 2); // the 'snippet' command is not defined for the ENV0, and the 'wait' command is turned into the delay
+	REQUIRE(loadedSequence->getTimeline().m_events[0].m_input == loadedCommands.getCommandPrefs(hat::core::CommandID{ "run"s }).hotkeysForEnvironments[0]);
+
+	// Writing the loaded configs again should produce exactly the same bundle:
+	REQUIRE(writeBundle(sources, loadedConfigs) == bundle);
+}
+
+TEST_CASE("Precompiled configs bundle validation", "[config_bundle]")
+{
+	auto const sources = hat::core::ConfigBundleSources{ { "commands.csv", true, hat::core::calculateConfigContentsHash(COMMANDS_CONFIG) } };
+	auto const bundle = writeBundle(sources, parseTextConfigs());
+
+	// Any change of the config contents should be detected through the hash:
+	REQUIRE(hat::core::calculateConfigContentsHash(COMMANDS_CONFIG) != hat::core::calculateConfigContentsHash(COMMANDS_CONFIG + "\n"));
+	auto changedSources = sources;
+	changedSources[0].m_contentsHash = hat::core::calculateConfigContentsHash(COMMANDS_CONFIG + "\n");
+	REQUIRE(hat::core::readConfigBundleSources(bundle) != changedSources);
+
+	// The truncated data and the data, which is not a bundle, are rejected:
+	REQUIRE_THROWS(hat::core::readConfigBundle(hat::core::StringRef(bundle.data(), bundle.size() - 1), precompiledHotkeysBuilder, mouseInputsBuilder, sleepObjectsBuilder, textTypingBuilder));
+	REQUIRE_THROWS(hat::core::readConfigBundleSources(COMMANDS_CONFIG));
+	REQUIRE_THROWS(hat::core::readConfigBundleSources(""s));
+
+	// The bundles written in other format versions are rejected:
+	auto const signatureLength = bundle.find("HAT_CONFIG_BUNDLE") + std::string{ "HAT_CONFIG_BUNDLE" }.size();
+	auto otherVersionBundle = bundle;
+	otherVersionBundle[signatureLength] = static_cast<char>(otherVersionBundle[signatureLength] + 1);
+	REQUIRE_THROWS(hat::core::readConfigBundleSources(otherVersionBundle));
+}
+
+TEST_CASE("Aggregated commands with the referenced commands indices", "[config_bundle]")
+{
+	auto commandsConfig = hat::core::CommandsInfoContainer::parseConfigFile(hat::core::StringRef(COMMANDS_CONFIG), hotkeysBuilder);
+	auto const & runInputs = commandsConfig.getCommandPrefs(hat::core::CommandID{ "run"s }).hotkeysForEnvironments;
+	auto const & buildInputs = commandsConfig.getCommandPrefs(hat::core::CommandID{ "build"s }).hotkeysForEnvironments;
+
+	// The commands are referenced by the indices, the ids in the values are not looked up:
+	commandsConfig.pushDataRowForAggregatedCommand(hat::core::ParsedCsvRow{ std::vector<std::string>{ "sequence", "sequences", "sequence note", "", "build,run", "run" } }, { { 1, 0 }, { 0 } });
+	auto const & sequenceInputs = commandsConfig.getCommandPrefs(hat::core::CommandID{ "sequence"s }).hotkeysForEnvironments;
+	auto const firstEnvironmentSequence = std::dynamic_pointer_cast<hat::core::InputSequencesCollection>(sequenceInputs[0]);
+	auto const secondEnvironmentSequence = std::dynamic_pointer_cast<hat::core::InputSequencesCollection>(sequenceInputs[1]);
+	REQUIRE(firstEnvironmentSequence);
+	REQUIRE(secondEnvironmentSequence);
+	REQUIRE(firstEnvironmentSequence->m_value == "build,run");
+	REQUIRE(firstEnvironmentSequence->getTimeline().m_events.size() == 2);
+	REQUIRE(firstEnvironmentSequence->getTimeline().m_events[0].m_input == buildInputs[0]);
+	REQUIRE(firstEnvironmentSequence->getTimeline().m_events[1].m_input == runInputs[0]);
+	REQUIRE(secondEnvironmentSequence->getTimeline().m_events.size() == 1);
+	REQUIRE(secondEnvironmentSequence->getTimeline().m_events[0].m_input == runInputs[1]);
+
+	// The commands, which are not stored yet, can't be referenced (the bundle is corrupted in this case):
+	REQUIRE_THROWS(commandsConfig.pushDataRowForAggregatedCommand(hat::core::ParsedCsvRow{ std::vector<std::string>{ "broken", "sequences", "broken note", "", "run" } }, { { 10 } }));
+}
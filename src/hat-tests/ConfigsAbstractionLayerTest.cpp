@@ -337,6 +337,182 @@ TEST_CASE("test that pages with no active buttons are not shown", "[configs_abst
 	REQUIRE(layoutWhenENV1isSelected == reference_layoutWhenENV1isSelected);
 	REQUIRE(layoutWhenENV2isSelected == reference_layoutWhenENV2isSelected);
 }
+TEST_CASE("test that the selector pages are generated once and shared between the buttons", "[configs_abstraction]")
+{
+	auto const FIRST_PAGE_CAPTION = "first page"s;
+	auto const SECOND_PAGE_CAPTION = "second page"s;
+	auto const SELECTOR_ID = "selector"s;
+	auto const SELECTOR_CAPTION = "selector page"s;
+	auto const OUTER_SELECTOR_ID = "outer_selector"s;
+	auto const OUTER_SELECTOR_CAPTION = "outer selector page"s;
+
+	hat::test::LayoutConfigParsingVerificator verificator;
+	verificator.startNewPage(FIRST_PAGE_CAPTION);
+	verificator.addRow({ SELECTOR_ID, OUTER_SELECTOR_ID });
+	verificator.startNewPage(SECOND_PAGE_CAPTION);
+	verificator.addRow({ SELECTOR_ID });
+	verificator.startNewOptionsSelectorPage(OUTER_SELECTOR_CAPTION, OUTER_SELECTOR_ID);
+	verificator.addRow({ SELECTOR_ID });
+	verificator.startNewOptionsSelectorPage(SELECTOR_CAPTION, SELECTOR_ID);
+	verificator.addRow({ "hkF"s });
+	verificator.verifyConfigIsOK();
+
+	auto layoutsGenerator = hat::core::ConfigsAbstractionLayer{ verificator.getAccumulatedConfig(), getDefaultCommandsInfoContainer(), getDefaultImagesInfoContainer() };
+	auto const layout = layoutsGenerator.generateLayoutPresentation(ENV0, true);
+	REQUIRE(layout.getPages().size() == 3);
+	auto const & firstPageRow = layout.getPages()[1].getLayout()[0];
+	auto const & secondPageRow = layout.getPages()[2].getLayout()[0];
+
+	auto const selectorPage = firstPageRow[0].getOptionsPagePtr();
+	REQUIRE(selectorPage != nullptr);
+	REQUIRE(selectorPage->getNote() == SELECTOR_CAPTION);
+	REQUIRE(secondPageRow[0].getOptionsPagePtr() == selectorPage);
+
+	auto const outerSelectorPage = firstPageRow[1].getOptionsPagePtr();
+	REQUIRE(outerSelectorPage != nullptr);
+	REQUIRE(outerSelectorPage->getLayout()[0][0].getOptionsPagePtr() == selectorPage);
+
+	// The pages are not shared between the calls:
+	auto const anotherLayout = layoutsGenerator.generateLayoutPresentation(ENV0, true);
+	REQUIRE(anotherLayout == layout);
+	REQUIRE(anotherLayout.getPages()[1].getLayout()[0][0].getOptionsPagePtr() != selectorPage);
+}
+
+TEST_CASE("test the resolving of the layout IDs", "[configs_abstraction]")
+{
+	using Type = hat::core::ResolvedLayout::Option::Type;
+	auto const PAGE_CAPTION = "main page"s;
+	auto const SELECTOR_ID = "selector"s;
+	auto const SELECTOR_CAPTION = "selector page"s;
+
+	hat::test::LayoutConfigParsingVerificator verificator;
+	verificator.startNewPage(PAGE_CAPTION);
+	verificator.addRow({ "hk1,unknown_command,"s + SELECTOR_ID, "text:unknown_variable"s });
+	verificator.startNewOptionsSelectorPage(SELECTOR_CAPTION, SELECTOR_ID);
+	verificator.addRow({ "hkF"s });
+	verificator.verifyConfigIsOK();
+
+	auto const & commandsConfig = getDefaultCommandsInfoContainer();
+	auto const resolvedLayout = hat::core::ResolvedLayout::resolve(verificator.getAccumulatedConfig(), commandsConfig);
+	REQUIRE(resolvedLayout.getPages().size() == 1);
+	REQUIRE(resolvedLayout.getPages()[0].m_note == PAGE_CAPTION);
+	REQUIRE(resolvedLayout.getSelectorPages().size() == 1);
+	REQUIRE(resolvedLayout.getSelectorPages()[0].m_note == SELECTOR_CAPTION);
+
+	auto const & row = resolvedLayout.getPages()[0].m_rows[0];
+	REQUIRE(row.size() == 2);
+	REQUIRE(row[0].size() == 3);
+	REQUIRE(row[0][0].m_type == Type::COMMAND);
+	REQUIRE(row[0][0].m_index == commandsConfig.getCommandIndex(hat::core::CommandID{ "hk1" }));
+	REQUIRE(row[0][1].m_type == Type::UNKNOWN_ID);
+	REQUIRE(row[0][2].m_type == Type::SELECTOR_PAGE);
+	REQUIRE(row[0][2].m_index == 0);
+	REQUIRE(row[1].size() == 1);
+	REQUIRE(row[1][0].m_type == Type::VARIABLE);
+	REQUIRE(resolvedLayout.getVariables()[row[1][0].m_index] == hat::core::VariableID{ "unknown_variable" });
+	REQUIRE_FALSE(resolvedLayout.isVariableDefined(row[1][0].m_index, ENV0));
+
+	REQUIRE(resolvedLayout.getUnknownIDs() == std::vector<std::string>({ "text:unknown_variable"s, "unknown_command"s }));
+}
+
+TEST_CASE("test the ordering of the selector pages and the cyclic references detection", "[configs_abstraction]")
+{
+	hat::test::LayoutConfigParsingVerificator verificator;
+	verificator.startNewPage("main page"s);
+	verificator.addRow({ "a_selector"s });
+	verificator.startNewOptionsSelectorPage("outer selector"s, "a_selector"s);
+	verificator.addRow({ "b_selector"s, "hk1"s });
+	verificator.startNewOptionsSelectorPage("inner selector"s, "b_selector"s);
+	verificator.addRow({ "hk2"s });
+	verificator.verifyConfigIsOK();
+
+	auto const resolvedLayout = hat::core::ResolvedLayout::resolve(verificator.getAccumulatedConfig(), getDefaultCommandsInfoContainer());
+	// The referenced page goes first:
+	REQUIRE(resolvedLayout.getSelectorPages()[0].m_note == "inner selector"s);
+	REQUIRE(resolvedLayout.getSelectorPages()[1].m_note == "outer selector"s);
+	REQUIRE(resolvedLayout.getSelectorPages()[1].m_rows[0][0][0].m_index == 0);
+
+	// The activity of the pages is propagated from the inner pages (hk1 is enabled only for ENV0, hk2 only for ENV1):
+	REQUIRE(resolvedLayout.isSelectorPageActive(0, ENV1));
+	REQUIRE(resolvedLayout.isSelectorPageActive(1, ENV1));
+	REQUIRE(resolvedLayout.isPageActive(0, ENV1));
+	REQUIRE_FALSE(resolvedLayout.isSelectorPageActive(0, ENV0));
+	REQUIRE(resolvedLayout.isSelectorPageActive(1, ENV0));
+	REQUIRE_FALSE(resolvedLayout.isSelectorPageActive(0, ENV2));
+	REQUIRE_FALSE(resolvedLayout.isSelectorPageActive(1, ENV2));
+	REQUIRE_FALSE(resolvedLayout.isPageActive(0, ENV2));
+
+	// A cycle through 2 pages:
+	using Catch::Matchers::Contains;
+	verificator.addRow({ "a_selector"s });
+	verificator.verifyConfigIsOK();
+	REQUIRE_THROWS_WITH(hat::core::ResolvedLayout::resolve(verificator.getAccumulatedConfig(), getDefaultCommandsInfoContainer()),
+		Contains("'a_selector' -> 'b_selector' -> 'a_selector'"));
+}
+
+TEST_CASE("test that the texts of the layout are escaped for json once during the resolving", "[configs_abstraction]")
+{
+	auto const commandsConfig = std::string{
+		hat::core::ConfigFilesKeywords::mandatoryCellsNamesInCommandsCSV() + "ENV \"0\"\tENV1\n"
+		"hk0\tcategory\thk0 \"note\"\thk0_desc\thk0_keys\thk0_keys\n" };
+	auto const commandsInfo = hat::test::simulateParseConfigFileCall(commandsConfig);
+
+	hat::test::LayoutConfigParsingVerificator verificator;
+	verificator.startNewPage("page \\ \xE2\x82\xAC"s);
+	verificator.addRow({ "hk0"s });
+	verificator.verifyConfigIsOK();
+
+	auto const resolvedLayout = hat::core::ResolvedLayout::resolve(verificator.getAccumulatedConfig(), commandsInfo);
+	REQUIRE(resolvedLayout.getPages()[0].m_note == "page \\\\ \xE2\x82\xAC"s); // the multi-byte characters are not escaped
+	REQUIRE(resolvedLayout.getCommandNote(0) == "hk0 \\\"note\\\""s);
+	REQUIRE(resolvedLayout.getEnvironmentName(0) == "ENV \\\"0\\\""s);
+
+	// The control characters are escaped as the unicode codepoints:
+	REQUIRE(hat::core::escapeRawUTF8_forJson("line\nline"s) == "line\\u000aline"s);
+	REQUIRE_THROWS(hat::core::escapeRawUTF8_forJson("\xE2\x82"s));
+}
+
+TEST_CASE("test the comparison of the layouts for the notes updates", "[configs_abstraction]")
+{
+	typedef std::vector<std::pair<size_t, std::string>> NotesChanges;
+	auto createLayout = [](std::string const & commandNote, std::string const & labelNote, std::string const & selectorNote, std::string const & optionNote, std::string const & secondPageCommandNote) {
+		auto optionsPage = std::make_shared<hat::core::InternalLayoutPageRepresentation>(oneRowPage("options"s, { activeButton(optionNote, hat::core::CommandID{ "hk2" }) }));
+		return hat::core::InternalLayoutRepresentation({
+			// The elements are numbered in the traversal order: hk1 button (0), label (1), selector (2), the option inside the selector (3), hk3 button on the second page (4).
+			oneRowPage("page"s, {
+				activeButton(commandNote, hat::core::CommandID{ "hk1" }),
+				hat::core::InternalLayoutElementRepresentation{ labelNote },
+				hat::core::InternalLayoutElementRepresentation{}.setSelectorButtonAttrs(selectorNote, optionsPage) }),
+			oneRowPage("second page"s, { activeButton(secondPageCommandNote, hat::core::CommandID{ "hk3" }) })
+		});
+	};
+	auto const originalLayout = createLayout("hk1_note"s, "label"s, "selector"s, "hk2_note"s, "hk3_note"s);
+
+	auto const sameLayoutChanges = hat::core::calculateLayoutNotesChanges(originalLayout, originalLayout);
+	REQUIRE(sameLayoutChanges.m_isStructureTheSame);
+	REQUIRE(sameLayoutChanges.m_changedNotes.empty());
+
+	auto const changedNotes = hat::core::calculateLayoutNotesChanges(originalLayout, createLayout("new hk1_note"s, "new label"s, "selector"s, "new hk2_note"s, "new hk3_note"s));
+	REQUIRE(changedNotes.m_isStructureTheSame);
+	REQUIRE((changedNotes.m_changedNotes == NotesChanges{ { 0, "new hk1_note"s }, { 1, "new label"s }, { 3, "new hk2_note"s }, { 4, "new hk3_note"s } }));
+
+	// The note of the selector is also displayed on the options page decorations, so it can't be updated separately:
+	auto const changedSelectorNote = hat::core::calculateLayoutNotesChanges(originalLayout, createLayout("new hk1_note"s, "label"s, "new selector"s, "hk2_note"s, "hk3_note"s));
+	REQUIRE_FALSE(changedSelectorNote.m_isStructureTheSame);
+	REQUIRE(changedSelectorNote.m_changedNotes.empty());
+
+	// The changes of the buttons activity:
+	auto layoutWithInactiveButton = hat::core::InternalLayoutRepresentation({ oneRowPage("page"s, { inactiveButton("hk1_note"s) }) });
+	auto layoutWithActiveButton = hat::core::InternalLayoutRepresentation({ oneRowPage("page"s, { activeButton("hk1_note"s, hat::core::CommandID{ "hk1" }) }) });
+	REQUIRE_FALSE(hat::core::calculateLayoutNotesChanges(layoutWithInactiveButton, layoutWithActiveButton).m_isStructureTheSame);
+	REQUIRE_FALSE(hat::core::calculateLayoutNotesChanges(layoutWithInactiveButton, hat::core::InternalLayoutRepresentation({ oneRowPage("page"s, { inactiveButton("new hk1_note"s) }) })).m_isStructureTheSame);
+
+	// The changes of the pages:
+	REQUIRE_FALSE(hat::core::calculateLayoutNotesChanges(layoutWithActiveButton, hat::core::InternalLayoutRepresentation({ oneRowPage("new page"s, { activeButton("hk1_note"s, hat::core::CommandID{ "hk1" }) }) })).m_isStructureTheSame);
+	REQUIRE_FALSE(hat::core::calculateLayoutNotesChanges(layoutWithActiveButton, hat::core::InternalLayoutRepresentation({ oneRowPage("page"s, { activeButton("hk1_note"s, hat::core::CommandID{ "hk2" }) }) })).m_isStructureTheSame);
+	REQUIRE_FALSE(hat::core::calculateLayoutNotesChanges(layoutWithActiveButton, originalLayout).m_isStructureTheSame);
+}
+
 TEST_CASE("test that when there is one ENV, we don't show ENV selection page", "[configs_abstraction]")
 {
 	auto const singleENVCommandsConfiguration = std::string{
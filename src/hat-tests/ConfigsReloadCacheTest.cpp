@@ -0,0 +1,195 @@
+// This source file is part of the 'hat' open source project.
+// Copyright (c) 2016, Yuriy Vosel.
+// Licensed under Boost Software License.
+// See LICENSE.txt for the licence information.
+
+#include "../hat-core/configs_reload_cache.hpp"
+#include "../external_dependencies/Catch/single_include/catch.hpp"
+
+TEST_CASE("Config parts cache invalidation", "[configs_reload_cache]")
+{
+	auto const layoutConfig = std::string{ "page:main page\nrun,build\n" };
+	auto const dependencies = hat::core::ConfigPartDependencies{ { { "layout.csv", true, hat::core::calculateConfigContentsHash(layoutConfig) } }, { "ENV0", "ENV1" } };
+	auto const layout = hat::core::LayoutUserInformation::parseConfigFile(hat::core::StringRef(layoutConfig));
+
+	auto cachedLayout = hat::core::CachedConfigPart<hat::core::LayoutUserInformation>{};
+	REQUIRE_FALSE(cachedLayout.isUpToDate(dependencies)); // nothing was stored yet
+
+	cachedLayout.store(dependencies, layout);
+	REQUIRE(cachedLayout.isUpToDate(dependencies));
+	REQUIRE(cachedLayout.get() == layout);
+
+	// Changed file contents:
+	auto changedFileDependencies = dependencies;
+	changedFileDependencies.m_sources[0].m_contentsHash = hat::core::calculateConfigContentsHash(layoutConfig + "list\n");
+	REQUIRE_FALSE(cachedLayout.isUpToDate(changedFileDependencies));
+
+	// Removed file:
+	auto removedFileDependencies = dependencies;
+	removedFileDependencies.m_sources[0] = hat::core::ConfigBundleSourceFile{ "layout.csv", false, 0 };
+	REQUIRE_FALSE(cachedLayout.isUpToDate(removedFileDependencies));
+
+	// Added file:
+	auto addedFileDependencies = dependencies;
+	addedFileDependencies.m_sources.push_back(hat::core::ConfigBundleSourceFile{ "another_layout.csv", true, 0 });
+	REQUIRE_FALSE(cachedLayout.isUpToDate(addedFileDependencies));
+
+	// Changed environments list:
+	auto changedEnvironmentsDependencies = dependencies;
+	changedEnvironmentsDependencies.m_environments.pop_back();
+	REQUIRE_FALSE(cachedLayout.isUpToDate(changedEnvironmentsDependencies));
+
+	// Storing the new value replaces the previous one:
+	cachedLayout.store(changedFileDependencies, layout);
+	REQUIRE(cachedLayout.isUpToDate(changedFileDependencies));
+	REQUIRE_FALSE(cachedLayout.isUpToDate(dependencies));
+}
+
+namespace {
+	auto const hotkeysBuilder = [](std::string const & param, hat::core::CommandID const &, size_t) {
+		return std::make_shared<hat::core::SimpleHotkeyCombination>(param);
+	};
+
+	// The sources in the loading order: the commands config, two input sequences configs, the variables managers config, two image resources configs, the layout config.
+	size_t const INPUT_SEQUENCES_CONFIGS_COUNT = 2;
+	size_t const VARIABLES_MANAGERS_CONFIGS_COUNT = 1;
+	size_t const IMAGES_CONFIGS_COUNT = 2;
+	hat::core::ConfigBundleSources const ALL_SOURCES{
+		{ "commands.csv", true, 1 },
+		{ "input_sequences_0.csv", true, 2 },
+		{ "input_sequences_1.csv", true, 3 },
+		{ "variables.csv", true, 4 },
+		{ "image_resources.csv", true, 5 },
+		{ "images_to_commands.csv", true, 6 },
+		{ "layout.csv", true, 7 } };
+
+	hat::core::ConfigPartsDependencies calculateDependencies(hat::core::ConfigBundleSources const & sources)
+	{
+		return hat::core::calculateConfigPartsDependencies(sources, INPUT_SEQUENCES_CONFIGS_COUNT, VARIABLES_MANAGERS_CONFIGS_COUNT, IMAGES_CONFIGS_COUNT);
+	}
+
+	// The cache after the complete loading of the ALL_SOURCES configs.
+	hat::core::ConfigsReloadCache createFilledCache(hat::core::CommandsInfoContainer::EnvsContainer const & environments)
+	{
+		auto const commandsConfig = hat::core::CommandsInfoContainer::parseConfigFile(hat::core::StringRef(hat::core::ConfigFilesKeywords::mandatoryCellsNamesInCommandsCSV() + "ENV0\tENV1\n"), hotkeysBuilder);
+		auto const dependencies = calculateDependencies(ALL_SOURCES);
+		auto result = hat::core::ConfigsReloadCache{};
+		result.m_commands.store(dependencies.m_commands, commandsConfig);
+		result.m_commandsWithVariables.store(dependencies.m_variables, commandsConfig);
+		result.m_images.store(dependencies.getImagesDependencies(environments), hat::core::ImageResourcesInfosContainer{ environments });
+		result.m_layout.store(dependencies.m_layout, hat::core::LayoutUserInformation::parseConfigFile(hat::core::StringRef("page:main page\n")));
+		return result;
+	}
+
+	struct ExpectedPartsToParse
+	{
+		bool m_commands;
+		bool m_variables;
+		bool m_images;
+		bool m_layout;
+	};
+
+	void checkPartsToParse(hat::core::ConfigsReloadCache const & cache, hat::core::ConfigBundleSources const & sources, hat::core::CommandsInfoContainer::EnvsContainer const & environments, ExpectedPartsToParse const & expected)
+	{
+		auto const dependencies = calculateDependencies(sources);
+		auto const partsToParse = cache.getConfigPartsToParse(dependencies);
+		CHECK(partsToParse.m_commands == expected.m_commands);
+		CHECK(partsToParse.m_variables == expected.m_variables);
+		CHECK(cache.shouldParseImages(dependencies, environments) == expected.m_images);
+		CHECK(partsToParse.m_layout == expected.m_layout);
+	}
+
+	hat::core::ConfigBundleSources withChangedSource(size_t sourceIndex)
+	{
+		auto result = ALL_SOURCES;
+		result[sourceIndex].m_contentsHash += 100;
+		return result;
+	}
+}
+
+TEST_CASE("Config parts dependencies", "[configs_reload_cache]")
+{
+	auto const dependencies = calculateDependencies(ALL_SOURCES);
+	REQUIRE(dependencies.m_commands.m_sources == hat::core::ConfigBundleSources(ALL_SOURCES.begin(), ALL_SOURCES.begin() + 3));
+	REQUIRE(dependencies.m_variables.m_sources == hat::core::ConfigBundleSources(ALL_SOURCES.begin(), ALL_SOURCES.begin() + 4));
+	REQUIRE(dependencies.m_imagesSources == hat::core::ConfigBundleSources(ALL_SOURCES.begin() + 4, ALL_SOURCES.begin() + 6));
+	REQUIRE(dependencies.m_layout.m_sources == hat::core::ConfigBundleSources(ALL_SOURCES.begin() + 6, ALL_SOURCES.end()));
+	REQUIRE(dependencies.getImagesDependencies({ "ENV0" }).m_environments == hat::core::CommandsInfoContainer::EnvsContainer{ "ENV0" });
+
+	// Without the optional configs:
+	auto const minimalSources = hat::core::ConfigBundleSources{ ALL_SOURCES.front(), ALL_SOURCES.back() };
+	auto const minimalDependencies = hat::core::calculateConfigPartsDependencies(minimalSources, 0, 0, 0);
+	REQUIRE(minimalDependencies.m_commands.m_sources == hat::core::ConfigBundleSources{ ALL_SOURCES.front() });
+	REQUIRE(minimalDependencies.m_variables.m_sources == hat::core::ConfigBundleSources{ ALL_SOURCES.front() });
+	REQUIRE(minimalDependencies.m_imagesSources.empty());
+	REQUIRE(minimalDependencies.m_layout.m_sources == hat::core::ConfigBundleSources{ ALL_SOURCES.back() });
+
+	REQUIRE_THROWS(hat::core::calculateConfigPartsDependencies(ALL_SOURCES, INPUT_SEQUENCES_CONFIGS_COUNT, VARIABLES_MANAGERS_CONFIGS_COUNT, IMAGES_CONFIGS_COUNT + 1));
+	REQUIRE_THROWS(hat::core::calculateConfigPartsDependencies(minimalSources, 1, 0, 0));
+}
+
+TEST_CASE("Config parts invalidation after the config files changes", "[configs_reload_cache]")
+{
+	auto const environments = hat::core::CommandsInfoContainer::EnvsContainer{ "ENV0", "ENV1" };
+
+	SECTION("empty cache") {
+		checkPartsToParse(hat::core::ConfigsReloadCache{}, ALL_SOURCES, environments, { true, true, true, true });
+	}
+
+	auto const cache = createFilledCache(environments);
+	SECTION("nothing changed") {
+		checkPartsToParse(cache, ALL_SOURCES, environments, { false, false, false, false });
+	}
+	SECTION("commands config changed") {
+		checkPartsToParse(cache, withChangedSource(0), environments, { true, true, false, false });
+	}
+	SECTION("input sequences configs changed") {
+		checkPartsToParse(cache, withChangedSource(1), environments, { true, true, false, false });
+		checkPartsToParse(cache, withChangedSource(2), environments, { true, true, false, false });
+	}
+	SECTION("variables managers config changed") {
+		// The commands without the variables are reused
+		checkPartsToParse(cache, withChangedSource(3), environments, { false, true, false, false });
+	}
+	SECTION("image resources configs changed") {
+		checkPartsToParse(cache, withChangedSource(4), environments, { false, false, true, false });
+		checkPartsToParse(cache, withChangedSource(5), environments, { false, false, true, false });
+	}
+	SECTION("layout config changed") {
+		checkPartsToParse(cache, withChangedSource(6), environments, { false, false, false, true });
+	}
+	SECTION("environments list changed") {
+		// Happens only together with the commands config change
+		checkPartsToParse(cache, withChangedSource(0), { "ENV0" }, { true, true, true, false });
+	}
+	SECTION("config file removed") {
+		auto sources = ALL_SOURCES;
+		sources[3] = hat::core::ConfigBundleSourceFile{ "variables.csv", false, 0 };
+		checkPartsToParse(cache, sources, environments, { false, true, false, false });
+	}
+	SECTION("optional config file added") {
+		auto sources = ALL_SOURCES;
+		sources.insert(sources.begin() + 4, hat::core::ConfigBundleSourceFile{ "variables_1.csv", true, 8 });
+		auto const dependencies = hat::core::calculateConfigPartsDependencies(sources, INPUT_SEQUENCES_CONFIGS_COUNT, VARIABLES_MANAGERS_CONFIGS_COUNT + 1, IMAGES_CONFIGS_COUNT);
+		auto const partsToParse = cache.getConfigPartsToParse(dependencies);
+		CHECK_FALSE(partsToParse.m_commands);
+		CHECK(partsToParse.m_variables);
+		CHECK_FALSE(cache.shouldParseImages(dependencies, environments));
+		CHECK_FALSE(partsToParse.m_layout);
+	}
+}
+
+TEST_CASE("Config parts invalidation after loading the configs bundle", "[configs_reload_cache]")
+{
+	auto const environments = hat::core::CommandsInfoContainer::EnvsContainer{ "ENV0", "ENV1" };
+	auto const commandsConfig = hat::core::CommandsInfoContainer::parseConfigFile(hat::core::StringRef(hat::core::ConfigFilesKeywords::mandatoryCellsNamesInCommandsCSV() + "ENV0\tENV1\n"), hotkeysBuilder);
+	auto const bundle = hat::core::ConfigBundleContents{ commandsConfig, hat::core::ImageResourcesInfosContainer{ environments }, hat::core::LayoutUserInformation::parseConfigFile(hat::core::StringRef("page:main page\n")) };
+	auto cache = hat::core::ConfigsReloadCache{};
+	cache.storeConfigBundle(calculateDependencies(ALL_SOURCES), bundle);
+
+	checkPartsToParse(cache, ALL_SOURCES, environments, { false, false, false, false });
+	checkPartsToParse(cache, withChangedSource(4), environments, { false, false, true, false });
+	checkPartsToParse(cache, withChangedSource(6), environments, { false, false, false, true });
+	// The bundle does not contain the commands without the variables, so they are parsed again
+	checkPartsToParse(cache, withChangedSource(3), environments, { true, true, false, false });
+}
@@ -4,7 +4,9 @@
 // See LICENSE.txt for the licence information.
 
 #include "../hat-core/commands_data_extraction.hpp"
+#include "../hat-core/config_file_reader.hpp"
 #include "commands_parsing_testing_utils.hpp"
+#include <memory>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -83,6 +85,75 @@ TEST_CASE("csv row parser tests", "[csv]")
 	REQUIRE_THROWS(hat::core::ParsedCsvRow::parseDataRowString(incorrectRowString3)); //todo: add exception checker here (to make sure that the correct exception is thrown)
 }
 
+TEST_CASE("row splitting into cell references", "[csv]")
+{
+	struct CellInfo
+	{
+		std::string value;
+		size_t index;
+		bool moreData;
+		bool pointsInsideTheRow;
+	};
+	auto splitRow = [](std::string const & row) {
+		auto result = std::vector<CellInfo>{};
+		auto collector = [&](hat::core::StringRef const & cell, size_t index, bool moreData) -> bool {
+			auto const insideRow = (cell.data() >= row.data()) && (cell.data() + cell.size() <= row.data() + row.size());
+			result.push_back(CellInfo{ std::string(cell), index, moreData, insideRow });
+			return true;
+		};
+		auto const acceptedCellsCount = hat::core::splitTheRow(row, '\t', collector);
+		REQUIRE(acceptedCellsCount == result.size());
+		return result;
+	};
+
+	REQUIRE(splitRow("").size() == 0);
+
+	auto const singleCell = splitRow("abc");
+	REQUIRE(singleCell.size() == 1);
+	REQUIRE(singleCell[0].value == "abc");
+	REQUIRE_FALSE(singleCell[0].moreData);
+
+	// Trailing delimiter does not produce an empty trailing cell, but the empty cells in the middle are preserved:
+	auto const cells = splitRow("a\t\tbc\t");
+	REQUIRE(cells.size() == 3);
+	REQUIRE(cells[0].value == "a");
+	REQUIRE(cells[1].value == "");
+	REQUIRE(cells[2].value == "bc");
+	for (size_t i = 0; i < cells.size(); ++i) {
+		REQUIRE(cells[i].index == i);
+		REQUIRE(cells[i].moreData);
+		REQUIRE(cells[i].pointsInsideTheRow);
+	}
+
+	auto const lastCellWithoutDelimiter = splitRow("a\tb");
+	REQUIRE(lastCellWithoutDelimiter.size() == 2);
+	REQUIRE(lastCellWithoutDelimiter[0].moreData);
+	REQUIRE_FALSE(lastCellWithoutDelimiter[1].moreData);
+
+	REQUIRE(hat::core::splitTheRow("x,,y", ',') == std::vector<std::string>({ "x", "", "y" }));
+}
+
+TEST_CASE("in-place config lines reading", "[csv]")
+{
+	auto readAllLines = [](std::string const & contents) {
+		auto result = std::vector<std::string>{};
+		hat::core::BufferLinesReader reader(contents);
+		auto line = hat::core::StringRef{};
+		while (reader.getLine(line)) {
+			REQUIRE(line.data() >= contents.data());
+			REQUIRE(line.data() + line.size() <= contents.data() + contents.size());
+			result.push_back(std::string(line));
+		}
+		return result;
+	};
+
+	REQUIRE(readAllLines("").size() == 0);
+	REQUIRE(readAllLines("\n") == std::vector<std::string>({ "" }));
+	REQUIRE(readAllLines("a\nb") == std::vector<std::string>({ "a", "b" }));
+	REQUIRE(readAllLines("a\n\nb\n") == std::vector<std::string>({ "a", "", "b" }));
+	REQUIRE(readAllLines("a\r\nb\r\n\r\nc\r") == std::vector<std::string>({ "a", "b", "", "c" }));
+}
+
 SCENARIO("csv data presentation tests", "[csv]")
 {
 	using hat::core::CommandID;
@@ -222,6 +293,13 @@ TEST_CASE("Commands config parsing", "[csv]")
 	referenceObject.pushDataRow(hat::core::ParsedCsvRow({ "run"s, "debugger"s, "run"s, "test_desc"s, "{F5}"s, "{F6}"s, "{F7}"s }));
 	referenceObject.pushDataRow(hat::core::ParsedCsvRow({ "debug"s, "debugger"s, "debug"s, "test_desc"s, "{F11}"s, "{F12}"s }));
 	REQUIRE(referenceObject == testObject);
+
+	// The notes are displayed on the client, so they should be valid UTF-8 texts:
+	using Catch::Matchers::Contains;
+	std::string invalidNoteConfigData{ hat::core::ConfigFilesKeywords::mandatoryCellsNamesInCommandsCSV() + "ENV1"
+		"\nrun\tdebugger\trun\ttest_desc\t{F5}"
+		"\ndebug\tdebugger\tdebug \xFF\ttest_desc\t{F11}" };
+	REQUIRE_THROWS_WITH(hat::test::simulateParseConfigFileCall(invalidNoteConfigData), Contains("at line 3"));
 }
 
 SCENARIO("Equivalence of commands_config and input sequences files", "[csv_commands vs input sequences]")
@@ -412,3 +490,102 @@ TEST_CASE("Misspelled environment identifier in input sequences configuration fi
 	testRunner("ENV0,env1", "ENV0,ENV1");
 	testRunner("env1,ENV0", "ENV0,ENV1");
 }
+
+TEST_CASE("Empty environment cells share the disabled input object", "[csv]")
+{
+	auto builderCalls = std::vector<std::string>{};
+	auto const hotkeysBuilder = [&builderCalls](std::string const & param, hat::core::CommandID const &, size_t) {
+		builderCalls.push_back(param);
+		return std::make_shared<hat::core::SimpleHotkeyCombination>(param);
+	};
+	auto const config = hat::core::ConfigFilesKeywords::mandatoryCellsNamesInCommandsCSV() + "ENV0\tENV1\tENV2\n"
+		"first\tgroup\tfirst note\tfirst description\t\t{F5}\n" // ENV0 is empty and ENV2 is missing
+		"second\tgroup\tsecond note\tsecond description\n"s;
+	auto const commandsConfig = hat::core::CommandsInfoContainer::parseConfigFile(hat::core::StringRef(config), hotkeysBuilder);
+	REQUIRE(builderCalls == std::vector<std::string>{ "{F5}" }); // the input objects are created only for the defined cells
+
+	auto const & disabledInput = hat::core::InputsForEnvironments::getDisabledInput();
+	REQUIRE_FALSE(disabledInput->enabled);
+	auto const & first = commandsConfig.getCommandPrefs(hat::core::CommandID{ "first"s }).hotkeysForEnvironments;
+	auto const & second = commandsConfig.getCommandPrefs(hat::core::CommandID{ "second"s }).hotkeysForEnvironments;
+	REQUIRE(first.size() == 3);
+	REQUIRE(second.size() == 3);
+	REQUIRE(first[0] == disabledInput);
+	REQUIRE(first[1]->enabled);
+	REQUIRE(first[1]->m_value == "{F5}");
+	REQUIRE(first[2] == disabledInput);
+	for (size_t i = 0; i < second.size(); ++i) {
+		REQUIRE(second[i] == disabledInput);
+	}
+}
+
+TEST_CASE("Enabled commands for the environments", "[csv]")
+{
+	auto const hotkeysBuilder = [](std::string const & param, hat::core::CommandID const &, size_t) {
+		return std::make_shared<hat::core::SimpleHotkeyCombination>(param);
+	};
+	auto const config = hat::core::ConfigFilesKeywords::mandatoryCellsNamesInCommandsCSV() + "ENV0\tENV1\n"
+		"both\tgroup\tnote\tdescription\t{F5}\t{F6}\n"
+		"first\tgroup\tnote\tdescription\t{F7}\n"
+		"second\tgroup\tnote\tdescription\t\t{F8}\n"s;
+	auto commandsConfig = hat::core::CommandsInfoContainer::parseConfigFile(hat::core::StringRef(config), hotkeysBuilder);
+	commandsConfig.consumeInputSequencesConfigFile(hat::core::StringRef(hat::core::ConfigFilesKeywords::simpleTypingSeqCommand() + "\ttyping\tgroup\tnote\tdescription\tENV1\ttext\n"), hotkeysBuilder, hotkeysBuilder, hotkeysBuilder, hotkeysBuilder);
+
+	auto const isEnabled = [&commandsConfig](std::string const & commandID, size_t environmentIndex) {
+		auto const commandIndex = commandsConfig.findCommandIndex(hat::core::CommandID{ commandID });
+		REQUIRE(commandIndex.first);
+		return commandsConfig.isCommandEnabled(commandIndex.second, environmentIndex);
+	};
+	REQUIRE(isEnabled("both", 0));
+	REQUIRE(isEnabled("both", 1));
+	REQUIRE(isEnabled("first", 0));
+	REQUIRE_FALSE(isEnabled("first", 1));
+	REQUIRE_FALSE(isEnabled("second", 0));
+	REQUIRE(isEnabled("second", 1));
+	REQUIRE_FALSE(isEnabled("typing", 0));
+	REQUIRE(isEnabled("typing", 1));
+	REQUIRE_FALSE(isEnabled("both", 2)); // there is no such environment
+	REQUIRE_FALSE(commandsConfig.findCommandIndex(hat::core::CommandID{ "unknown"s }).first);
+}
+
+TEST_CASE("Text typing rows in input sequences configuration file", "[csv]")
+{
+	std::string const csvHeader{ hat::core::ConfigFilesKeywords::mandatoryCellsNamesInCommandsCSV() + "ENV0\tENV1"s };
+	auto const rowBeginning = hat::core::ConfigFilesKeywords::textTypingCommand() + "\tsnippet\tgroup\tnote\tdescription\t"s;
+
+	// The characters are typed as they are, so the keys description syntax is not interpreted:
+	auto const commandsConfig = hat::test::simulateSetOfCommandConfigFiles(csvHeader, { rowBeginning + "ENV1\t{F5}+^% caf\xC3\xA9 \xE2\x82\xAC\xF0\x9F\x98\x80\n"s });
+	auto const & inputs = commandsConfig.getCommandPrefs(hat::core::CommandID{ "snippet"s }).hotkeysForEnvironments;
+	REQUIRE_FALSE(inputs[0]->enabled);
+	auto const textTyping = std::dynamic_pointer_cast<hat::core::SimpleTextTyping const>(inputs[1]);
+	REQUIRE(textTyping);
+	REQUIRE(textTyping->enabled);
+	REQUIRE(textTyping->m_characters == U"{F5}+^% caf\u00E9 \u20AC\U0001F600"s);
+
+	// The texts are compared by their values:
+	REQUIRE(commandsConfig == hat::test::simulateSetOfCommandConfigFiles(csvHeader, { rowBeginning + "ENV1\t{F5}+^% caf\xC3\xA9 \xE2\x82\xAC\xF0\x9F\x98\x80\n"s }));
+	REQUIRE_FALSE(commandsConfig == hat::test::simulateSetOfCommandConfigFiles(csvHeader, { rowBeginning + "ENV1\t{F5}+^% cafe\n"s }));
+	REQUIRE_FALSE(commandsConfig == hat::test::simulateSetOfCommandConfigFiles(csvHeader, { hat::core::ConfigFilesKeywords::simpleTypingSeqCommand() + "\tsnippet\tgroup\tnote\tdescription\tENV1\t{F5}+^% caf\xC3\xA9 \xE2\x82\xAC\xF0\x9F\x98\x80\n"s }));
+
+	// The invalid UTF-8 texts are reported during the loading:
+	REQUIRE_THROWS_WITH(hat::test::simulateSetOfCommandConfigFiles(csvHeader, { rowBeginning + "*\tcaf\xC3\n"s }), Catch::Matchers::Contains("Invalid UTF-8 text"));
+}
+
+TEST_CASE("Aggregated commands keep the commands they reference alive", "[csv]")
+{
+	auto aggregatedCommand = std::shared_ptr<hat::core::AbstractSimulatedUserInput>{};
+	auto referencedCommand = std::weak_ptr<hat::core::AbstractSimulatedUserInput>{};
+	{
+		auto const commandsConfig = hat::test::simulateSetOfCommandConfigFiles(hat::core::ConfigFilesKeywords::mandatoryCellsNamesInCommandsCSV() + "ENV0\n"
+			"first\tgroup\tnote\tdescription\t{F5}\n"s,
+			{ hat::core::ConfigFilesKeywords::aggregatedSetOfCommands() + "\tsequence\tgroup\tnote\tdescription\t*\tfirst,first\n"s });
+		aggregatedCommand = commandsConfig.getCommandPrefs(hat::core::CommandID{ "sequence"s }).hotkeysForEnvironments[0];
+		referencedCommand = commandsConfig.getCommandPrefs(hat::core::CommandID{ "first"s }).hotkeysForEnvironments[0];
+	}
+	// The commands config is destroyed here (just like it happens, when the configs are reloaded while the command is waiting for the execution):
+	REQUIRE_FALSE(referencedCommand.expired());
+	auto const sequence = std::dynamic_pointer_cast<hat::core::InputSequencesCollection const>(aggregatedCommand);
+	REQUIRE(sequence);
+	REQUIRE(sequence->getTimeline().m_events.size() == 2);
+	REQUIRE(sequence->getTimeline().m_events[0].m_input == referencedCommand.lock());
+}
@@ -0,0 +1,134 @@
+// This source file is part of the 'hat' open source project.
+// Copyright (c) 2016, Yuriy Vosel.
+// Licensed under Boost Software License.
+// See LICENSE.txt for the licence information.
+
+#include "../hat-core/input_events_recorder.hpp"
+#include "../external_dependencies/Catch/single_include/catch.hpp"
+#include <chrono>
+#include <vector>
+
+namespace {
+	typedef hat::core::RecordedInputEvent::Type EventType;
+
+	std::vector<int64_t> getValues(std::vector<hat::core::RecordedInputEvent> const & events)
+	{
+		auto result = std::vector<int64_t>{};
+		for (auto const & event : events) {
+			result.push_back(event.m_value);
+		}
+		return result;
+	}
+}
+
+TEST_CASE("Input events recording into the ring buffer", "[input_events_recorder]")
+{
+	REQUIRE_THROWS(hat::core::InputEventsRecorder{ 0 });
+
+	hat::core::InputEventsRecorder recorder{ 3 };
+	REQUIRE(recorder.getCapacity() == 3);
+	REQUIRE(recorder.getEvents().empty());
+
+	auto const beforeRecording = std::chrono::steady_clock::now();
+	recorder.record(EventType::KEY_PRESS, 1);
+	recorder.record(EventType::KEY_RELEASE, 2);
+	REQUIRE(recorder.getRecordedCount() == 2);
+	auto const events = recorder.getEvents();
+	REQUIRE(getValues(events) == (std::vector<int64_t>{ 1, 2 }));
+	REQUIRE(events[0].m_type == EventType::KEY_PRESS);
+	REQUIRE(events[1].m_type == EventType::KEY_RELEASE);
+	REQUIRE(events[0].m_time >= beforeRecording);
+	REQUIRE(events[1].m_time >= events[0].m_time);
+
+	// The oldest events are overwritten, when the buffer is full:
+	recorder.record(EventType::KEY_PRESS, 3);
+	REQUIRE(getValues(recorder.getEvents()) == (std::vector<int64_t>{ 1, 2, 3 }));
+	recorder.record(EventType::KEY_PRESS, 4);
+	recorder.record(EventType::KEY_PRESS, 5);
+	REQUIRE(getValues(recorder.getEvents()) == (std::vector<int64_t>{ 3, 4, 5 }));
+	recorder.record(EventType::KEY_PRESS, 6);
+	REQUIRE(getValues(recorder.getEvents()) == (std::vector<int64_t>{ 4, 5, 6 }));
+	REQUIRE(recorder.getRecordedCount() == 6);
+}
+
+TEST_CASE("Statistics of the recorded commands", "[input_events_recorder]")
+{
+	using std::chrono::milliseconds;
+	auto const start = std::chrono::steady_clock::time_point{};
+	auto const event = [start](EventType type, int64_t value, int timeInMs) {
+		return hat::core::RecordedInputEvent{ type, value, start + milliseconds{ timeInMs } };
+	};
+
+	REQUIRE(hat::core::calculateRecordedCommandsStatistics({}).m_commandsCount == 0);
+
+	auto const statistics = hat::core::calculateRecordedCommandsStatistics({
+		event(EventType::COMMAND_FINISHED, 0, 0), // the rest of the command, which was overwritten in the ring buffer
+		event(EventType::COMMAND_REQUESTED, 1, 10),
+		event(EventType::COMMAND_REQUESTED, 2, 11), // requested while the first one is executed
+		event(EventType::COMMAND_STARTED, 1, 12),
+		event(EventType::SLEEP, 5000, 12), // the sleeps are not the input events
+		event(EventType::KEY_PRESS, 65, 17),
+		event(EventType::KEY_RELEASE, 65, 18),
+		event(EventType::COMMAND_FINISHED, 1, 20),
+		event(EventType::COMMAND_STARTED, 2, 20),
+		event(EventType::TEXT_CHARACTER, 97, 21),
+		event(EventType::COMMAND_FINISHED, 2, 22),
+		event(EventType::COMMAND_REQUESTED, 3, 30), // the command without the input events
+		event(EventType::COMMAND_STARTED, 3, 31),
+		event(EventType::SLEEP, 1000, 31),
+		event(EventType::COMMAND_FINISHED, 3, 32),
+		event(EventType::COMMAND_REQUESTED, 4, 40), // the command, which was not executed (the queue was full)
+		event(EventType::COMMAND_REQUESTED, 5, 41), // the command, which is still executed
+		event(EventType::COMMAND_STARTED, 5, 42),
+		event(EventType::MOUSE_CLICK, 0, 43) });
+	REQUIRE(statistics.m_commandsCount == 3);
+	REQUIRE(statistics.m_inputEventsCount == 3);
+	REQUIRE(statistics.m_latenciesCount == 2);
+	REQUIRE(statistics.m_minLatency == milliseconds{ 7 });
+	REQUIRE(statistics.m_maxLatency == milliseconds{ 10 });
+	REQUIRE(statistics.m_totalLatency == milliseconds{ 17 });
+	REQUIRE(statistics.m_totalExecutionTime == milliseconds{ 11 });
+}
+
+TEST_CASE("Statistics of the recorded commands are updated during the recording", "[input_events_recorder]")
+{
+	using std::chrono::milliseconds;
+	auto const start = std::chrono::steady_clock::time_point{};
+	auto const event = [start](EventType type, int64_t value, int timeInMs) {
+		return hat::core::RecordedInputEvent{ type, value, start + milliseconds{ timeInMs } };
+	};
+
+	hat::core::InputEventsRecorder recorder{ 2 };
+	REQUIRE(recorder.getStatistics().m_commandsCount == 0);
+	recorder.record(event(EventType::COMMAND_REQUESTED, 1, 0));
+	recorder.record(event(EventType::COMMAND_STARTED, 1, 1));
+	recorder.record(event(EventType::KEY_PRESS, 65, 3));
+	recorder.record(event(EventType::KEY_RELEASE, 65, 4));
+	recorder.record(event(EventType::COMMAND_FINISHED, 1, 5));
+	// The events of the command are overwritten in the buffer, but they are still counted:
+	auto statistics = recorder.getStatistics();
+	REQUIRE(statistics.m_commandsCount == 1);
+	REQUIRE(statistics.m_inputEventsCount == 2);
+	REQUIRE(statistics.m_latenciesCount == 1);
+	REQUIRE(statistics.m_minLatency == milliseconds{ 3 });
+	REQUIRE(statistics.m_totalExecutionTime == milliseconds{ 4 });
+
+	// The slot of the request 2 is reused by the request 4, so the command 2 is not counted:
+	recorder.record(event(EventType::COMMAND_REQUESTED, 2, 10));
+	recorder.record(event(EventType::COMMAND_REQUESTED, 3, 11));
+	recorder.record(event(EventType::COMMAND_REQUESTED, 4, 12));
+	recorder.record(event(EventType::COMMAND_STARTED, 2, 13));
+	recorder.record(event(EventType::MOUSE_CLICK, 0, 14));
+	recorder.record(event(EventType::COMMAND_FINISHED, 2, 15));
+	recorder.record(event(EventType::COMMAND_STARTED, 3, 15));
+	recorder.record(event(EventType::TEXT_CHARACTER, 97, 17));
+	recorder.record(event(EventType::COMMAND_FINISHED, 3, 18));
+	statistics = recorder.getStatistics();
+	REQUIRE(statistics.m_commandsCount == 2);
+	REQUIRE(statistics.m_inputEventsCount == 3);
+	REQUIRE(statistics.m_latenciesCount == 2);
+	REQUIRE(statistics.m_minLatency == milliseconds{ 3 });
+	REQUIRE(statistics.m_maxLatency == milliseconds{ 6 });
+	REQUIRE(statistics.m_totalExecutionTime == milliseconds{ 7 });
+	REQUIRE(recorder.getRecordedCount() == 14);
+}
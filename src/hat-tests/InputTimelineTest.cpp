@@ -0,0 +1,115 @@
+// This source file is part of the 'hat' open source project.
+// Copyright (c) 2016, Yuriy Vosel.
+// Licensed under Boost Software License.
+// See LICENSE.txt for the licence information.
+
+#include "../hat-core/commands_data_extraction.hpp"
+#include "../external_dependencies/Catch/single_include/catch.hpp"
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+	// The fake clock: the time moves only when the inputs are executed and when the sleeps are done.
+	struct FakeClock
+	{
+		std::chrono::steady_clock::time_point m_now{};
+		std::chrono::milliseconds m_sleepLateness{ 0 };
+		std::vector<std::chrono::steady_clock::time_point> m_deadlines;
+	};
+
+	// The input, which records the moments of its executions.
+	struct RecordingInput : public hat::core::SimpleHotkeyCombination
+	{
+		FakeClock & m_clock;
+		std::chrono::milliseconds const m_duration;
+		std::vector<std::chrono::steady_clock::time_point> m_executionTimes;
+		RecordingInput(std::string const & value, FakeClock & clock, std::chrono::milliseconds duration, bool enable = true)
+			: hat::core::SimpleHotkeyCombination(value, enable), m_clock(clock), m_duration(duration) {};
+		void execute() override
+		{
+			m_executionTimes.push_back(m_clock.m_now);
+			m_clock.m_now += m_duration;
+		};
+	};
+
+	hat::core::InputTimelineReplayStatistics replay(hat::core::InputTimeline const & timeline, std::chrono::milliseconds delayBetweenInputs, FakeClock & clock)
+	{
+		return hat::core::replayInputTimeline(timeline, delayBetweenInputs,
+			[&clock]() { return clock.m_now; },
+			[&clock](std::chrono::steady_clock::time_point const & deadline) {
+				clock.m_deadlines.push_back(deadline);
+				clock.m_now = deadline + clock.m_sleepLateness;
+			});
+	}
+}
+
+TEST_CASE("Compilation of the sequences into the timelines", "[input_timeline]")
+{
+	using std::chrono::milliseconds;
+	FakeClock clock;
+	auto const first = std::make_shared<RecordingInput>("first", clock, milliseconds{ 5 });
+	auto const second = std::make_shared<RecordingInput>("second", clock, milliseconds{ 5 });
+	auto const disabled = std::make_shared<RecordingInput>("disabled", clock, milliseconds{ 5 }, false);
+	auto const sleep100 = std::make_shared<hat::core::SimpleSleepOperation>("100", 100, true);
+	auto const sleep20 = std::make_shared<hat::core::SimpleSleepOperation>("20", 20, true);
+	auto const disabledSleep = std::make_shared<hat::core::SimpleSleepOperation>("1000", 1000, false);
+
+	auto const nested = std::make_shared<hat::core::InputSequencesCollection>(hat::core::InputSequencesCollection::CommandsSequence{ sleep20, second, sleep100 }, "nested");
+	REQUIRE(nested->getTimeline().m_events.size() == 1);
+	REQUIRE(nested->getTimeline().m_events[0].m_delayBefore == milliseconds{ 20 });
+	REQUIRE(nested->getTimeline().m_trailingDelay == milliseconds{ 100 });
+
+	// The nested collections are flattened, the sleeps are merged into the delays, the disabled elements are skipped:
+	hat::core::InputSequencesCollection sequence({ first, sleep100, disabled, disabledSleep, sleep20, nested, first, sleep20 }, "sequence");
+	auto const & timeline = sequence.getTimeline();
+	REQUIRE(timeline.m_events.size() == 3);
+	REQUIRE(timeline.m_events[0].m_input == first);
+	REQUIRE(timeline.m_events[0].m_delayBefore == milliseconds{ 0 });
+	REQUIRE(timeline.m_events[1].m_input == second);
+	REQUIRE(timeline.m_events[1].m_delayBefore == milliseconds{ 140 });
+	REQUIRE(timeline.m_events[2].m_input == first);
+	REQUIRE(timeline.m_events[2].m_delayBefore == milliseconds{ 100 });
+	REQUIRE(timeline.m_trailingDelay == milliseconds{ 20 });
+
+	hat::core::InputSequencesCollection sleepsOnly({ sleep20, sleep100 }, "sleeps only");
+	REQUIRE(sleepsOnly.getTimeline().m_events.empty());
+	REQUIRE(sleepsOnly.getTimeline().m_trailingDelay == milliseconds{ 120 });
+}
+
+TEST_CASE("Replay of the timelines", "[input_timeline]")
+{
+	using std::chrono::milliseconds;
+	FakeClock clock;
+	auto const first = std::make_shared<RecordingInput>("first", clock, milliseconds{ 5 });
+	auto const second = std::make_shared<RecordingInput>("second", clock, milliseconds{ 7 });
+	auto const sleep100 = std::make_shared<hat::core::SimpleSleepOperation>("100", 100, true);
+	hat::core::InputSequencesCollection sequence({ first, second, sleep100, first, sleep100 }, "sequence");
+	auto const start = clock.m_now;
+
+	SECTION("the delays are counted from the end of the previous inputs") {
+		auto const statistics = replay(sequence.getTimeline(), milliseconds{ 0 }, clock);
+		REQUIRE(first->m_executionTimes == (std::vector<std::chrono::steady_clock::time_point>{ start, start + milliseconds{ 112 } }));
+		REQUIRE(second->m_executionTimes == (std::vector<std::chrono::steady_clock::time_point>{ start + milliseconds{ 5 } }));
+		REQUIRE(clock.m_deadlines == (std::vector<std::chrono::steady_clock::time_point>{ start + milliseconds{ 112 }, start + milliseconds{ 217 } }));
+		REQUIRE(statistics.m_delaysCount == 2);
+		REQUIRE(statistics.m_maxLateness.count() == 0);
+	}
+	SECTION("the delay between the inputs is added before each input, except the first one") {
+		auto const statistics = replay(sequence.getTimeline(), milliseconds{ 10 }, clock);
+		REQUIRE(first->m_executionTimes == (std::vector<std::chrono::steady_clock::time_point>{ start, start + milliseconds{ 132 } }));
+		REQUIRE(second->m_executionTimes == (std::vector<std::chrono::steady_clock::time_point>{ start + milliseconds{ 15 } }));
+		REQUIRE(clock.m_now == start + milliseconds{ 237 });
+		REQUIRE(statistics.m_delaysCount == 3);
+	}
+	SECTION("the lateness of the sleeps is not accumulated, and it is reported") {
+		clock.m_sleepLateness = milliseconds{ 2 };
+		auto const statistics = replay(sequence.getTimeline(), milliseconds{ 10 }, clock);
+		REQUIRE(second->m_executionTimes == (std::vector<std::chrono::steady_clock::time_point>{ start + milliseconds{ 17 } }));
+		REQUIRE(first->m_executionTimes.back() == start + milliseconds{ 136 });
+		REQUIRE(statistics.m_delaysCount == 3);
+		REQUIRE(statistics.m_maxLateness == milliseconds{ 2 });
+		REQUIRE(statistics.m_totalLateness == milliseconds{ 6 });
+	}
+}
@@ -0,0 +1,116 @@
+// This source file is part of the 'hat' open source project.
+// Copyright (c) 2016, Yuriy Vosel.
+// Licensed under Boost Software License.
+// See LICENSE.txt for the licence information.
+
+#include "../hat-core/utils.hpp"
+#include "../external_dependencies/Catch/single_include/catch.hpp"
+#include <chrono>
+#include <iostream>
+#include <random>
+
+using namespace std::string_literals;
+
+namespace {
+	// The straightforward byte-by-byte implementation, which the optimized one should match.
+	std::string referenceEscapeForJson(std::string const & stringToProcess)
+	{
+		hat::core::ensureValidUTF8(stringToProcess);
+		static char const HEX_DIGITS[] = "0123456789abcdef";
+		auto result = std::string{};
+		for (auto const current : stringToProcess) {
+			if ((current == '"') || (current == '\\')) {
+				result.push_back('\\');
+				result.push_back(current);
+			} else if (static_cast<unsigned char>(current) < 0x20) {
+				result.append("\\u00");
+				result.push_back(HEX_DIGITS[static_cast<unsigned char>(current) >> 4]);
+				result.push_back(HEX_DIGITS[static_cast<unsigned char>(current) & 0x0F]);
+			} else {
+				result.push_back(current);
+			}
+		}
+		return result;
+	}
+
+	std::string generateRandomText(std::mt19937 & generator, size_t length)
+	{
+		static std::string const pieces[] = { "a", "b", "Z", " ", "0", "\"", "\\", "\n", "\t", "\x01", "\xC3\xA9", "\xE2\x82\xAC", "\xF0\x9F\x98\x80" };
+		std::uniform_int_distribution<size_t> pieceDistribution(0, (sizeof(pieces) / sizeof(pieces[0])) - 1);
+		auto result = std::string{};
+		while (result.size() < length) {
+			result += pieces[pieceDistribution(generator)];
+		}
+		return result;
+	}
+}
+
+TEST_CASE("Escaping of the texts for json", "[json_escaping]")
+{
+	REQUIRE(hat::core::escapeRawUTF8_forJson(""s) == ""s);
+	REQUIRE(hat::core::escapeRawUTF8_forJson("plain text, which is longer than sixteen bytes"s) == "plain text, which is longer than sixteen bytes"s);
+	REQUIRE(hat::core::escapeRawUTF8_forJson("\"quoted\" \\ path"s) == "\\\"quoted\\\" \\\\ path"s);
+	REQUIRE(hat::core::escapeRawUTF8_forJson("\x1f\x7f"s) == "\\u001f\x7f"s);
+
+	// The special bytes are placed at all the positions around the boundaries of the 16-bytes chunks:
+	for (size_t length = 1; length <= 48; ++length) {
+		for (size_t position = 0; position < length; ++position) {
+			for (auto const & special : { "\""s, "\\"s, "\n"s, "\xE2\x82\xAC"s }) {
+				auto text = std::string(length, 'x');
+				text.replace(position, 1, special);
+				REQUIRE(hat::core::escapeRawUTF8_forJson(text) == referenceEscapeForJson(text));
+			}
+		}
+	}
+
+	std::mt19937 generator(12345);
+	for (size_t i = 0; i < 1000; ++i) {
+		auto const text = generateRandomText(generator, i % 100);
+		REQUIRE(hat::core::escapeRawUTF8_forJson(text) == referenceEscapeForJson(text));
+	}
+
+	// The invalid texts are reported the same way, wherever the broken character is:
+	for (auto const & invalidText : { "\xFF"s, "sixteen bytes...\x80"s, "text with the cut character \xE2\x82"s, "\xC3 missing continuation byte"s }) {
+		REQUIRE_THROWS(referenceEscapeForJson(invalidText));
+		std::string expectedError;
+		try {
+			hat::core::ensureValidUTF8(invalidText);
+		} catch (std::runtime_error const & error) {
+			expectedError = error.what();
+		}
+		REQUIRE_THROWS_WITH(hat::core::escapeRawUTF8_forJson(invalidText), expectedError);
+	}
+
+	// The runtime texts are not validated: the malformed characters are replaced (one replacement character for each byte, which does not start a valid character):
+	REQUIRE(hat::core::escapeRawUTF8_forJson_replacingInvalid("\xFF\\\"\xE2\x82 \xE2\x82\xAC \xF0\x9F"s) == "\xEF\xBF\xBD\\\\\\\"\xEF\xBF\xBD\xEF\xBF\xBD \xE2\x82\xAC \xEF\xBF\xBD\xEF\xBF\xBD"s);
+	REQUIRE(hat::core::escapeRawUTF8_forJson_replacingInvalid("sixteen bytes...\x80"s) == "sixteen bytes...\xEF\xBF\xBD"s);
+	for (size_t i = 0; i < 1000; ++i) {
+		auto const text = generateRandomText(generator, i % 100);
+		REQUIRE(hat::core::escapeRawUTF8_forJson_replacingInvalid(text) == referenceEscapeForJson(text));
+	}
+}
+
+// The microbenchmark is hidden, run it explicitly with the '[json_escaping_benchmark]' tag.
+TEST_CASE("Escaping of the texts for json - benchmark", "[.][json_escaping_benchmark]")
+{
+	std::mt19937 generator(12345);
+	auto const mostlyPlainText = std::string(200, 'x') + "\"" + std::string(200, 'y');
+	auto const mixedText = generateRandomText(generator, 400);
+	size_t const iterations = 100000;
+
+	for (auto const & text : { mostlyPlainText, mixedText }) {
+		auto const measure = [&text](std::string(*escapingFunction)(std::string const &)) {
+			size_t totalSize = 0;
+			auto const start = std::chrono::steady_clock::now();
+			for (size_t i = 0; i < iterations; ++i) {
+				totalSize += escapingFunction(text).size();
+			}
+			auto const duration = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+			REQUIRE(totalSize > 0);
+			return duration.count() / iterations;
+		};
+		auto const referenceTime = measure(referenceEscapeForJson);
+		auto const optimizedTime = measure(hat::core::escapeRawUTF8_forJson);
+		std::cout << "Escaping of " << text.size() << " bytes: " << referenceTime << " ns (byte by byte), " << optimizedTime << " ns (escapeRawUTF8_forJson)\n";
+	}
+}
@@ -137,6 +137,21 @@ TEST_CASE("simple layout config file parsing", "[layout_config]")
 	REQUIRE(test == referenceLayoutInfo);
 }
 
+TEST_CASE("validation of the captions texts in the layout config file", "[layout_config]")
+{
+	using Catch::Matchers::Contains;
+	auto const invalidUTF8 = "caption \xE2\x82"s; // the multi-byte character is cut off
+
+	std::stringstream invalidPageCaption("page:page1\ncell1\npage:" + invalidUTF8 + "\ncell2"s);
+	REQUIRE_THROWS_WITH(hat::core::LayoutUserInformation::parseConfigFile(invalidPageCaption), Contains("at line 3"));
+
+	std::stringstream invalidSelectorCaption("page:page1\ncell1\ncell2\noptionsSelectorPage:selector;" + invalidUTF8 + "\ncell2"s);
+	REQUIRE_THROWS_WITH(hat::core::LayoutUserInformation::parseConfigFile(invalidSelectorCaption), Contains("at line 4"));
+
+	std::stringstream validCaptions("page:\xE2\x82\xAC \"page\"\ncell1"s); // the texts are stored as-is (they are escaped for json only when the layout is resolved)
+	REQUIRE(hat::core::LayoutUserInformation::parseConfigFile(validCaptions).getLayoutPages()[0].get_note() == "\xE2\x82\xAC \"page\""s);
+}
+
 TEST_CASE("layout config file parsing 2", "[layout_config]") {
 	hat::test::LayoutConfigParsingVerificator tester;
 	tester.startNewPage("page caption");
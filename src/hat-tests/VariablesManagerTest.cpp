@@ -354,3 +354,24 @@ TEST_CASE("Preservation of the operations order") {
 		}
 	}
 }
+
+TEST_CASE("variables manager 'clear tail characters' operation removes the whole UTF-8 characters")
+{
+	auto const VARIABLE_ID = hat::core::VariableID{ hat::test::getUniqueIdString() };
+	size_t const OPERATION_INDEX_TO_USE = 3;
+	hat::core::VariablesManager variablesManager;
+	variablesManager.declareVariable(VARIABLE_ID);
+	variablesManager.setVariableInitialValue(VARIABLE_ID, "a\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80"); // "a", U+00E9, U+20AC, U+1F600
+	variablesManager.addOperationToExecuteOnCommand(OPERATION_INDEX_TO_USE, std::make_shared<hat::core::ClearTailCharacters>(VARIABLE_ID, 1));
+
+	variablesManager.executeCommandAndGetChangedVariablesList(OPERATION_INDEX_TO_USE);
+	REQUIRE(variablesManager.getValue(VARIABLE_ID) == "a\xC3\xA9\xE2\x82\xAC");
+	variablesManager.executeCommandAndGetChangedVariablesList(OPERATION_INDEX_TO_USE);
+	REQUIRE(variablesManager.getValue(VARIABLE_ID) == "a\xC3\xA9");
+	variablesManager.executeCommandAndGetChangedVariablesList(OPERATION_INDEX_TO_USE);
+	REQUIRE(variablesManager.getValue(VARIABLE_ID) == "a");
+	variablesManager.executeCommandAndGetChangedVariablesList(OPERATION_INDEX_TO_USE);
+	REQUIRE(variablesManager.getValue(VARIABLE_ID) == "");
+	variablesManager.executeCommandAndGetChangedVariablesList(OPERATION_INDEX_TO_USE);
+	REQUIRE(variablesManager.getValue(VARIABLE_ID) == "");
+}
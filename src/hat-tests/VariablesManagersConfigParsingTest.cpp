@@ -394,4 +394,59 @@ TEST_CASE("Variables managers config parsing test")
 			checkEachConfigLineThrowsException(LIST_OF_INVALID_CONFIG_ENTRIES);
 		}
 	}
+	WHEN ("we try to add a text, which is not a valid UTF-8 string") {
+		auto const invalidText = std::string{"text with the cut character \xE2\x82"};
+		auto const LIST_OF_INVALID_CONFIG_ENTRIES = std::vector<std::string>{
+			  ht::set_initial_value(           VAR_0.id, ALL_ENVS, invalidText)
+			, ht::append_text      (COMMAND_0, VAR_0.id, ALL_ENVS, invalidText)
+			, ht::assign_text      (COMMAND_0, VAR_0.id, ALL_ENVS, invalidText)
+		};
+		THEN("exception is thrown") {
+			checkEachConfigLineThrowsException(LIST_OF_INVALID_CONFIG_ENTRIES);
+		}
+	}
+}
+
+TEST_CASE("Variables managers configs consumption in 2 steps (preparsing + storing)")
+{
+	namespace ht = hat::test;
+	auto const initialContainer = util_getInitialContainer();
+	auto const VAR_0 = ht::MyVariableTestDetails{ht::getUniqueIdString(), ht::getUniqueIdString()};
+
+	// The second file references the variable, which is declared in the first one:
+	auto const config_0 = ht::define_var(VAR_0.id) + "\n";
+	auto const config_1 = ht::assign_text(COMMAND_0, VAR_0, ALL_ENVS) + "\n";
+
+	// The preparsing does not depend on the other files (so the files could be preparsed in any order, or simultaneously):
+	auto const preparsed_1 = hat::core::CommandsInfoContainer::preparseVariablesManagersConfig(config_1, initialContainer.getEnvironments());
+	auto const preparsed_0 = hat::core::CommandsInfoContainer::preparseVariablesManagersConfig(config_0, initialContainer.getEnvironments());
+
+	// The result of storing the files in the right order should be the same as the result of the sequential consumption:
+	auto storedInOrder = initialContainer;
+	preparsed_0.storeTo(storedInOrder);
+	preparsed_1.storeTo(storedInOrder);
+	auto const consumedSequentially = ht::simulateUI_variablesOperationsConfigParsing(config_1,
+		ht::simulateUI_variablesOperationsConfigParsing(config_0, initialContainer));
+	for (size_t i = 0; i < initialContainer.getEnvironments().size(); ++i) {
+		REQUIRE(storedInOrder.getVariablesManagers_c().getManagerForEnv_c(i) == consumedSequentially.getVariablesManagers_c().getManagerForEnv_c(i));
+	}
+
+	// The references are checked only when the data is stored:
+	auto storedInWrongOrder = initialContainer;
+	REQUIRE_THROWS(preparsed_1.storeTo(storedInWrongOrder));
+
+	// The first error in the file is reported, even if it is detected during the storing step:
+	auto const unknownVariable = hat::core::VariableID{ht::getUniqueIdString()};
+	auto const configWithTwoErrors =
+		ht::assign_text(COMMAND_0, unknownVariable, ALL_ENVS, "text") + "\n" // Unknown variable (detected during the storing)
+		+ ht::define_var_unsafe("abc#$%") + "\n"; // Ill-formed variable id (detected during the preparsing)
+	auto const preparsedWithErrors = hat::core::CommandsInfoContainer::preparseVariablesManagersConfig(configWithTwoErrors, initialContainer.getEnvironments());
+	auto target = initialContainer;
+	auto errorMessage = std::string{};
+	try {
+		preparsedWithErrors.storeTo(target);
+	} catch (std::runtime_error & e) {
+		errorMessage = e.what();
+	}
+	REQUIRE(errorMessage.find("at line 1:") != std::string::npos);
 }
@@ -30,7 +30,29 @@ auto getMockSleepInputsProvider() {
 	};
 };
 
-core::CommandsInfoContainer simulateParseConfigFileCall(std::string const & configContents, std::function <core::CommandsInfoContainer (std::istream & srcStream)> objectProviderCallback)
+auto getMockTextTypingProvider() {
+	return [] (std::string const & param, core::CommandID const & commandID, size_t env_index) {
+		return std::make_shared<core::SimpleTextTyping>(param);
+	};
+};
+
+namespace {
+std::string convertToWindowsLineEndings(std::string const & source)
+{
+	std::string result;
+	for (auto currentChar : source) {
+		if (currentChar == '\n') {
+			result.push_back('\r');
+		}
+		result.push_back(currentChar);
+	}
+	return result;
+}
+}
+
+core::CommandsInfoContainer simulateParseConfigFileCall(std::string const & configContents,
+	std::function <core::CommandsInfoContainer (std::istream & srcStream)> objectProviderCallback,
+	std::function <core::CommandsInfoContainer (core::StringRef const & srcContents)> inMemoryObjectProviderCallback)
 {	
 	std::stringstream toParse(configContents);
 	auto simpleResult = objectProviderCallback(toParse);
@@ -38,6 +60,11 @@ core::CommandsInfoContainer simulateParseConfigFileCall(std::string const & conf
 	std::stringstream toParse_UTF8_BOM(UTF8_BOM + configContents);
 	auto utf8_result = objectProviderCallback(toParse_UTF8_BOM);
 	REQUIRE(utf8_result == simpleResult);
+
+	// The configs, which are already in memory (this is how the tool reads the mapped config files), should give the same result:
+	auto const contents_UTF8_BOM = UTF8_BOM + configContents;
+	REQUIRE(inMemoryObjectProviderCallback(contents_UTF8_BOM) == simpleResult);
+	REQUIRE(inMemoryObjectProviderCallback(convertToWindowsLineEndings(contents_UTF8_BOM)) == simpleResult);
 	return simpleResult;
 }
 
@@ -45,6 +72,8 @@ core::CommandsInfoContainer simulateParseConfigFileCall(std::string const & conf
 {
 	return simulateParseConfigFileCall(configContents, [](std::istream & dataToProcess) {
 		return core::CommandsInfoContainer::parseConfigFile(dataToProcess, getMockHotkeyCombinationProvider());
+	}, [](core::StringRef const & dataToProcess) {
+		return core::CommandsInfoContainer::parseConfigFile(dataToProcess, getMockHotkeyCombinationProvider());
 	});
 }
 
@@ -55,6 +84,10 @@ core::CommandsInfoContainer simulateUI_variablesOperationsConfigParsing(
 		core::CommandsInfoContainer result = sourceCommandsContainerObject;
 		result.consumeVariablesManagersConfig(dataToProcess);
 		return result;
+	}, [&](core::StringRef const & dataToProcess) {
+		core::CommandsInfoContainer result = sourceCommandsContainerObject;
+		result.consumeVariablesManagersConfig(dataToProcess);
+		return result;
 	});
 }
 
@@ -64,7 +97,11 @@ core::CommandsInfoContainer simulateAdditionalInputSequencesConfigParsing(
 {
 	return simulateParseConfigFileCall(configContents, [&](std::istream & dataToProcess) {
 		core::CommandsInfoContainer result = sourceCommandsContainerObject;
-		result.consumeInputSequencesConfigFile(dataToProcess, getMockHotkeyCombinationProvider(), getMockMouseInputsProvider(), getMockSleepInputsProvider());
+		result.consumeInputSequencesConfigFile(dataToProcess, getMockHotkeyCombinationProvider(), getMockMouseInputsProvider(), getMockSleepInputsProvider(), getMockTextTypingProvider());
+		return result;
+	}, [&](core::StringRef const & dataToProcess) {
+		core::CommandsInfoContainer result = sourceCommandsContainerObject;
+		result.consumeInputSequencesConfigFile(dataToProcess, getMockHotkeyCombinationProvider(), getMockMouseInputsProvider(), getMockSleepInputsProvider(), getMockTextTypingProvider());
 		return result;
 	});
 }
@@ -55,6 +55,9 @@ void LayoutConfigParsingVerificator::verifyConfigIsOK()
 		std::stringstream mystream2(configurationToReadAndTest_withBOM);
 		auto test_BOM = hat::core::LayoutUserInformation::parseConfigFile(mystream2);
 		REQUIRE(test_BOM == accumulatedConfig);
+		// The same config, which is already loaded into memory (this is how the tool reads the mapped config files):
+		auto test_inMemory = hat::core::LayoutUserInformation::parseConfigFile(hat::core::StringRef(configurationToReadAndTest_withBOM));
+		REQUIRE(test_inMemory == accumulatedConfig);
 	}
 }
 
@@ -0,0 +1,63 @@
+// This source file is part of the 'hat' open source project.
+// Copyright (c) 2016, Yuriy Vosel.
+// Licensed under Boost Software License.
+// See LICENSE.txt for the licence information.
+
+#include "commands_execution_thread.hpp"
+
+#include <exception>
+#include <iostream>
+
+namespace hat {
+namespace tool {
+
+CommandsExecutionThread::CommandsExecutionThread(size_t capacity, std::function<void(std::function<void()> const &)> const & completionsPoster)
+	: m_capacity(capacity), m_completionsPoster(completionsPoster)
+{
+	m_executionThread = std::thread([this]() {
+		while (true) {
+			auto task = Task{};
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_tasksAdded.wait(lock, [this]() { return m_shouldStop || !m_tasks.empty(); });
+				if (m_shouldStop) {
+					return;
+				}
+				task = std::move(m_tasks.front());
+				m_tasks.pop_front();
+			}
+			try {
+				task.first();
+			} catch (std::exception & e) {
+				std::cerr << "Error during the execution of the command: " << e.what() << "\n";
+			}
+			m_completionsPoster(task.second);
+		}
+	});
+}
+
+CommandsExecutionThread::~CommandsExecutionThread()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_shouldStop = true;
+	}
+	m_tasksAdded.notify_one();
+	m_executionThread.join();
+}
+
+bool CommandsExecutionThread::tryPush(std::function<void()> const & task, std::function<void()> const & onExecuted)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_tasks.size() >= m_capacity) {
+			return false;
+		}
+		m_tasks.emplace_back(task, onExecuted);
+	}
+	m_tasksAdded.notify_one();
+	return true;
+}
+
+} // namespace tool
+} // namespace hat
@@ -0,0 +1,49 @@
+// This source file is part of the 'hat' open source project.
+// Copyright (c) 2016, Yuriy Vosel.
+// Licensed under Boost Software License.
+// See LICENSE.txt for the licence information.
+
+#ifndef HAT_COMMANDS_EXECUTION_THREAD_HPP
+#define HAT_COMMANDS_EXECUTION_THREAD_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace hat {
+namespace tool {
+
+// Simulates the input of the commands on a separate thread, one command after another.
+// This way the thread, which serves the connections, is not blocked by the long input sequences (the sleeps, the slow horizontal scrolling, the system calls),
+// so the heartbeats, the clicks and the pages switches are processed while the input is simulated.
+// The onExecuted callback of the task is passed to the completionsPoster after the task is done (it should pass the callback to the thread, which serves the connections).
+// Note: one object is shared by all the connections, so the inputs requested from the different clients are never interleaved.
+// Note: the queue is bounded. If the commands are requested faster than they are executed, the new ones are rejected instead of piling up.
+class CommandsExecutionThread
+{
+	typedef std::pair<std::function<void()>, std::function<void()>> Task; // the task itself and its onExecuted callback
+
+	size_t const m_capacity;
+	std::function<void(std::function<void()> const &)> const m_completionsPoster;
+	std::mutex m_mutex;
+	std::condition_variable m_tasksAdded;
+	std::deque<Task> m_tasks;
+	bool m_shouldStop{ false };
+	std::thread m_executionThread;
+public:
+	CommandsExecutionThread(size_t capacity, std::function<void(std::function<void()> const &)> const & completionsPoster);
+	~CommandsExecutionThread(); // waits for the current task to finish. The tasks, which are still in the queue, are discarded.
+	CommandsExecutionThread(CommandsExecutionThread const &) = delete;
+	CommandsExecutionThread & operator = (CommandsExecutionThread const &) = delete;
+
+	// Returns false, if the queue is full (the task is discarded in this case).
+	bool tryPush(std::function<void()> const & task, std::function<void()> const & onExecuted);
+};
+
+} // namespace tool
+} // namespace hat
+
+#endif //HAT_COMMANDS_EXECUTION_THREAD_HPP
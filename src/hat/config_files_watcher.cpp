@@ -0,0 +1,135 @@
+// This source file is part of the 'hat' open source project.
+// Copyright (c) 2016, Yuriy Vosel.
+// Licensed under Boost Software License.
+// See LICENSE.txt for the licence information.
+
+#include "config_files_watcher.hpp"
+
+#ifdef HAT_CONFIG_FILES_WATCHING_SUPPORT
+
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+
+namespace hat {
+namespace tool {
+
+namespace {
+	typedef std::map<int, std::set<std::string>> WatchedFileNames; // watch descriptor of the directory -> names of the config files inside it
+
+	std::pair<std::string, std::string> splitToDirectoryAndFileName(std::string const & path)
+	{
+		auto const lastSeparatorPos = path.rfind('/');
+		if (lastSeparatorPos == std::string::npos) {
+			return { ".", path };
+		}
+		return { (lastSeparatorPos == 0) ? "/" : path.substr(0, lastSeparatorPos), path.substr(lastSeparatorPos + 1) };
+	}
+
+	std::runtime_error createSystemError(std::string const & message)
+	{
+		std::stringstream errorMessage;
+		errorMessage << message << " (" << std::strerror(errno) << ")";
+		return std::runtime_error(errorMessage.str());
+	}
+
+	// Reads all the pending events and returns true, if any of them is about the watched config files.
+	bool consumeInotifyEvents(int inotifyDescriptor, WatchedFileNames const & watchedFileNames)
+	{
+		alignas(inotify_event) char buffer[4096];
+		auto const bytesRead = read(inotifyDescriptor, buffer, sizeof(buffer));
+		if (bytesRead <= 0) {
+			return false;
+		}
+		bool result = false;
+		for (auto position = buffer; position < buffer + bytesRead; ) {
+			auto const & event = *reinterpret_cast<inotify_event const *>(position);
+			position += sizeof(inotify_event) + event.len;
+			if (event.mask & IN_Q_OVERFLOW) {
+				result = true; // some events were lost - have to assume, that the configs were changed
+				continue;
+			}
+			auto const filesInDirectory = watchedFileNames.find(event.wd);
+			if ((event.len > 0) && (filesInDirectory != watchedFileNames.end()) && (filesInDirectory->second.count(event.name) > 0)) {
+				result = true;
+			}
+		}
+		return result;
+	}
+}
+
+ConfigFilesWatcher::ConfigFilesWatcher(std::vector<std::string> const & configPaths, std::chrono::milliseconds debounceInterval, std::function<void()> onConfigsChanged)
+	: m_inotifyDescriptor(inotify_init1(IN_NONBLOCK | IN_CLOEXEC))
+{
+	if (m_inotifyDescriptor < 0) {
+		throw createSystemError("Could not initialize inotify for watching the config files");
+	}
+	if (pipe(m_stopPipe) != 0) {
+		close(m_inotifyDescriptor);
+		throw createSystemError("Could not create the pipe for stopping the config files watcher");
+	}
+
+	auto watchedFileNames = WatchedFileNames{};
+	for (auto const & configPath : configPaths) {
+		auto const directoryAndFileName = splitToDirectoryAndFileName(configPath);
+		auto const watchDescriptor = inotify_add_watch(m_inotifyDescriptor, directoryAndFileName.first.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE | IN_MOVED_FROM);
+		if (watchDescriptor < 0) {
+			auto const error = createSystemError("Could not start watching the directory '" + directoryAndFileName.first + "' of the config file '" + configPath + "'");
+			close(m_inotifyDescriptor);
+			close(m_stopPipe[0]);
+			close(m_stopPipe[1]);
+			throw error;
+		}
+		watchedFileNames[watchDescriptor].insert(directoryAndFileName.second);
+	}
+
+	m_watchingThread = std::thread([this, watchedFileNames, debounceInterval, onConfigsChanged]() {
+		pollfd descriptorsToPoll[] = { { m_inotifyDescriptor, POLLIN, 0 }, { m_stopPipe[0], POLLIN, 0 } };
+		bool changesPending = false;
+		while (true) {
+			auto const timeout = changesPending ? static_cast<int>(debounceInterval.count()) : -1;
+			auto const pollResult = poll(descriptorsToPoll, 2, timeout);
+			if (pollResult < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				return;
+			}
+			if (pollResult == 0) { // no new changes during the debounce interval
+				changesPending = false;
+				onConfigsChanged();
+				continue;
+			}
+			if (descriptorsToPoll[1].revents != 0) {
+				return;
+			}
+			if ((descriptorsToPoll[0].revents & POLLIN) && consumeInotifyEvents(m_inotifyDescriptor, watchedFileNames)) {
+				changesPending = true;
+			}
+		}
+	});
+}
+
+ConfigFilesWatcher::~ConfigFilesWatcher()
+{
+	char const stopSignal = 0;
+	if (write(m_stopPipe[1], &stopSignal, 1) != 1) {
+		m_watchingThread.detach(); // the descriptors are left open here, because the thread could still be using them
+		return;
+	}
+	m_watchingThread.join();
+	close(m_inotifyDescriptor);
+	close(m_stopPipe[0]);
+	close(m_stopPipe[1]);
+}
+
+} // namespace tool
+} // namespace hat
+
+#endif //HAT_CONFIG_FILES_WATCHING_SUPPORT
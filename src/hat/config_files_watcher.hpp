@@ -0,0 +1,40 @@
+// This source file is part of the 'hat' open source project.
+// Copyright (c) 2016, Yuriy Vosel.
+// Licensed under Boost Software License.
+// See LICENSE.txt for the licence information.
+
+#ifndef HAT_CONFIG_FILES_WATCHER_HPP
+#define HAT_CONFIG_FILES_WATCHER_HPP
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef HAT_CONFIG_FILES_WATCHING_SUPPORT
+namespace hat {
+namespace tool {
+
+// Watches the config files (through inotify) on a separate thread and calls the callback, when any of them is changed.
+// The changes are debounced: the callback is called only after there were no new changes during the debounceInterval
+// (the editors often save the files in several steps, and several files could be saved at once).
+// Note: the parent directories are watched instead of the files themselves, because a lot of editors replace the file with a new one on saving.
+// Note: the callback is called on the watcher's thread. The changes made while the callback is running are reported after it returns.
+class ConfigFilesWatcher
+{
+	int m_inotifyDescriptor;
+	int m_stopPipe[2];
+	std::thread m_watchingThread;
+public:
+	ConfigFilesWatcher(std::vector<std::string> const & configPaths, std::chrono::milliseconds debounceInterval, std::function<void()> onConfigsChanged);
+	~ConfigFilesWatcher();
+	ConfigFilesWatcher(ConfigFilesWatcher const &) = delete;
+	ConfigFilesWatcher & operator = (ConfigFilesWatcher const &) = delete;
+};
+
+} // namespace tool
+} // namespace hat
+
+#endif //HAT_CONFIG_FILES_WATCHING_SUPPORT
+#endif //HAT_CONFIG_FILES_WATCHER_HPP
@@ -4,35 +4,43 @@
 // See LICENSE.txt for the licence information.
 
 #include "engine.hpp"
+#include "../hat-core/config_file_reader.hpp"
+#include "../hat-core/config_bundle.hpp"
+#include "../hat-core/compiled_values_cache.hpp"
 
-#include <fstream>
 #include <sstream>
+#include <fstream>
 #include <iostream>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <exception>
+#include <algorithm>
+#include <iterator>
 #include "../external_dependencies/robot/Source/Keyboard.h"
 #include "../external_dependencies/robot/Source/Mouse.h"
 #include "../external_dependencies/robot/Source/Timer.h"
 
-#ifdef HAT_WINDOWS_SCANCODES_SUPPORT
-#include <windows.h>
-#endif
 namespace hat {
 namespace tool {
 void Engine::sleep(unsigned int millisec)
 {
 	ROBOT_NS::Timer::Sleep(millisec);
 }
-#ifdef HAT_WINDOWS_SCANCODES_SUPPORT
-extern bool SHOULD_USE_SCANCODES;
-#endif
 	Engine::Engine(hat::core::LayoutUserInformation const & layoutInfo,
-		hat::core::CommandsInfoContainer const & commandsConfig, hat::core::ImageResourcesInfosContainer const & imagesConfig, bool stickEnvToWindow, unsigned int keystrokes_delay) :
+		hat::core::CommandsInfoContainer const & commandsConfig, hat::core::ImageResourcesInfosContainer const & imagesConfig, bool stickEnvToWindow, unsigned int keystrokes_delay, std::shared_ptr<InputBackend> const & inputBackend) :
 		m_selectedEnvironment(0), isEnv_selected(false),
 		m_stickEnvToWindow(stickEnvToWindow),
 		m_keystrokes_delay(keystrokes_delay),
+		m_inputBackend(inputBackend),
 		m_layoutInfo(layoutInfo),
 		m_commandsConfig(commandsConfig),
-		m_imagesConfig(imagesConfig)
+		m_imagesConfig(imagesConfig),
+		m_resolvedLayout(std::make_shared<hat::core::ResolvedLayout const>(hat::core::ResolvedLayout::resolve(m_layoutInfo, m_commandsConfig)))
 	{
+		for (auto const & unknownID : m_resolvedLayout->getUnknownIDs()) {
+			std::cout << "WARNING: the layout config references the ID '" << unknownID << "', which is not defined for any of the environments.\n";
+		}
 		if (!shouldShowEnvironmentSelectionPage()) { // if there is only one environment, we don't need to select anything
 			setNewEnvironment(0);
 		}
@@ -67,7 +75,7 @@ extern bool SHOULD_USE_SCANCODES;
 	bool Engine::canSendTheCommmandForEnvironment() const
 	{
 		if (m_stickEnvToWindow) {
-			return ROBOT_NS::Window::GetActive().GetHandle() == m_stickInfo[m_selectedEnvironment];
+			return m_inputBackend->getActiveWindowHandle() == m_stickInfo[m_selectedEnvironment];
 		}
 		return true;
 	}
@@ -81,37 +89,88 @@ extern bool SHOULD_USE_SCANCODES;
 	void Engine::switchLayout_restoreToNormalLayout()
 	{
 		m_currentState = LayoutState::NORMAL;
-		m_currentNormalLayout.setStartLayoutPage(*m_lastTopPageSelected);
+		m_currentStartPageIndex = m_lastTopPageSelected;
 	}
 
 	void Engine::stickCurrentTopWindowToSelectedEnvironment()
 	{
-		m_stickInfo[m_selectedEnvironment] = ROBOT_NS::Window::GetActive().GetHandle();
+		m_stickInfo[m_selectedEnvironment] = m_inputBackend->getActiveWindowHandle();
 		m_currentState = LayoutState::NORMAL;
 	}
 
 	void Engine::executeCommandForCurrentlySelectedEnvironment(size_t commandIndex)
 	{
-		hat::core::Command commandToExecute = m_commandsConfig.m_commandsList[commandIndex];
+		auto const & commandToExecute = m_commandsConfig.m_commandsList[commandIndex];
+		auto const & hotkeyToExecute = commandToExecute.hotkeysForEnvironments[m_selectedEnvironment];
+		if (!hotkeyToExecute->enabled) {
+			return;
+		}
+		std::cout << "The command (id='" << commandToExecute.commandID.getValue()
+			<< "') is ready for execution. String representation of command to execute:\n\t" << hotkeyToExecute->m_value << "\n";
 
-		auto & hotkeyToExecute = commandToExecute.hotkeysForEnvironments[m_selectedEnvironment];
-		
-		if (hotkeyToExecute->enabled) {
-			std::cout << "The command (id='" << commandToExecute.commandID.getValue()
-				<< "') is ready for execution. String representation of command to execute:\n\t" << hotkeyToExecute->m_value << "\n";
-			hotkeyToExecute->execute();
-
-
-			// Do the variable operations and updating their values in UI.
-			auto & variablesManager = m_commandsConfig.getVariablesManagers().getManagerForEnv(m_selectedEnvironment);
-			auto changedVariables = variablesManager.executeCommandAndGetChangedVariablesList(commandIndex);
-			for (auto & updatedVariableID : changedVariables) {
-				auto & listOfElementsToRefresh = m_currentlyDisplayedVariables[updatedVariableID];
-				auto newValue = variablesManager.getValue(updatedVariableID);
-				for (auto & elementIDToRefresh : listOfElementsToRefresh) {
-					if (m_uiNotesUpdater) {
-						m_uiNotesUpdater(elementIDToRefresh, newValue);
-					}
+		auto const environmentIndex = m_selectedEnvironment;
+		auto const requestID = m_inputBackend->commandRequested();
+		auto const execution = [inputBackend = m_inputBackend, inputExecution = createInputExecution(hotkeyToExecute), requestID]() {
+			inputBackend->commandExecutionStarted(requestID);
+			inputExecution();
+			inputBackend->commandExecutionFinished(requestID);
+		};
+		if (!m_commandsExecutionScheduler) {
+			execution();
+			applyExecutedCommandToVariables(commandIndex, environmentIndex);
+			return;
+		}
+		auto const isScheduled = m_commandsExecutionScheduler(execution, [this, commandIndex, environmentIndex]() {
+			applyExecutedCommandToVariables(commandIndex, environmentIndex);
+		});
+		if (!isScheduled) {
+			std::cout << "The command (id='" << commandToExecute.commandID.getValue() << "') is dropped: too many commands are waiting for the execution.\n";
+		}
+	}
+
+	std::function<void()> Engine::createInputExecution(std::shared_ptr<hat::core::AbstractSimulatedUserInput> const & input) const
+	{
+		auto const sequence = std::dynamic_pointer_cast<hat::core::InputSequencesCollection const>(input);
+		if (!sequence) {
+			return [input]() { input->execute(); };
+		}
+		// The sequences are replayed by their timelines (compiled during the configs loading), so the keystrokes delay is honored between their inputs too.
+		auto const delayBetweenInputs = std::chrono::milliseconds{ m_keystrokes_delay };
+		auto const inputBackend = m_inputBackend;
+		return [sequence, delayBetweenInputs, inputBackend]() {
+			auto const statistics = hat::core::replayInputTimeline(sequence->getTimeline(), delayBetweenInputs, []() { return std::chrono::steady_clock::now(); },
+				[&inputBackend](std::chrono::steady_clock::time_point const & deadline) { inputBackend->sleepUntil(deadline); });
+			if (statistics.m_delaysCount > 0) {
+				auto const toMicroseconds = [](std::chrono::nanoseconds duration) { return std::chrono::duration_cast<std::chrono::microseconds>(duration).count(); };
+				std::cout << "The sequence is executed. The lateness of its " << statistics.m_delaysCount << " delay(s): max " << toMicroseconds(statistics.m_maxLateness)
+					<< " us, average " << toMicroseconds(statistics.m_totalLateness / statistics.m_delaysCount) << " us.\n";
+			}
+		};
+	}
+
+	void Engine::applyExecutedCommandToVariables(size_t commandIndex, size_t environmentIndex)
+	{
+		// Do the variable operations and updating their values in UI.
+		auto & variablesManager = m_commandsConfig.getVariablesManagers().getManagerForEnv(environmentIndex);
+		auto changedVariables = variablesManager.executeCommandAndGetChangedVariablesList(commandIndex);
+		if ((changedVariables.size() > 0) && (environmentIndex < m_precomputedNormalLayouts.size())) {
+			m_precomputedNormalLayouts[environmentIndex].reset(); // it displays the previous values of the variables now
+		}
+		if (environmentIndex != m_selectedEnvironment) {
+			return; // the environment was switched while the command was executed. Its layout is generated with the new values of the variables, when it is selected again.
+		}
+		for (auto & updatedVariableID : changedVariables) {
+			if (!m_currentNormalLayout) {
+				break;
+			}
+			auto const listOfElementsToRefresh = m_currentNormalLayout->m_displayedVariables.find(updatedVariableID);
+			if (listOfElementsToRefresh == m_currentNormalLayout->m_displayedVariables.end()) {
+				continue;
+			}
+			auto newValue = hat::core::escapeRawUTF8_forJson_replacingInvalid(variablesManager.getValue(updatedVariableID));
+			for (auto & elementIDToRefresh : listOfElementsToRefresh->second) {
+				if (m_uiNotesUpdater) {
+					m_uiNotesUpdater(elementIDToRefresh, newValue);
 				}
 			}
 		}
@@ -198,65 +257,134 @@ extern bool SHOULD_USE_SCANCODES;
 			return std::pair<bool, int> {is_verticalScroll, shouldFlipNumericValue ? -scrollAmount : scrollAmount};
 		}
 	}
-	Engine Engine::create(std::string const & commandsCSV, std::vector<std::string> const & inputSequencesConfigs, std::vector<std::string> const & variablesManagersSetupConfigs, std::string const & imageResourcesConfig, std::string const & imageId2CommandIdConfig, std::string const & layoutConfig, bool stickEnvToWindow, unsigned int keyboard_intervals, std::function<void(std::string const &, std::string const &)> loggingCallback)
+	namespace {
+		// Runs the task once for each index in [0, tasksCount) on a pool of worker threads (the calling thread is one of the workers).
+		// If some of the tasks throw, the exception from the task with the smallest index is rethrown after all the tasks are finished.
+		void runTasksInParallel(size_t tasksCount, std::function<void(size_t taskIndex)> const & task)
+		{
+			auto exceptions = std::vector<std::exception_ptr>(tasksCount);
+			std::atomic<size_t> nextTaskIndex{ 0 };
+			auto worker = [&]() {
+				for (size_t taskIndex = nextTaskIndex++; taskIndex < tasksCount; taskIndex = nextTaskIndex++) {
+					try {
+						task(taskIndex);
+					} catch (...) {
+						exceptions[taskIndex] = std::current_exception();
+					}
+				}
+			};
+			auto const workersCount = (std::min)(tasksCount, static_cast<size_t>((std::max)(1u, std::thread::hardware_concurrency())));
+			auto additionalWorkers = std::vector<std::thread>{};
+			for (size_t i = 1; i < workersCount; ++i) {
+				additionalWorkers.emplace_back(worker);
+			}
+			worker();
+			for (auto & additionalWorker : additionalWorkers) {
+				additionalWorker.join();
+			}
+			for (auto const & exception : exceptions) {
+				if (exception) {
+					std::rethrow_exception(exception);
+				}
+			}
+		}
+
+		// The key sequence compiled by the Robot library. Note: the keys are kept even if the compilation failed (the sequence is disabled in this case).
+		struct CompiledKeySequence
+		{
+			bool m_isValid;
+			ROBOT_NS::KeyList m_keys;
+		};
+
+		// The same key sequences (like "^S") are usually used by a lot of commands, and most of them are not changed between the configs reloads.
+		// That is why the compiled sequences are cached for the whole process lifetime.
+		hat::core::CompiledValuesCache<CompiledKeySequence> & getCompiledKeySequencesCache()
+		{
+			static hat::core::CompiledValuesCache<CompiledKeySequence> cache;
+			return cache;
+		}
+
+		// The compiled sequences are stored in the precompiled configs bundle (see core::SimpleHotkeyCombination::getCompiledData()): the validity flag, then the press flag and the key (4 bytes, little-endian) for each event.
+		// The keys are the platform-dependent codes, so the data starts with the platform tag. The data of another platform is not used (the sequence is compiled again).
+		std::string const & getCompiledKeySequencePlatformTag()
+		{
+#if defined(_WIN32)
+			static std::string const result{ "robot-windows:" };
+#elif defined(__APPLE__)
+			static std::string const result{ "robot-mac:" };
+#else
+			static std::string const result{ "robot-linux:" };
+#endif
+			return result;
+		}
+
+		std::string serializeCompiledKeySequence(CompiledKeySequence const & sequence)
+		{
+			auto result = getCompiledKeySequencePlatformTag();
+			result.reserve(result.size() + 1 + sequence.m_keys.size() * 5);
+			result.push_back(sequence.m_isValid ? 1 : 0);
+			for (auto const & keyEvent : sequence.m_keys) {
+				result.push_back(keyEvent.first ? 1 : 0);
+				auto const key = static_cast<uint32_t>(keyEvent.second);
+				for (size_t i = 0; i < 4; ++i) {
+					result.push_back(static_cast<char>((key >> (8 * i)) & 0xFF));
+				}
+			}
+			return result;
+		}
+
+		// Returns false, if the data is not a compiled sequence for this platform.
+		bool deserializeCompiledKeySequence(std::string const & data, CompiledKeySequence & target)
+		{
+			auto const & platformTag = getCompiledKeySequencePlatformTag();
+			if ((data.size() < platformTag.size() + 1) || (data.compare(0, platformTag.size(), platformTag) != 0) || ((data.size() - platformTag.size() - 1) % 5 != 0)) {
+				return false;
+			}
+			target.m_isValid = (data[platformTag.size()] != 0);
+			target.m_keys.clear();
+			for (size_t position = platformTag.size() + 1; position < data.size(); position += 5) {
+				uint32_t key = 0;
+				for (size_t i = 0; i < 4; ++i) {
+					key |= static_cast<uint32_t>(static_cast<unsigned char>(data[position + 1 + i])) << (8 * i);
+				}
+				target.m_keys.push_back(std::make_pair(data[position] != 0, static_cast<ROBOT_NS::Key>(key)));
+			}
+			return true;
+		}
+
+		void printCompiledKeySequencesCacheStatistics()
+		{
+			auto const & cache = getCompiledKeySequencesCache();
+			std::cout << "Compiled key sequences cache: " << cache.size() << " sequences, " << cache.getHitsCount() << " hits, " << cache.getMissesCount() << " misses\n";
+		}
+
+	}
+
+	Engine Engine::create(std::string const & commandsCSV, std::vector<std::string> const & inputSequencesConfigs, std::vector<std::string> const & variablesManagersSetupConfigs, std::string const & imageResourcesConfig, std::string const & imageId2CommandIdConfig, std::string const & layoutConfig, bool stickEnvToWindow, unsigned int keyboard_intervals, std::string const & configBundlePath, ConfigBundleMode configBundleMode, core::ConfigsReloadCache & reloadCache, bool precomputeEnvironmentLayouts, std::shared_ptr<InputBackend> const & inputBackend, std::function<void(std::string const &, std::string const &)> loggingCallback)
 	{
-		std::fstream csvStream(commandsCSV.c_str());
-		if (!csvStream.is_open()) {
+		core::MappedConfigFile commandsConfigFile(commandsCSV);
+		if (!commandsConfigFile.is_open()) {
 			throw std::runtime_error("Could not find or open the commands config file: " + commandsCSV);
 		}
 
-		loggingCallback("Reading main commands list", commandsCSV);
+		// The input objects send their input through the inputBackend (see InputBackend), so the way of the input simulation is chosen once for the whole tool.
 		class MyHotkeyCombination: public core::SimpleHotkeyCombination
 		{
-			ROBOT_NS::KeyList m_sequence;
+			std::shared_ptr<CompiledKeySequence const> m_sequence;
 			unsigned int m_keystrokes_delay;
-			//little helper function, which abstracts away the keyboard simulation part (which can be platform-dependant)
-			void simulateSingleKeyboardInputEvent(ROBOT_NS::Keyboard & keyboard, std::pair<bool, ROBOT_NS::Key> const & keyboardEvent) {
-#ifdef HAT_WINDOWS_SCANCODES_SUPPORT
-				//optional behaviour:
-				if (SHOULD_USE_SCANCODES) {
-					bool isExtendedKey =
-						(keyboardEvent.second == VK_UP) ||
-						(keyboardEvent.second == VK_DOWN) ||
-						(keyboardEvent.second == VK_LEFT) ||
-						(keyboardEvent.second == VK_RIGHT) ||
-						(keyboardEvent.second == VK_HOME) ||
-						(keyboardEvent.second == VK_END) ||
-						(keyboardEvent.second == VK_PRIOR) ||
-						(keyboardEvent.second == VK_NEXT) ||
-						(keyboardEvent.second == VK_INSERT) ||
-						(keyboardEvent.second == VK_DELETE);
-
-					INPUT input = { 0 };
-					input.type = INPUT_KEYBOARD;
-					// Calculate scan-code from the Robot's virtual key code:
-					input.ki.wScan = MapVirtualKey(keyboardEvent.second, MAPVK_VK_TO_VSC);
-					input.ki.dwFlags = (keyboardEvent.first) ? 
-						KEYEVENTF_SCANCODE : (KEYEVENTF_SCANCODE | KEYEVENTF_KEYUP);
-					if (isExtendedKey) {
-						input.ki.dwFlags |= KEYEVENTF_EXTENDEDKEY;
-					}
-					
-					SendInput (1, &input, sizeof (INPUT));
-					sleep(m_keystrokes_delay);
-					return;
-				}
-#endif
-				//default behaviour:
-				(keyboardEvent.first) ? keyboard.Press(keyboardEvent.second) : keyboard.Release(keyboardEvent.second);
-			}
+			std::shared_ptr<InputBackend> m_inputBackend;
 		public:
-			MyHotkeyCombination(std::string const & param, bool isEnabled, ROBOT_NS::KeyList const & sequence, unsigned int keystrokes_delay): core::SimpleHotkeyCombination(param, isEnabled), m_sequence(sequence), m_keystrokes_delay(keystrokes_delay) {
+			MyHotkeyCombination(std::string const & param, bool isEnabled, std::shared_ptr<CompiledKeySequence const> const & sequence, unsigned int keystrokes_delay, std::shared_ptr<InputBackend> const & inputBackend)
+				: core::SimpleHotkeyCombination(param, isEnabled), m_sequence(sequence), m_keystrokes_delay(keystrokes_delay), m_inputBackend(inputBackend) {
 			}
 			void execute() override {
 				if (enabled) {
-					auto keyboard = ROBOT_NS::Keyboard{};
-					keyboard.AutoDelay = m_keystrokes_delay;
-					for (auto const & key_event : m_sequence) {
-						simulateSingleKeyboardInputEvent(keyboard, key_event);
-					}
+					m_inputBackend->simulateKeys(m_sequence->m_keys, m_keystrokes_delay);
 				}
 			}
+			std::string getCompiledData() const override {
+				return serializeCompiledKeySequence(*m_sequence);
+			}
 		};
 
 		class MyMouseInput: public core::SimpleMouseInput
@@ -264,21 +392,20 @@ extern bool SHOULD_USE_SCANCODES;
 			ROBOT_NS::Button m_buttonToClick;
 			ROBOT_NS::Point m_scr_coord;
 			unsigned int m_delay;
+			std::shared_ptr<InputBackend> m_inputBackend;
 		public:
 			MyMouseInput(std::string const & param, bool isEnabled,
 				ROBOT_NS::Button buttonToClick, ROBOT_NS::Point const & pos,
-				unsigned int delayAfterClick) :
+				unsigned int delayAfterClick, std::shared_ptr<InputBackend> const & inputBackend) :
 					core::SimpleMouseInput(param, isEnabled), m_buttonToClick(buttonToClick),
-					m_scr_coord(pos), m_delay(delayAfterClick) {
+					m_scr_coord(pos), m_delay(delayAfterClick), m_inputBackend(inputBackend) {
 			}
 			void execute() override {
 				if (enabled) {
-					ROBOT_NS::Mouse mouse;
-					mouse.SetPos(m_scr_coord);
-					mouse.Click(m_buttonToClick);
+					m_inputBackend->clickMouse(m_buttonToClick, m_scr_coord);
 
 					// Adding the wait operation after each click (for consistency sake):
-					ROBOT_NS::Timer::Sleep (m_delay);
+					m_inputBackend->sleep(m_delay);
 				}
 			}
 		};
@@ -288,62 +415,77 @@ extern bool SHOULD_USE_SCANCODES;
 			bool m_isVertical;
 			int m_amount;
 			unsigned int m_delay;
+			std::shared_ptr<InputBackend> m_inputBackend;
 		public:
 			MyMouseScroll(std::string const & param, bool isEnabled,
 				bool verticalScroll, int amount, //TODO: use type system to distinguish the boolean flags and int values (so that they are not mixed up)
-				unsigned int delayAfterScroll) :
+				unsigned int delayAfterScroll, std::shared_ptr<InputBackend> const & inputBackend) :
 				core::SimpleMouseInput(param, isEnabled), m_isVertical(verticalScroll),
-				m_amount(amount), m_delay(delayAfterScroll) {
+				m_amount(amount), m_delay(delayAfterScroll), m_inputBackend(inputBackend) {
 			}
 			void execute() override {
 				if (enabled) {
-					ROBOT_NS::Mouse mouse;
-
-					if (m_isVertical) {
-						mouse.AutoDelay = m_delay;
-						mouse.ScrollV(m_amount);
-					} else {
-						// Note: this is a workaround for the horizontal scroll. We can't just call mouse.ScrollH(m_amount) here because of the issue in the windows implementation of horizontal scrolling.
-						// It turns out, that the sendInput() function does not simulate horizontal scroll for several clicks (it assumes that it is the 'wheel tilt' operations)
-						// So, the robot's ScrollH() function will act incorrectly here - it will alwyas scroll one unit, regardless to the actual integer value, which is passed to it.
-						// Caution: This workaround could become very slow. For big numbers it will lock up the hat tool for quite a long time (simulation of each of the scrolling operations is quite slow).
-						// TODO: remove this workaround after the scrolH() is fixed in the robot library.
-						// Link for the issue on github: https://github.com/Robot/robot/issues/92
-						if (m_amount != 0) {
-							auto iterationsCount = (m_amount > 0) ? m_amount : -m_amount;
-							auto scrollDirection = (m_amount > 0) ? 1 : -1;
-							for (int i = 0; i < iterationsCount; ++i) {
-								mouse.ScrollH(scrollDirection);
-							}
-						}
-						ROBOT_NS::Timer::Sleep(m_delay);
-					}
+					m_inputBackend->scrollMouse(m_isVertical, m_amount, m_delay);
 				}
 			}
 		};
 		
 		class MySleepOperation: public core::SimpleSleepOperation
 		{
-			
+			std::shared_ptr<InputBackend> m_inputBackend;
 		public:
-			MySleepOperation(std::string const & param, unsigned int timeoutInMs, bool isEnabled)
-				: SimpleSleepOperation(param, timeoutInMs, isEnabled) {}
+			MySleepOperation(std::string const & param, unsigned int timeoutInMs, bool isEnabled, std::shared_ptr<InputBackend> const & inputBackend)
+				: SimpleSleepOperation(param, timeoutInMs, isEnabled), m_inputBackend(inputBackend) {}
 			void execute() override {
 				if (enabled) {
-					ROBOT_NS::Timer::Sleep(m_delay);
+					m_inputBackend->sleep(m_delay);
 				}
 			}
 		};
 
-		auto lambdaForKeyboardInputObjectsCreation = [&] (std::string const & param, core::CommandID const & commandID, size_t ) {
-			ROBOT_NS::KeyList sequence;
-			auto result = ROBOT_NS::Keyboard::Compile(param.c_str(), sequence);
-			if (!result) {
+		class MyTextTyping: public core::SimpleTextTyping
+		{
+			unsigned int m_keystrokes_delay;
+			std::shared_ptr<InputBackend> m_inputBackend;
+		public:
+			MyTextTyping(std::string const & param, bool isEnabled, unsigned int keystrokes_delay, std::shared_ptr<InputBackend> const & inputBackend)
+				: SimpleTextTyping(param, isEnabled), m_keystrokes_delay(keystrokes_delay), m_inputBackend(inputBackend) {}
+			void execute() override {
+				if (!enabled) {
+					return;
+				}
+				m_inputBackend->typeText(m_characters, m_keystrokes_delay);
+			}
+		};
+
+		auto createHotkeyCombination = [&] (std::string const & param, core::CommandID const & commandID, std::shared_ptr<CompiledKeySequence const> const & sequence) {
+			if (!sequence->m_isValid) {
 				std::cout << "Error during decoding of the sequence for the command (id='"
 					<< commandID.getValue() << "') by Robot library:\n\t" << param << "\nThe sequence will be disabled.\n";
 			}
-			auto shouldEnable = result && (param.size() > 0);
-			return std::make_shared<MyHotkeyCombination>(param, shouldEnable, sequence, keyboard_intervals);
+			auto shouldEnable = sequence->m_isValid && (param.size() > 0);
+			return std::make_shared<MyHotkeyCombination>(param, shouldEnable, sequence, keyboard_intervals, inputBackend);
+		};
+
+		auto lambdaForKeyboardInputObjectsCreation = [&] (std::string const & param, core::CommandID const & commandID, size_t ) {
+			auto const sequence = getCompiledKeySequencesCache().get(param, [](std::string const & sequenceString) {
+				auto result = CompiledKeySequence{ false, ROBOT_NS::KeyList{} };
+				result.m_isValid = ROBOT_NS::Keyboard::Compile(sequenceString.c_str(), result.m_keys);
+				return result;
+			});
+			return createHotkeyCombination(param, commandID, sequence);
+		};
+
+		// The sequences from the precompiled configs bundle are put into the cache as they are (they are compiled only if the bundle was compiled on another platform).
+		auto lambdaForPrecompiledKeyboardInputObjectsCreation = [&] (std::string const & param, std::string const & compiledData, core::CommandID const & commandID, size_t ) {
+			auto const sequence = getCompiledKeySequencesCache().get(param, [&compiledData](std::string const & sequenceString) {
+				auto result = CompiledKeySequence{ false, ROBOT_NS::KeyList{} };
+				if (!deserializeCompiledKeySequence(compiledData, result)) {
+					result.m_isValid = ROBOT_NS::Keyboard::Compile(sequenceString.c_str(), result.m_keys);
+				}
+				return result;
+			});
+			return createHotkeyCombination(param, commandID, sequence);
 		};
 
 		auto lambdaForMouseInputObjectsCreation = [&] (std::string const & param, core::CommandID const & commandID, size_t ) {
@@ -351,76 +493,207 @@ extern bool SHOULD_USE_SCANCODES;
 			if (core::ConfigFilesKeywords::MouseEventTypes::isScrollingEvent(param)) {
 				auto scrollInfo = getScrollInfo(param);
 				result = std::make_shared<MyMouseScroll>(
-					param, true, scrollInfo.first, scrollInfo.second, keyboard_intervals);
+					param, true, scrollInfo.first, scrollInfo.second, keyboard_intervals, inputBackend);
 			} else {
 				auto parameterizationParseResult = parseMouseInputCommandInfoString(param);
-				result = std::make_shared<MyMouseInput>(param, true, parameterizationParseResult.first, parameterizationParseResult.second, keyboard_intervals);
+				result = std::make_shared<MyMouseInput>(param, true, parameterizationParseResult.first, parameterizationParseResult.second, keyboard_intervals, inputBackend);
 			}
 			return result;
 		};
 
-		auto commandsConfig = hat::core::CommandsInfoContainer::parseConfigFile(csvStream, lambdaForKeyboardInputObjectsCreation);
-
 		auto lambdaForSleepObjectsCreation = [&] (std::string const & param, core::CommandID const & commandID, size_t ) {
 			auto sleepTimeout = std::stoi(param);
-			return std::make_shared<MySleepOperation>(param, sleepTimeout, true);
+			return std::make_shared<MySleepOperation>(param, sleepTimeout, true, inputBackend);
 		};
 
-		loggingCallback("Reading input sequences configs", "");
-		for (auto & inputSequencesConfig: inputSequencesConfigs) {
-			if (inputSequencesConfig.size() > 0) {
-				std::cout << "Starting to read input sequences file '" << inputSequencesConfig << "'\n";
-				std::fstream typingsSequensesConfigStream(inputSequencesConfig.c_str());
-				loggingCallback("", inputSequencesConfig);
-				if (typingsSequensesConfigStream.is_open()) {
-					commandsConfig.consumeInputSequencesConfigFile(typingsSequensesConfigStream, lambdaForKeyboardInputObjectsCreation, lambdaForMouseInputObjectsCreation, lambdaForSleepObjectsCreation);
-				} else {
-					std::cout << "  ERROR: file could not be opened. Please check the path.\n";
+		auto lambdaForTextTypingObjectsCreation = [&] (std::string const & param, core::CommandID const & commandID, size_t ) {
+			auto const isSupported = inputBackend->canTypeText();
+			if (!isSupported) {
+				std::cout << "WARNING: typing of the texts is not supported on this platform. The command '" << commandID.getValue() << "' will be disabled.\n";
+			}
+			return std::make_shared<MyTextTyping>(param, isSupported, keyboard_intervals, inputBackend);
+		};
+
+		// The hashes of the config files contents. They are used for finding out, which parts of the configs were changed since the previous loading (see core::ConfigsReloadCache).
+		// They are also stored in the precompiled configs bundle, so that the outdated bundles could be detected.
+		auto const getNonEmptyPaths = [](std::vector<std::string> const & paths) {
+			auto result = std::vector<std::string>{};
+			std::copy_if(paths.begin(), paths.end(), std::back_inserter(result), [](std::string const & path) { return path.size() > 0; });
+			return result;
+		};
+		auto const inputSequencesConfigPaths = getNonEmptyPaths(inputSequencesConfigs);
+		auto const variablesManagersConfigPaths = getNonEmptyPaths(variablesManagersSetupConfigs);
+		auto imagesConfigPaths = std::vector<std::string>{};
+#ifdef HAT_IMAGES_SUPPORT
+		if (imageResourcesConfig.size() > 0) {
+			imagesConfigPaths = { imageResourcesConfig, imageId2CommandIdConfig };
+		}
+#endif //HAT_IMAGES_SUPPORT
+		// Note: the order of the files is the same as the loading order.
+		auto allConfigPaths = std::vector<std::string>{ commandsCSV };
+		allConfigPaths.insert(allConfigPaths.end(), inputSequencesConfigPaths.begin(), inputSequencesConfigPaths.end());
+		allConfigPaths.insert(allConfigPaths.end(), variablesManagersConfigPaths.begin(), variablesManagersConfigPaths.end());
+		allConfigPaths.insert(allConfigPaths.end(), imagesConfigPaths.begin(), imagesConfigPaths.end());
+		allConfigPaths.push_back(layoutConfig);
+		auto configSources = core::ConfigBundleSources(allConfigPaths.size());
+		runTasksInParallel(allConfigPaths.size(), [&](size_t pathIndex) {
+			configSources[pathIndex] = core::ConfigBundleSourceFile::create(allConfigPaths[pathIndex]);
+		});
+		auto const dependencies = core::calculateConfigPartsDependencies(configSources, inputSequencesConfigPaths.size(), variablesManagersConfigPaths.size(), imagesConfigPaths.size());
+
+		if (configBundleMode == ConfigBundleMode::LOAD_IF_VALID) {
+			core::MappedConfigFile configBundleFile(configBundlePath);
+			if (configBundleFile.is_open()) {
+				try {
+					if (core::readConfigBundleSources(configBundleFile.getContents()) == configSources) {
+						std::cout << "Reading the precompiled configs bundle '" << configBundlePath << "'\n";
+						loggingCallback("Reading precompiled configs bundle", configBundlePath);
+						auto configs = core::readConfigBundle(configBundleFile.getContents(), lambdaForPrecompiledKeyboardInputObjectsCreation, lambdaForMouseInputObjectsCreation, lambdaForSleepObjectsCreation, lambdaForTextTypingObjectsCreation);
+						reloadCache.storeConfigBundle(dependencies, configs);
+						printCompiledKeySequencesCacheStatistics();
+						auto result = Engine(configs.m_layout, configs.m_commandsConfig, configs.m_imagesConfig, stickEnvToWindow, keyboard_intervals, inputBackend);
+						if (precomputeEnvironmentLayouts) {
+							loggingCallback("Generating layouts for all the environments", "");
+							result.precomputeNormalLayouts();
+						}
+						return result;
+					}
+					std::cout << "The precompiled configs bundle '" << configBundlePath << "' is outdated (the config files were changed since it was compiled). The config files will be parsed.\n";
+				} catch (std::runtime_error & e) {
+					std::cout << "The precompiled configs bundle '" << configBundlePath << "' can't be used: " << e.what() << "\nThe config files will be parsed.\n";
 				}
+			} else {
+				std::cout << "The precompiled configs bundle '" << configBundlePath << "' could not be opened. The config files will be parsed.\n";
+			}
+		}
+
+		// Only the parts of the configs, which were changed since the previous loading (or depend on the changed parts) are parsed. The rest is taken from the reloadCache.
+		auto const partsToParse = reloadCache.getConfigPartsToParse(dependencies);
+		auto const shouldParseVariables = partsToParse.m_variables;
+		auto const shouldParseCommands = partsToParse.m_commands;
+		if (shouldParseCommands) {
+			loggingCallback("Reading main commands list", commandsCSV);
+		} else {
+			std::cout << "The commands and input sequences configs were not changed since the previous loading. Reusing them.\n";
+			loggingCallback("Commands and input sequences configs are not changed", "");
+		}
+		auto commandsConfig = !shouldParseVariables ? reloadCache.m_commandsWithVariables.get()
+			: (shouldParseCommands ? hat::core::CommandsInfoContainer::parseConfigFile(commandsConfigFile.getContents(), lambdaForKeyboardInputObjectsCreation) : reloadCache.m_commands.get());
+
+		// The input sequences and variables managers configs are preparsed in parallel (one file per task, see the core::PreparsedConfigFile class).
+		// After that they are stored into the commands config one by one, in the same order as they are listed, because they can reference the data from the previous files.
+		struct AdditionalConfigFile
+		{
+			std::string m_path;
+			bool m_isInputSequencesConfig;
+			std::unique_ptr<core::MappedConfigFile> m_contents;
+			std::unique_ptr<core::PreparsedConfigFile> m_preparsedData; // stays empty, if the file could not be opened
+		};
+		auto additionalConfigs = std::vector<AdditionalConfigFile>{};
+		if (shouldParseCommands) {
+			for (auto & inputSequencesConfig : inputSequencesConfigPaths) {
+				additionalConfigs.push_back(AdditionalConfigFile{ inputSequencesConfig, true, nullptr, nullptr });
 			}
 		}
-		loggingCallback("Reading variables managers configs", "");
-		for (auto & variablesManagersConfig: variablesManagersSetupConfigs) { // TODO: [low priority] refactoring: get rid of the code duplication (see loop above)
-			if (variablesManagersConfig.size() > 0) {
-				std::cout << "Starting to read varaibles managers config file '" << variablesManagersConfig << "'\n";
-				std::fstream filestream(variablesManagersConfig.c_str()); 
-				loggingCallback("", variablesManagersConfig);
-				if (filestream.is_open()) {
-					commandsConfig.consumeVariablesManagersConfig(filestream);
+		auto const inputSequencesConfigsCount = additionalConfigs.size();
+		if (shouldParseVariables) {
+			for (auto & variablesManagersConfig : variablesManagersConfigPaths) {
+				additionalConfigs.push_back(AdditionalConfigFile{ variablesManagersConfig, false, nullptr, nullptr });
+			}
+		}
+
+		runTasksInParallel(additionalConfigs.size(), [&](size_t configIndex) {
+			auto & config = additionalConfigs[configIndex];
+			config.m_contents = std::make_unique<core::MappedConfigFile>(config.m_path);
+			if (!config.m_contents->is_open()) {
+				return;
+			}
+			auto const & environments = commandsConfig.getEnvironments();
+			config.m_preparsedData = std::make_unique<core::PreparsedConfigFile>(config.m_isInputSequencesConfig ?
+				core::CommandsInfoContainer::preparseInputSequencesConfigFile(config.m_contents->getContents(), environments, lambdaForKeyboardInputObjectsCreation, lambdaForMouseInputObjectsCreation, lambdaForSleepObjectsCreation, lambdaForTextTypingObjectsCreation)
+				: core::CommandsInfoContainer::preparseVariablesManagersConfig(config.m_contents->getContents(), environments));
+		});
+
+		auto storePreparsedConfigs = [&](size_t firstConfigIndex, size_t configsEndIndex, std::string const & fileTypeDescription) {
+			for (size_t configIndex = firstConfigIndex; configIndex < configsEndIndex; ++configIndex) {
+				auto const & config = additionalConfigs[configIndex];
+				std::cout << "Starting to read " << fileTypeDescription << " file '" << config.m_path << "'\n";
+				loggingCallback("", config.m_path);
+				if (config.m_preparsedData) {
+					config.m_preparsedData->storeTo(commandsConfig);
 				} else {
-					std::cout << "  ERROR: could not be opened. Please check the path.\n";
+					std::cout << "  ERROR: file could not be opened. Please check the path.\n";
 				}
 			}
+		};
+		if (shouldParseCommands) {
+			loggingCallback("Reading input sequences configs", "");
+			storePreparsedConfigs(0, inputSequencesConfigsCount, "input sequences");
+			reloadCache.m_commands.store(dependencies.m_commands, commandsConfig);
+		}
+		if (shouldParseVariables) {
+			loggingCallback("Reading variables managers configs", "");
+			storePreparsedConfigs(inputSequencesConfigsCount, additionalConfigs.size(), "varaibles managers config");
+			reloadCache.m_commandsWithVariables.store(dependencies.m_variables, commandsConfig);
 		}
 
 		auto imageResourcesDataAccumulator = hat::core::ImageResourcesInfosContainer{commandsConfig.getEnvironments()};
+		if (!reloadCache.shouldParseImages(dependencies, commandsConfig.getEnvironments())) {
+			imageResourcesDataAccumulator = reloadCache.m_images.get();
+		} else {
 #ifdef HAT_IMAGES_SUPPORT
-		if (imageResourcesConfig.size() > 0) {
-			std::cout << "Starting to read the image resources config file '" << imageResourcesConfig << "'\n";
-			std::cout << "  And linking them to the commands with environments according to the config file '" << imageId2CommandIdConfig << "'\n";
-			std::fstream img_resources_fstream(imageResourcesConfig.c_str());
-			if (img_resources_fstream.is_open()) {
-				std::fstream img_2_commands_fstream(imageId2CommandIdConfig.c_str());
-				if (img_2_commands_fstream.is_open()) {
-					loggingCallback("Reading images info configs...", "");
-					loggingCallback("", "resources info: " + imageResourcesConfig);
-					loggingCallback("", "imageIds 2 commands mappings: " + imageId2CommandIdConfig);
-					imageResourcesDataAccumulator.consumeImageResourcesConfig(img_resources_fstream, img_2_commands_fstream);
+			if (imageResourcesConfig.size() > 0) {
+				std::cout << "Starting to read the image resources config file '" << imageResourcesConfig << "'\n";
+				std::cout << "  And linking them to the commands with environments according to the config file '" << imageId2CommandIdConfig << "'\n";
+				core::MappedConfigFile img_resources_file(imageResourcesConfig);
+				if (img_resources_file.is_open()) {
+					core::MappedConfigFile img_2_commands_file(imageId2CommandIdConfig);
+					if (img_2_commands_file.is_open()) {
+						loggingCallback("Reading images info configs...", "");
+						loggingCallback("", "resources info: " + imageResourcesConfig);
+						loggingCallback("", "imageIds 2 commands mappings: " + imageId2CommandIdConfig);
+						imageResourcesDataAccumulator.consumeImageResourcesConfig(img_resources_file.getContents(), img_2_commands_file.getContents());
+					} else {
+						std::cout << "  ERROR: file '" << imageId2CommandIdConfig << "'could not be opened. Please check the path. Images info will not be loaded.\n";
+					}
 				} else {
-					std::cout << "  ERROR: file '" << imageId2CommandIdConfig << "'could not be opened. Please check the path. Images info will not be loaded.\n";
+					std::cout << "  ERROR: file '" << imageResourcesConfig<< "'could not be opened. Please check the path. Images info will not be loaded.\n";
 				}
-			} else {
-				std::cout << "  ERROR: file '" << imageResourcesConfig<< "'could not be opened. Please check the path. Images info will not be loaded.\n";
 			}
-		}
 #endif //HAT_IMAGES_SUPPORT
+			reloadCache.m_images.store(dependencies.getImagesDependencies(commandsConfig.getEnvironments()), imageResourcesDataAccumulator);
+		}
+
+		auto const parseLayoutConfig = [&]() {
+			core::MappedConfigFile layoutConfigFile(layoutConfig);
+			if (!layoutConfigFile.is_open()) {
+				throw std::runtime_error("Could not find or open the layout config file: " + layoutConfig);
+			}
+			auto result = hat::core::LayoutUserInformation::parseConfigFile(layoutConfigFile.getContents());
+			reloadCache.m_layout.store(dependencies.m_layout, result);
+			return result;
+		};
+		auto layout = partsToParse.m_layout ? parseLayoutConfig() : reloadCache.m_layout.get();
 
-		std::fstream configStream(layoutConfig.c_str());
-		if (!configStream.is_open()) {
-			throw std::runtime_error("Could not find or open the layout config file: " + layoutConfig);
+		if (configBundleMode == ConfigBundleMode::COMPILE) {
+			std::ofstream configBundleFile(configBundlePath, std::ios::binary | std::ios::trunc);
+			if (!configBundleFile.is_open()) {
+				throw std::runtime_error("Could not open the precompiled configs bundle file for writing: " + configBundlePath);
+			}
+			core::writeConfigBundle(configBundleFile, configSources, commandsConfig, imageResourcesDataAccumulator, layout);
+			configBundleFile.close();
+			if (!configBundleFile) {
+				throw std::runtime_error("Error during writing the precompiled configs bundle file: " + configBundlePath);
+			}
+			std::cout << "The precompiled configs bundle is written to '" << configBundlePath << "'\n";
 		}
-		auto layout = hat::core::LayoutUserInformation::parseConfigFile(configStream);
-		return Engine(layout, commandsConfig, imageResourcesDataAccumulator, stickEnvToWindow, keyboard_intervals);
+		printCompiledKeySequencesCacheStatistics();
+		auto result = Engine(layout, commandsConfig, imageResourcesDataAccumulator, stickEnvToWindow, keyboard_intervals, inputBackend);
+		if (precomputeEnvironmentLayouts) {
+			loggingCallback("Generating layouts for all the environments", "");
+			result.precomputeNormalLayouts();
+		}
+		return result;
 	}
 
 	namespace {
@@ -442,17 +715,25 @@ extern bool SHOULD_USE_SCANCODES;
 		};
 	}
 	std::string Engine::getCurrentLayoutJson() const {
+		return getCurrentLayoutUpdate(nullptr).m_layoutJson;
+	}
+
+	Engine::LayoutUpdate Engine::getCurrentLayoutUpdate(std::shared_ptr<NormalLayout const> const & displayedLayout) const {
+		auto result = LayoutUpdate{};
 		if (m_currentState == LayoutState::NORMAL) {
 			if (m_shouldRebuildNormalLayout) {
 				m_shouldRebuildNormalLayout = false;
-				return getCurrentLayoutJson_normal();
-			} else {
-				return m_currentNormalLayout.getJson();
+				return getCurrentLayoutUpdate_normal(displayedLayout);
 			}
+			result.m_layoutJson = getCurrentLayoutJson_normalWithoutRebuild();
+			result.m_normalLayout = m_currentNormalLayout;
+			return result;
 		} else if (m_currentState == LayoutState::STICK_ENVIRONMENT_TO_WND) {
-			return getCurrentLayoutJson_waitForTopWindowInfo();
+			result.m_layoutJson = getCurrentLayoutJson_waitForTopWindowInfo();
+			return result;
 		} else if (m_currentState == LayoutState::WAIT_FOR_EXPECTED_WND_AT_FRONT) {
-			return getCurrentLayoutJson_wrongTopWindowMessage();
+			result.m_layoutJson = getCurrentLayoutJson_wrongTopWindowMessage();
+			return result;
 		}
 		std::cerr << "Program in invalid state. We should never get here. Exiting.\n";
 		abort();
@@ -476,10 +757,10 @@ namespace {
 
 	LoadingLayoutDataContainer const & Engine::getLayoutJson_loadingConfigsSplashscreen()
 	{
-		static auto GENERAL_LOG_ID = tau::common::ElementID{generateTrowawayTauIdentifier()};
-		static auto PARTICULAR_FILES_LOG_ID = tau::common::ElementID{generateTrowawayTauIdentifier()};
+		static auto GENERAL_LOG_ID = tau::common::ElementID{generateTrowawayTauIdentifier("loading_steps")};
+		static auto PARTICULAR_FILES_LOG_ID = tau::common::ElementID{generateTrowawayTauIdentifier("loading_files")};
 		static LoadingLayoutDataContainer result = LoadingLayoutDataContainer(
-			GENERAL_LOG_ID, PARTICULAR_FILES_LOG_ID, generateLoadingLayoutJson(tau::common::LayoutPageID(generateTrowawayTauIdentifier()), GENERAL_LOG_ID, PARTICULAR_FILES_LOG_ID));
+			GENERAL_LOG_ID, PARTICULAR_FILES_LOG_ID, generateLoadingLayoutJson(tau::common::LayoutPageID(generateTrowawayTauIdentifier("loading")), GENERAL_LOG_ID, PARTICULAR_FILES_LOG_ID));
 		return result;
 	}
 	
@@ -488,12 +769,12 @@ namespace {
 		namespace lg = tau::layout_generation;
 		auto topElem = lg::EvenlySplitLayoutElementsContainer{ true };
 		std::stringstream headerMessage;
-		headerMessage << "Wrong topmost window for current environment: please bring the window for " << m_commandsConfig.getEnvironments()[m_selectedEnvironment];
+		headerMessage << "Wrong topmost window for current environment: please bring the window for " << m_resolvedLayout->getEnvironmentName(m_selectedEnvironment);
 		topElem.push(lg::LabelElement(headerMessage.str()));
 		topElem.push(lg::ButtonLayoutElement().note("Cancel the current pending command").ID(tau::common::ElementID(generateClearPendingCommandButtonID())));
 		topElem.push(lg::ButtonLayoutElement().note("Expected window now on top. Retry the command").ID(tau::common::ElementID(generateResendPendingCommandButtonID())));
 		auto resultLayout = lg::LayoutInfo{};
-		resultLayout.pushLayoutPage(lg::LayoutPage(tau::common::LayoutPageID(generateTrowawayTauIdentifier()), topElem));
+		resultLayout.pushLayoutPage(lg::LayoutPage(tau::common::LayoutPageID(generateTrowawayTauIdentifier("wrong_window")), topElem));
 		return resultLayout.getJson();
 	}
 
@@ -503,57 +784,195 @@ namespace {
 		namespace lg = tau::layout_generation;
 		auto topElem = lg::EvenlySplitLayoutElementsContainer{ true };
 		std::stringstream headerMessage;
-		headerMessage << "Please move the target window for " << m_commandsConfig.getEnvironments()[m_selectedEnvironment] << " to the top.";
+		headerMessage << "Please move the target window for " << m_resolvedLayout->getEnvironmentName(m_selectedEnvironment) << " to the top.";
 		topElem.push(lg::LabelElement(headerMessage.str()));
 		topElem.push(lg::ButtonLayoutElement().note("Expected window now on top. Proceed").ID(tau::common::ElementID(generateStickEnvironmentToWindowCommand())));
 		auto resultLayout = lg::LayoutInfo{};
-		resultLayout.pushLayoutPage(lg::LayoutPage(tau::common::LayoutPageID(generateTrowawayTauIdentifier()), topElem));
+		resultLayout.pushLayoutPage(lg::LayoutPage(tau::common::LayoutPageID(generateTrowawayTauIdentifier("wait_for_window")), topElem));
 		return resultLayout.getJson();
 	}
 
-	std::string Engine::getCurrentLayoutJson_normal() const
+	namespace {
+		size_t calculatePresentationMemoryUsage(hat::core::InternalLayoutPageRepresentation const & page)
+		{
+			auto result = sizeof(page) + page.getNote().size();
+			for (auto const & row : page.getLayout()) {
+				result += sizeof(row);
+				for (auto const & element : row) {
+					result += sizeof(element) + element.getNote().size();
+					auto const optionsPage = element.getOptionsPagePtr();
+					if (optionsPage != nullptr) {
+						result += calculatePresentationMemoryUsage(*optionsPage); // Note: the shared options pages are counted several times here
+					}
+				}
+			}
+			return result;
+		}
+	}
+
+	size_t Engine::NormalLayout::calculateMemoryUsage() const
+	{
+		// Note: the size of the m_layout object is estimated by the size of it's json (the layout generation library does not provide the information about it's internals).
+		auto result = sizeof(NormalLayout) + m_json.capacity() + m_json.size();
+		for (auto const & pageID : m_topPagesIDs) {
+			result += sizeof(pageID) + pageID.getValue().size();
+		}
+		for (auto const & displayedVariable : m_displayedVariables) {
+			result += sizeof(displayedVariable) + displayedVariable.first.getValue().size();
+			for (auto const & elementID : displayedVariable.second) {
+				result += sizeof(elementID) + elementID.getValue().size();
+			}
+		}
+		for (auto const & page : m_presentation.getPages()) {
+			result += calculatePresentationMemoryUsage(page);
+		}
+		for (auto const & elementID : m_elementIDs) {
+			result += sizeof(elementID) + elementID.getValue().size();
+		}
+		for (auto const & caption : m_topPagesCaptions) {
+			result += sizeof(caption) + caption.first.getValue().size() + caption.second.size();
+		}
+		for (auto const & buttonAction : m_buttonsActions) {
+			result += sizeof(buttonAction) + buttonAction.first.size();
+		}
+		for (auto const & topPageIndex : m_topPagesIndices) {
+			result += sizeof(topPageIndex) + topPageIndex.first.size();
+		}
+		return result;
+	}
+
+	void Engine::precomputeNormalLayouts()
+	{
+		auto const startTime = std::chrono::steady_clock::now();
+		auto const environmentsCount = m_commandsConfig.getEnvironments().size();
+		auto layouts = std::vector<std::shared_ptr<NormalLayout const>>(environmentsCount);
+		runTasksInParallel(environmentsCount, [&](size_t environmentIndex) {
+			layouts[environmentIndex] = std::make_shared<NormalLayout const>(generateNormalLayout(environmentIndex, true));
+		});
+		m_precomputedNormalLayouts = std::move(layouts);
+
+		auto memoryUsage = size_t{ 0 };
+		for (auto const & layout : m_precomputedNormalLayouts) {
+			memoryUsage += layout->calculateMemoryUsage();
+		}
+		auto const generationTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
+		std::cout << "Generated the layouts for " << environmentsCount << " environment(s) in " << generationTime.count() << " ms. The memory used by them: about " << ((memoryUsage + 1023) / 1024) << " KB.\n";
+	}
+
+	namespace {
+		bool haveSameIDs(std::vector<tau::common::ElementID> const & first, std::vector<tau::common::ElementID> const & second)
+		{
+			return std::equal(first.begin(), first.end(), second.begin(), second.end(), [](tau::common::ElementID const & firstID, tau::common::ElementID const & secondID) {
+				return firstID.getValue() == secondID.getValue();
+			});
+		}
+	}
+
+	Engine::LayoutUpdate Engine::getCurrentLayoutUpdate_normal(std::shared_ptr<NormalLayout const> const & displayedLayout) const
+	{
+		auto const canUsePrecomputedLayout = isEnv_selected && (m_selectedEnvironment < m_precomputedNormalLayouts.size());
+		if (canUsePrecomputedLayout && m_precomputedNormalLayouts[m_selectedEnvironment]) {
+			m_currentNormalLayout = m_precomputedNormalLayouts[m_selectedEnvironment];
+		} else {
+			m_currentNormalLayout = std::make_shared<NormalLayout const>(generateNormalLayout(m_selectedEnvironment, isEnv_selected));
+			if (canUsePrecomputedLayout) {
+				m_precomputedNormalLayouts[m_selectedEnvironment] = m_currentNormalLayout;
+			}
+		}
+		auto const & newLayout = *m_currentNormalLayout;
+		auto result = LayoutUpdate{};
+		result.m_normalLayout = m_currentNormalLayout;
+		if (displayedLayout) {
+			// The IDs are generated from the positions of the elements, so the layouts with the same structure have the same IDs.
+			// Note: the IDs could still differ, if the indices of the commands were changed after the configs reloading.
+			auto const notesChanges = hat::core::calculateLayoutNotesChanges(displayedLayout->m_presentation, newLayout.m_presentation);
+			auto canUpdateByNotes = notesChanges.m_isStructureTheSame && haveSameIDs(displayedLayout->m_elementIDs, newLayout.m_elementIDs);
+			for (auto const & changedNote : notesChanges.m_changedNotes) {
+				auto const & elementID = newLayout.m_elementIDs[changedNote.first];
+				canUpdateByNotes = canUpdateByNotes && (elementID.getValue().size() > 0);
+				result.m_notesChanges.emplace_back(elementID, changedNote.second);
+			}
+			for (size_t i = 0; canUpdateByNotes && (i < newLayout.m_topPagesCaptions.size()); ++i) {
+				if (newLayout.m_topPagesCaptions[i].second != displayedLayout->m_topPagesCaptions[i].second) {
+					result.m_notesChanges.push_back(newLayout.m_topPagesCaptions[i]);
+				}
+			}
+			result.m_isFullLayout = !canUpdateByNotes;
+		}
+		if (result.m_isFullLayout) {
+			m_currentStartPageIndex = m_lastTopPageSelected = newLayout.m_startPageIndex;
+			result.m_layoutJson = newLayout.m_json;
+			result.m_notesChanges.clear();
+		}
+		return result;
+	}
+
+	std::string Engine::getCurrentLayoutJson_normalWithoutRebuild() const
+	{
+		if (m_currentStartPageIndex == m_currentNormalLayout->m_startPageIndex) {
+			return m_currentNormalLayout->m_json;
+		}
+		auto layout = m_currentNormalLayout->m_layout;
+		layout.setStartLayoutPage(m_currentNormalLayout->m_topPagesIDs[m_currentStartPageIndex]);
+		return layout.getJson();
+	}
+
+	Engine::NormalLayout Engine::generateNormalLayout(size_t environmentIndex, bool isEnvironmentSelected) const
 	{
 		using namespace std::string_literals;
-		
-		m_currentlyDisplayedVariables.clear(); // Each time we generate the new normal layout, we have to refresh this mapping.
 
-		hat::core::ConfigsAbstractionLayer layer(m_layoutInfo, m_commandsConfig, m_imagesConfig);
-		auto currentLayoutState = layer.generateLayoutPresentation(m_selectedEnvironment, isEnv_selected);
+		auto result = NormalLayout{};
+
+		hat::core::ConfigsAbstractionLayer layer(m_resolvedLayout, m_commandsConfig, m_imagesConfig);
+		result.m_presentation = layer.generateLayoutPresentation(environmentIndex, isEnvironmentSelected);
+		auto const & currentLayoutState = result.m_presentation;
 
 		size_t const TOP_PAGES_COUNT = currentLayoutState.getPages().size();
-		TOP_PAGES_IDS.clear(); // these are the pages, which are valid for restoring state to (other layout pages like the options selectors should not be restored to)
-		TOP_PAGES_IDS.reserve(TOP_PAGES_COUNT);
+		result.m_topPagesIDs.reserve(TOP_PAGES_COUNT);
 		for (size_t i = 0; i < TOP_PAGES_COUNT; ++i) {
-			TOP_PAGES_IDS.push_back(tau::common::LayoutPageID(generateTrowawayTauIdentifier()));
+			result.m_topPagesIDs.push_back(tau::common::LayoutPageID(generateTrowawayTauIdentifier("p"s + std::to_string(i))));
+			result.m_topPagesIndices.emplace(result.m_topPagesIDs.back().getValue(), i);
 		}
 
 		// These 2 variabels are used for the quick jump page - the page, from which the user can jump to any of the pages defined for the given environment.
 		// For each top page, we have a button in this quick jump page, from which the given top page can be reached.
-		auto pagesQuickJumpPageID = tau::common::LayoutPageID{generateTrowawayTauIdentifier()};
+		auto pagesQuickJumpPageID = tau::common::LayoutPageID{generateTrowawayTauIdentifier("jumps")};
 		auto quickJumpPageButtonsContainer = tau::layout_generation::EvenlySplitLayoutElementsContainer(true);
 
-		m_currentNormalLayout = tau::layout_generation::LayoutInfo{};
+		// The actions of the buttons are decoded here once, so the clicks are dispatched without parsing the IDs (see Engine::layoutButtonClicked()).
+		auto registerButtonAction = [&result](tau::common::ElementID const & buttonID) {
+			result.m_buttonsActions.emplace(buttonID.getValue(), decodeButtonClickAction(buttonID.getValue()));
+		};
 
 		//Can't use 'auto' for the lambda type, because this lambda is called recursively, so it's type can't be deduced
-		typedef std::function<tau::layout_generation::EvenlySplitLayoutElementsContainer(hat::core::InternalLayoutPageRepresentation const &, IDsForNavigation const & navigationIDs)> MyLambdaType;
+		//The pagePath is the position of the page in the layout (the index of the top page, followed by the row and column indices of the elements, which open the options pages).
+		//The IDs of the elements are generated from their positions, so the same layout always gets the same IDs.
+		typedef std::function<tau::layout_generation::EvenlySplitLayoutElementsContainer(hat::core::InternalLayoutPageRepresentation const &, IDsForNavigation const & navigationIDs, std::string const & pagePath)> MyLambdaType;
 		MyLambdaType createLayoutPage =
-			[&](hat::core::InternalLayoutPageRepresentation const & userData, IDsForNavigation const & navigationIDs) -> tau::layout_generation::EvenlySplitLayoutElementsContainer {
-			auto result = tau::layout_generation::EvenlySplitLayoutElementsContainer{ true };
-			for (auto const & row : userData.getLayout()) {
+			[&](hat::core::InternalLayoutPageRepresentation const & userData, IDsForNavigation const & navigationIDs, std::string const & pagePath) -> tau::layout_generation::EvenlySplitLayoutElementsContainer {
+			auto pageContents = tau::layout_generation::EvenlySplitLayoutElementsContainer{ true };
+			auto const & rows = userData.getLayout();
+			for (size_t rowIndex = 0; rowIndex < rows.size(); ++rowIndex) {
+				auto const & row = rows[rowIndex];
 				auto newElementsRow = tau::layout_generation::EvenlySplitLayoutElementsContainer{ false };
-				for (auto const & elem : row) {
-					
-					// Simple lambda, which records the label id with the variable id, which this label represents
+				for (size_t columnIndex = 0; columnIndex < row.size(); ++columnIndex) {
+					auto const & elem = row[columnIndex];
+					auto const elementPath = pagePath + "."s + std::to_string(rowIndex) + "."s + std::to_string(columnIndex);
+					auto const elementIndex = result.m_elementIDs.size(); // the ID (if any) is recorded here, before the elements of the options page are added
+					result.m_elementIDs.emplace_back();
+
+					// Simple lambda, which records the label id with the variable id, which this label represents (and remembers the id of the element for the notes updates)
 					auto linkIdWithTextVariableIfNeeded = [&](tau::common::ElementID const & elementID) {
+						result.m_elementIDs[elementIndex] = elementID;
 						if (elem.referencesVariable()) {
 							auto variableID = elem.getReferencedVariable();
-							m_currentlyDisplayedVariables[variableID].push_back(elementID);
+							result.m_displayedVariables[variableID].push_back(elementID);
 						}
 					};
 
 					if (elem.is_button()) {
 						auto toPush = tau::layout_generation::ButtonLayoutElement();
-						toPush.note(hat::core::escapeRawUTF8_forJson(elem.getNote()));
+						toPush.note(elem.getNote());
 						{
 							auto imageID_string = elem.getImageID().getValue();
 							if (imageID_string.size() > 0) {
@@ -563,8 +982,9 @@ namespace {
 						if (elem.isActive()) {
 							if (elem.getReferencedCommand().nonEmpty()) {
 								size_t commandIndex = m_commandsConfig.getCommandIndex(elem.getReferencedCommand());
-								auto idToUse = tau::common::ElementID{generateTauIdentifierForCommand(commandIndex)};
+								auto idToUse = tau::common::ElementID{generateTauIdentifierForCommand(commandIndex, "e"s + elementPath)};
 								linkIdWithTextVariableIfNeeded(idToUse);
+								registerButtonAction(idToUse);
 								toPush.ID(idToUse);
 								if (navigationIDs.hasFallbackID()) {
 									//Since this button does not swtich to any page explicitly, we add an automatic fallback switch here
@@ -573,17 +993,17 @@ namespace {
 							}
 							auto optionsSelectorForElem = elem.getOptionsPagePtr();
 							if (optionsSelectorForElem != nullptr) {
-								auto newPageID = tau::common::LayoutPageID{ generateTrowawayTauIdentifier() };
+								auto newPageID = tau::common::LayoutPageID{ generateTrowawayTauIdentifier("p"s + elementPath) };
 								auto newNav = navigationIDs.createNewSelector(newPageID);
-								auto newLayoutPage = createLayoutPage(*optionsSelectorForElem, newNav);
+								auto newLayoutPage = createLayoutPage(*optionsSelectorForElem, newNav, elementPath);
 
 								//decorate the page here:
 								auto layoutDecorations = tau::layout_generation::EvenlySplitLayoutElementsContainer(true);
-								layoutDecorations.push(tau::layout_generation::LabelElement(hat::core::escapeRawUTF8_forJson(elem.getNote())));
+								layoutDecorations.push(tau::layout_generation::LabelElement(elem.getNote()));
 								layoutDecorations.push(tau::layout_generation::ButtonLayoutElement()
 									.note("back").switchToAnotherLayoutPageOnClick(navigationIDs.m_currentPageID));
 
-								m_currentNormalLayout.pushLayoutPage(tau::layout_generation::LayoutPage(newNav.m_currentPageID,
+								result.m_layout.pushLayoutPage(tau::layout_generation::LayoutPage(newNav.m_currentPageID,
 									tau::layout_generation::UnevenlySplitElementsPair(newLayoutPage, layoutDecorations, true, 0.75)
 								));
 								toPush.switchToAnotherLayoutPageOnClick(newNav.m_currentPageID);
@@ -591,8 +1011,9 @@ namespace {
 
 							auto anotherEnvironmentSwitchingInfo = elem.switchingToAnotherEnvironment_info();
 							if (anotherEnvironmentSwitchingInfo.first) {
-								auto idToUse = tau::common::ElementID(generateTauIdentifierForEnvSwitching(anotherEnvironmentSwitchingInfo.second));
+								auto idToUse = tau::common::ElementID(generateTauIdentifierForEnvSwitching(anotherEnvironmentSwitchingInfo.second, "e"s + elementPath));
 								linkIdWithTextVariableIfNeeded(idToUse);
+								registerButtonAction(idToUse);
 								toPush.ID(idToUse);
 							}
 						} else {
@@ -601,40 +1022,42 @@ namespace {
 						newElementsRow.push(toPush);
 					} else {
 						//TODO: clean up the code for registering the IDs. Currently we have to call manually linkIdWithTextVariableIfNeeded() function. It's logic should be applied automatically when we generate the ElementID here (and in the code above).
-						auto idToUse = tau::common::ElementID(generateTrowawayTauIdentifier());
+						auto idToUse = tau::common::ElementID(generateTrowawayTauIdentifier("e"s + elementPath));
 						linkIdWithTextVariableIfNeeded(idToUse);
-						auto elementToAdd = tau::layout_generation::LabelElement(hat::core::escapeRawUTF8_forJson(elem.getNote()));
+						auto elementToAdd = tau::layout_generation::LabelElement(elem.getNote());
 						elementToAdd.ID(idToUse); // don't forget to assign the ID to the label
 						newElementsRow.push(elementToAdd);
 					}
 				}
-				result.push(newElementsRow);
+				pageContents.push(newElementsRow);
 			}
-			return result;
+			return pageContents;
 		}; // end of lambda that holds the logic for generating the user-defined contents for the layout page (without navigation buttons and auto-generated info label)
 
-		auto selectedEnvCaptionPrefix = isEnv_selected ? ("["s + m_commandsConfig.getEnvironments()[m_selectedEnvironment] + "] "s) : ""s;
+		// Note: all the texts of the presentation are already escaped for json (see hat::core::ResolvedLayout), so they are copied to the layout as-is.
+		auto selectedEnvCaptionPrefix = isEnvironmentSelected ? ("["s + m_resolvedLayout->getEnvironmentName(environmentIndex) + "] "s) : ""s;
 		
 		auto emptyFallbackID = tau::common::LayoutPageID{ "" };
 		for (size_t i = 0; i < TOP_PAGES_COUNT; ++i) {
-			auto currentPageID = TOP_PAGES_IDS[i];
+			auto currentPageID = result.m_topPagesIDs[i];
 			auto & currentPreprocessedPagePresentation = currentLayoutState.getPages()[i];
 
 			auto navigationInfo = IDsForNavigation{ emptyFallbackID, currentPageID };
-			auto contents = createLayoutPage(currentPreprocessedPagePresentation, navigationInfo); ///TODO: add m_selectedEnvironment use here
+			auto contents = createLayoutPage(currentPreprocessedPagePresentation, navigationInfo, std::to_string(i)); ///TODO: add environmentIndex use here
 
 			// NOTE: This lambda has such an ugly name because it is a hack. because of a limitation to the UnevenlySplitElementsPair object we have to do the following:
 			// Currently we have to provide both of the child elements for it at the moment of construction (contrary to the EvenlySplitLayoutElementsContainer, which allows push() method)
 			// So, we are wrapping the elements of the pair inside the one-element EvenlySplitLayoutElementsContainer objects, from which the result construct is built.
 			// This makes the code a lot more readable and allows for creation of the layout structures, which are impossible to create in other ways right now (c++ language will not allow it)
 			// TODO: remove the excessive EvenlySplitLayoutElementsContainer objects after the TAU library is fixed (the UnevenlySplitElementsPair should get pushRightOrBottom() and pushLeftOrTop() methods, which will replace the current elements stored in it)
+			// Note: the wrappers are the part of the layout json, which the clients get. So they can not be removed before the layout format is checked against the clients.
 			auto createNavigationButtonWrappedInEvenlySplitLayoutElementsContainer = [&](size_t destIndex) -> tau::layout_generation::EvenlySplitLayoutElementsContainer
 			{
 				if (destIndex < TOP_PAGES_COUNT) {
 					return tau::layout_generation::EvenlySplitLayoutElementsContainer(false)
 						.push(tau::layout_generation::ButtonLayoutElement().note(
-							hat::core::escapeRawUTF8_forJson(currentLayoutState.getPages()[destIndex].getNote()))
-						.switchToAnotherLayoutPageOnClick(tau::common::LayoutPageID(TOP_PAGES_IDS[destIndex])));
+							currentLayoutState.getPages()[destIndex].getNote())
+						.switchToAnotherLayoutPageOnClick(tau::common::LayoutPageID(result.m_topPagesIDs[destIndex])));
 				} else {
 					return tau::layout_generation::EvenlySplitLayoutElementsContainer(false)
 						.push(tau::layout_generation::EmptySpace());
@@ -643,9 +1066,11 @@ namespace {
 
 			auto createReloadButtonSegmentWrappedInEvenlySplitLayoutElementsContainer = [&]() -> tau::layout_generation::EvenlySplitLayoutElementsContainer
 			{
+				auto const reloadButtonID = tau::common::ElementID(generateReloadButtonID());
+				registerButtonAction(reloadButtonID);
 				return tau::layout_generation::EvenlySplitLayoutElementsContainer(false)
 					.push(tau::layout_generation::UnevenlySplitElementsPair(
-						tau::layout_generation::ButtonLayoutElement().note("reload").ID(tau::common::ElementID(generateReloadButtonID())),
+						tau::layout_generation::ButtonLayoutElement().note("reload").ID(reloadButtonID),
 						tau::layout_generation::EmptySpace(), false, 0.75));
 			};
 
@@ -653,7 +1078,7 @@ namespace {
 			{
 				if (TOP_PAGES_COUNT > 1) {
 					return tau::layout_generation::EvenlySplitLayoutElementsContainer(false)
-						.push(tau::layout_generation::ButtonLayoutElement().note("*").switchToAnotherLayoutPageOnClick(pagesQuickJumpPageID)).ID(tau::common::ElementID(generateTrowawayTauIdentifier()));
+						.push(tau::layout_generation::ButtonLayoutElement().note("*").switchToAnotherLayoutPageOnClick(pagesQuickJumpPageID)).ID(tau::common::ElementID(generateTrowawayTauIdentifier("jumps"s + std::to_string(i))));
 				}
 				return tau::layout_generation::EvenlySplitLayoutElementsContainer(false)
 					.push(tau::layout_generation::EmptySpace());
@@ -672,19 +1097,20 @@ namespace {
 				, false
 				, 0.6);
 
+			auto const captionLabelID = tau::common::ElementID(generateTrowawayTauIdentifier("caption"s + std::to_string(i)));
+			result.m_topPagesCaptions.emplace_back(captionLabelID, selectedEnvCaptionPrefix + currentPreprocessedPagePresentation.getNote());
 			auto layoutDecorations = tau::layout_generation::UnevenlySplitElementsPair(
-				tau::layout_generation::LabelElement(
-					hat::core::escapeRawUTF8_forJson(selectedEnvCaptionPrefix + currentPreprocessedPagePresentation.getNote())),
+				tau::layout_generation::LabelElement(result.m_topPagesCaptions.back().second).ID(captionLabelID),
 				navigationButtons,
 				true, 0.4);
 
 			quickJumpPageButtonsContainer.push(
 				tau::layout_generation::ButtonLayoutElement().note(currentPreprocessedPagePresentation.getNote())
-				.switchToAnotherLayoutPageOnClick(TOP_PAGES_IDS[i]).ID(tau::common::ElementID{generateTrowawayTauIdentifier()})
+				.switchToAnotherLayoutPageOnClick(result.m_topPagesIDs[i]).ID(tau::common::ElementID{generateTrowawayTauIdentifier("jump"s + std::to_string(i))})
 			);
 			
 
-			m_currentNormalLayout.pushLayoutPage(tau::layout_generation::LayoutPage(currentPageID,
+			result.m_layout.pushLayoutPage(tau::layout_generation::LayoutPage(currentPageID,
 				tau::layout_generation::UnevenlySplitElementsPair(contents, layoutDecorations, true, 0.85)
 			));
 		}
@@ -693,15 +1119,15 @@ namespace {
 			auto const PIXELS_PER_BUTTON{ 75 }; // TODO: 14.08.2018 - make this value configurable through command line
 			auto quickJumpPage = tau::layout_generation::LayoutPage(pagesQuickJumpPageID, quickJumpPageButtonsContainer);
 			quickJumpPage.height((int)TOP_PAGES_COUNT * PIXELS_PER_BUTTON);
-			m_currentNormalLayout.pushLayoutPage(quickJumpPage);
+			result.m_layout.pushLayoutPage(quickJumpPage);
 		}
 
 		if ((TOP_PAGES_COUNT > 1) && (m_commandsConfig.getEnvironments().size() > 1)) {
-			m_lastTopPageSelected = TOP_PAGES_IDS.begin() + 1;
+			result.m_startPageIndex = 1;
 		} else {
-			m_lastTopPageSelected = TOP_PAGES_IDS.begin();
+			result.m_startPageIndex = 0;
 		}
-		m_currentNormalLayout.setStartLayoutPage(*m_lastTopPageSelected);
+		result.m_layout.setStartLayoutPage(result.m_topPagesIDs[result.m_startPageIndex]);
 
 		// We always add all the images as the layout-level references.
 		// This way we ensure that the images, which were passed to the client
@@ -709,20 +1135,49 @@ namespace {
 		// during the switching of environments.
 		auto allImageIds = m_imagesConfig.getAllRegisteredImageIDs();
 		for (auto & imageID : allImageIds) {
-			m_currentNormalLayout.addImageReference(tau::common::ImageID(imageID.getValue()));
+			result.m_layout.addImageReference(tau::common::ImageID(imageID.getValue()));
 		}
-		auto resultString = m_currentNormalLayout.getJson();
-		return resultString;
+		result.m_json = result.m_layout.getJson();
+		return result;
 	}
 
 	void Engine::layoutPageSwitched(tau::common::LayoutPageID const & pageID)
 	{
-		auto findResult = std::find(TOP_PAGES_IDS.begin(), TOP_PAGES_IDS.end(), pageID);
-		if (findResult != TOP_PAGES_IDS.end()) {
-			m_lastTopPageSelected = findResult;
+		if (!m_currentNormalLayout) {
+			return;
+		}
+		auto const & topPagesIndices = m_currentNormalLayout->m_topPagesIndices;
+		auto const findResult = topPagesIndices.find(pageID.getValue());
+		if (findResult != topPagesIndices.end()) {
+			m_lastTopPageSelected = findResult->second;
+		}
+	}
+
+	hat::core::FeedbackFromButtonClick Engine::layoutButtonClicked(tau::common::ElementID const & buttonID)
+	{
+		auto const & buttonIDValue = buttonID.getValue();
+		if (m_currentNormalLayout) {
+			auto const & buttonsActions = m_currentNormalLayout->m_buttonsActions;
+			auto const findResult = buttonsActions.find(buttonIDValue);
+			if (findResult != buttonsActions.end()) {
+				return buttonOnLayoutClicked(findResult->second);
+			}
 		}
+		return buttonOnLayoutClicked(buttonIDValue);
 	}
 	
+	void Engine::takeOverEnvironmentSelection(Engine const & previousEngine)
+	{
+		auto const canTakeOver = (previousEngine.m_currentState == LayoutState::NORMAL) && previousEngine.isEnv_selected
+			&& (previousEngine.m_commandsConfig.getEnvironments() == m_commandsConfig.getEnvironments());
+		if (canTakeOver) {
+			m_selectedEnvironment = previousEngine.m_selectedEnvironment;
+			isEnv_selected = true;
+			m_stickInfo = previousEngine.m_stickInfo;
+			m_shouldRebuildNormalLayout = true;
+		}
+	}
+
 	hat::core::ImageResourcesInfosContainer::ImagesInfoList Engine::getImagesPhysicalInfos() const
 	{
 		return m_imagesConfig.getAllRegisteredImages();
@@ -735,5 +1190,10 @@ namespace {
 		}
 		m_uiNotesUpdater = callback;
 	}
+
+	void Engine::setCommandsExecutionScheduler(CommandsExecutionScheduler scheduler)
+	{
+		m_commandsExecutionScheduler = scheduler;
+	}
 } //namespace tool
 } //namespace hat
\ No newline at end of file
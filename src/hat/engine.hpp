@@ -10,10 +10,14 @@
 #include "../hat-core/commands_data_extraction.hpp"
 #include "../hat-core/user_defined_layout.hpp"
 #include "../hat-core/configs_abstraction_layer.hpp"
+#include "../hat-core/configs_reload_cache.hpp"
+#include "input_backend.hpp"
 #include "../external_dependencies/robot/Source/Window.h"
 #include <tau/layout_generation/layout_info.h>
 
 #include <functional>
+#include <memory>
+#include <unordered_map>
 namespace hat {
 namespace tool {
 //TODO: refactor this class implementation
@@ -27,8 +31,54 @@ struct LoadingLayoutDataContainer {
 	{}
 };
 
+// The ways of using the precompiled configs bundle (see hat-core/config_bundle.hpp) during the configs loading:
+enum class ConfigBundleMode
+{
+	NONE,          // the bundle is not used, the text configs are always parsed
+	LOAD_IF_VALID, // the bundle is loaded, if it was compiled from exactly the same config files. Otherwise the text configs are parsed.
+	COMPILE        // the text configs are parsed, and the bundle is (re)written from the result
+};
+
 class Engine : public hat::core::AbstractEngine
 {
+public:
+	// The normal layout (the user-defined pages and the environment selection page), generated for one of the environments.
+	// The objects of this type are immutable after the generation, so they can be shared between the engine objects.
+	struct NormalLayout
+	{
+		std::vector<tau::common::LayoutPageID> m_topPagesIDs; // these are the pages, which are valid for restoring state to (other layout pages like the options selectors should not be restored to)
+		size_t m_startPageIndex{ 0 };
+		tau::layout_generation::LayoutInfo m_layout;
+		std::string m_json; // the json of the m_layout (with the m_startPageIndex page as the start page)
+
+		// A mapping of the variables to the list of layout element IDs, which display that variables.
+		std::map<hat::core::VariableID, std::vector<tau::common::ElementID>> m_displayedVariables;
+
+		// The data for updating the displayed layout by the notes changes (see Engine::getCurrentLayoutUpdate()):
+		hat::core::InternalLayoutRepresentation m_presentation; // the layout was generated from this object
+		std::vector<tau::common::ElementID> m_elementIDs; // the IDs of the m_presentation elements (in the order of hat::core::calculateLayoutNotesChanges()). The elements without IDs have empty values here.
+		std::vector<std::pair<tau::common::ElementID, std::string>> m_topPagesCaptions; // the labels with the captions of the top pages (the caption contains the name of the selected environment)
+
+		// The actions of the layout's buttons and the indices of the top pages by the values of their IDs (they are filled during the layout generation, so the clicks and the pages switches are processed with a single lookup).
+		std::unordered_map<std::string, hat::core::ButtonClickAction> m_buttonsActions;
+		std::unordered_map<std::string, size_t> m_topPagesIndices;
+
+		size_t calculateMemoryUsage() const;
+	};
+
+	// The data, which should be sent to the client for displaying the current layout.
+	struct LayoutUpdate
+	{
+		bool m_isFullLayout{ true }; // if the flag is not set, the client's layout should be updated by the m_notesChanges (the m_layoutJson is empty in this case)
+		std::string m_layoutJson;
+		std::vector<std::pair<tau::common::ElementID, std::string>> m_notesChanges;
+		std::shared_ptr<NormalLayout const> m_normalLayout; // the normal layout, which is displayed after the update (this is empty for the other layouts, like the window selection messages)
+	};
+
+	// Schedules the simulation of the command's input (the execution function) on another thread (see setCommandsExecutionScheduler()). Returns false, if the command could not be scheduled.
+	// The onExecuted callback should be called on the engine's thread after the input is simulated, and only if the engine object is still alive at that moment.
+	typedef std::function<bool(std::function<void()> const & execution, std::function<void()> const & onExecuted)> CommandsExecutionScheduler;
+private:
 	enum class LayoutState
 	{
 		NORMAL,
@@ -41,34 +91,44 @@ class Engine : public hat::core::AbstractEngine
 	bool m_stickEnvToWindow;
 	std::vector<ROBOT_NS::uintptr> m_stickInfo;
 	unsigned int m_keystrokes_delay;
+	std::shared_ptr<InputBackend> m_inputBackend; // the input of the commands is simulated through it (it is also used for getting the active window)
 	
+	CommandsExecutionScheduler m_commandsExecutionScheduler; // if it is not set, the commands are executed right away, on the engine's thread
+
 	// This is a simple callback function, which allows us to request UI updates on the client device (updates of the elements notes are done through this callback)
 	// We have to register this updater in separate step during engine initialisation step. This could be avoided if the change the hat::core::AbstractEngine into a template. This way we will be able to add 'tau' library's 'ElementID' type to the interface methods 'AbstractEngine', without adding to the hat::core project a dependency on 'tau'.
 	// TODO: try to rework the AbstractEngine into a template, which will make the engine code more streamlined and type-safe.
 	std::function<void (tau::common::ElementID const &, std::string)> m_uiNotesUpdater;
 
 	mutable bool m_shouldRebuildNormalLayout{ true };
-	mutable std::vector<tau::common::LayoutPageID> TOP_PAGES_IDS;
-	mutable tau::layout_generation::LayoutInfo m_currentNormalLayout;
-	mutable std::vector<tau::common::LayoutPageID>::const_iterator m_lastTopPageSelected;
-	
-	// A mapping of the variables to the list of layout element IDs, which display that variables.
-	// this map is auto-refreshed each time the normal layout is re-generated.
-	mutable std::map<hat::core::VariableID, std::vector<tau::common::ElementID>> m_currentlyDisplayedVariables;
-	
+	mutable std::shared_ptr<NormalLayout const> m_currentNormalLayout;
+	mutable size_t m_currentStartPageIndex{ 0 };
+	mutable size_t m_lastTopPageSelected{ 0 };
+
+	// The normal layouts for all the environments, which are generated eagerly during the engine creation (see the precomputeEnvironmentLayouts parameter of Engine::create()).
+	// This way switching the environments does not require the layout generation. The container is empty, if this is not enabled.
+	// Note: the values of the variables are a part of the layout, so the layout of the environment is regenerated, when they are changed.
+	mutable std::vector<std::shared_ptr<NormalLayout const>> m_precomputedNormalLayouts;
+
 	hat::core::LayoutUserInformation m_layoutInfo;
 	hat::core::CommandsInfoContainer m_commandsConfig;
 	hat::core::ImageResourcesInfosContainer m_imagesConfig;
+	std::shared_ptr<hat::core::ResolvedLayout const> m_resolvedLayout; // resolved once for the loaded configs (the engine copies have the same commands indices, so it is shared between them)
 
 	Engine(hat::core::LayoutUserInformation const & layoutInfo,
 		hat::core::CommandsInfoContainer const & commandsConfig,
 		hat::core::ImageResourcesInfosContainer const & imagesConfig,
-		bool stickEnvToWindow, unsigned int keystrokes_delay);
+		bool stickEnvToWindow, unsigned int keystrokes_delay, std::shared_ptr<InputBackend> const & inputBackend);
 
 	bool shouldShowEnvironmentSelectionPage() const;
-	std::string getCurrentLayoutJson_normal() const;
+	NormalLayout generateNormalLayout(size_t environmentIndex, bool isEnvironmentSelected) const;
+	void precomputeNormalLayouts();
+	LayoutUpdate getCurrentLayoutUpdate_normal(std::shared_ptr<NormalLayout const> const & displayedLayout) const;
+	std::string getCurrentLayoutJson_normalWithoutRebuild() const;
 	std::string getCurrentLayoutJson_wrongTopWindowMessage() const;
 	std::string getCurrentLayoutJson_waitForTopWindowInfo() const;
+	std::function<void()> createInputExecution(std::shared_ptr<hat::core::AbstractSimulatedUserInput> const & input) const; // the function, which simulates the input (it does not use the engine object, so it could be called on another thread)
+	void applyExecutedCommandToVariables(size_t commandIndex, size_t environmentIndex); // updates the variables (and their labels on the client) after the command's input was simulated
 
 protected:
 	bool setNewEnvironment(size_t envIndex) override;
@@ -79,13 +139,24 @@ protected:
 	virtual void switchLayout_restoreToNormalLayout() override;
 public:
 	std::string getCurrentLayoutJson() const;
+	// If the displayedLayout (the normal layout, which is currently displayed on the client) has the same structure as the current layout, the update contains only the changed notes.
+	// Note: the notes changes can't update the enabled state of the buttons (the client can't change it without the layout reset), so such changes are sent as the full layout.
+	LayoutUpdate getCurrentLayoutUpdate(std::shared_ptr<NormalLayout const> const & displayedLayout) const;
 	void addNoteUpdatingFeedbackCallback(std::function<void (tau::common::ElementID const &, std::string)> callback);
+	void setCommandsExecutionScheduler(CommandsExecutionScheduler scheduler);
+	// The buttons of the current normal layout are dispatched through its table of the actions. The IDs of the other buttons (the ones of the service layouts, for example) are decoded on the spot.
+	hat::core::FeedbackFromButtonClick layoutButtonClicked(tau::common::ElementID const & buttonID);
 	void layoutPageSwitched(tau::common::LayoutPageID const & pageID);
+	// Takes over the selected environment from the engine, which served the client before the configs were reloaded (if the list of the environments was not changed).
+	// This way the client's layout could be updated by the notes changes, if the new configs have the same layout structure (see getCurrentLayoutUpdate()).
+	void takeOverEnvironmentSelection(Engine const & previousEngine);
 	
 	hat::core::ImageResourcesInfosContainer::ImagesInfoList getImagesPhysicalInfos() const;
 	
 	static bool canStickToWindows();
-	static Engine create(std::string const & commandsCSV, std::vector<std::string> const & inputSequencesConfigs, std::vector<std::string> const & variablesManagersSetupConfigs, std::string const & imageResourcesConfig, std::string const & imageId2CommandIdConfig, std::string const & layoutConfig, bool stickEnvToWindow, unsigned int keyboard_intervals, std::function<void(std::string const &, std::string const &)> loggingCallback);
+	// Note: the reloadCache holds the results of the previous loading (see hat::core::ConfigsReloadCache). The input objects stored there are created for the given keyboard_intervals value and inputBackend, so the cache should not be shared between the calls with different values of them.
+	// If the precomputeEnvironmentLayouts flag is set, the layouts for all the environments are generated in parallel right after the configs are loaded (this makes the environments switching faster, but takes more memory).
+	static Engine create(std::string const & commandsCSV, std::vector<std::string> const & inputSequencesConfigs, std::vector<std::string> const & variablesManagersSetupConfigs, std::string const & imageResourcesConfig, std::string const & imageId2CommandIdConfig, std::string const & layoutConfig, bool stickEnvToWindow, unsigned int keyboard_intervals, std::string const & configBundlePath, ConfigBundleMode configBundleMode, hat::core::ConfigsReloadCache & reloadCache, bool precomputeEnvironmentLayouts, std::shared_ptr<InputBackend> const & inputBackend, std::function<void(std::string const &, std::string const &)> loggingCallback);
 	
 	static LoadingLayoutDataContainer const & getLayoutJson_loadingConfigsSplashscreen();
 	//Platform-independent sleep operation
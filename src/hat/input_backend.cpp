@@ -0,0 +1,313 @@
+// This source file is part of the 'hat' open source project.
+// Copyright (c) 2016, Yuriy Vosel.
+// Licensed under Boost Software License.
+// See LICENSE.txt for the licence information.
+
+#include "input_backend.hpp"
+#include "xtest_keyboard_input.hpp"
+#include "../external_dependencies/robot/Source/Timer.h"
+
+#include <algorithm>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#ifdef HAT_WINDOWS_SCANCODES_SUPPORT
+#include <windows.h>
+#endif
+#ifdef __linux__
+#include <time.h>
+#include <cerrno>
+#include <X11/Xlib.h>
+#endif
+namespace hat {
+namespace tool {
+#ifdef HAT_WINDOWS_SCANCODES_SUPPORT
+extern bool SHOULD_USE_SCANCODES;
+#endif
+#ifdef HAT_XTEST_INPUT_SUPPORT
+extern bool SHOULD_BATCH_KEYBOARD_INPUT;
+#endif
+
+namespace {
+	// Blocks until the deadline. On linux the absolute deadline is passed to clock_nanosleep(), so the wake-up time does not depend on the time, which was spent before the call.
+	// Note: the std::chrono::steady_clock is based on the CLOCK_MONOTONIC clock there, so its time points are converted directly.
+	void sleepUntilDeadline(std::chrono::steady_clock::time_point const & deadline)
+	{
+#ifdef __linux__
+		auto const sinceEpoch = deadline.time_since_epoch();
+		auto const seconds = std::chrono::duration_cast<std::chrono::seconds>(sinceEpoch);
+		auto deadlineSpec = timespec{};
+		deadlineSpec.tv_sec = static_cast<time_t>(seconds.count());
+		deadlineSpec.tv_nsec = static_cast<long>(std::chrono::duration_cast<std::chrono::nanoseconds>(sinceEpoch - seconds).count());
+		while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadlineSpec, nullptr) == EINTR) {
+		}
+#else
+		std::this_thread::sleep_until(deadline);
+#endif
+	}
+
+#ifdef HAT_WINDOWS_SCANCODES_SUPPORT
+	void simulateKeyboardEventWithScanCode(std::pair<bool, ROBOT_NS::Key> const & keyboardEvent)
+	{
+		bool isExtendedKey =
+			(keyboardEvent.second == VK_UP) ||
+			(keyboardEvent.second == VK_DOWN) ||
+			(keyboardEvent.second == VK_LEFT) ||
+			(keyboardEvent.second == VK_RIGHT) ||
+			(keyboardEvent.second == VK_HOME) ||
+			(keyboardEvent.second == VK_END) ||
+			(keyboardEvent.second == VK_PRIOR) ||
+			(keyboardEvent.second == VK_NEXT) ||
+			(keyboardEvent.second == VK_INSERT) ||
+			(keyboardEvent.second == VK_DELETE);
+
+		INPUT input = { 0 };
+		input.type = INPUT_KEYBOARD;
+		// Calculate scan-code from the Robot's virtual key code:
+		input.ki.wScan = MapVirtualKey(keyboardEvent.second, MAPVK_VK_TO_VSC);
+		input.ki.dwFlags = (keyboardEvent.first) ?
+			KEYEVENTF_SCANCODE : (KEYEVENTF_SCANCODE | KEYEVENTF_KEYUP);
+		if (isExtendedKey) {
+			input.ki.dwFlags |= KEYEVENTF_EXTENDEDKEY;
+		}
+
+		SendInput (1, &input, sizeof (INPUT));
+	}
+#endif
+
+#if defined(HAT_WINDOWS_SCANCODES_SUPPORT) && !defined(HAT_XTEST_INPUT_SUPPORT)
+	// Types the text through the unicode keyboard events, so the characters do not depend on the keyboard layout.
+	// The events of each chunk of the text are passed to the system in one call. The keystrokes delay is done between the chunks.
+	void typeTextWithUnicodeEvents(std::u32string const & text, unsigned int keystrokesDelay)
+	{
+		size_t const chunkSize = 32;
+		auto events = std::vector<INPUT>{};
+		auto const addCodeUnit = [&events](WORD codeUnit) {
+			INPUT input = { 0 };
+			input.type = INPUT_KEYBOARD;
+			input.ki.wScan = codeUnit;
+			input.ki.dwFlags = KEYEVENTF_UNICODE;
+			events.push_back(input);
+			input.ki.dwFlags = KEYEVENTF_UNICODE | KEYEVENTF_KEYUP;
+			events.push_back(input);
+		};
+		for (size_t chunkStart = 0; chunkStart < text.size(); chunkStart += chunkSize) {
+			events.clear();
+			for (size_t i = chunkStart; i < (std::min)(text.size(), chunkStart + chunkSize); ++i) {
+				auto const character = text[i];
+				if (character >= 0x10000) { // the surrogate pair
+					addCodeUnit(static_cast<WORD>(0xD800 + ((character - 0x10000) >> 10)));
+					addCodeUnit(static_cast<WORD>(0xDC00 + ((character - 0x10000) & 0x3FF)));
+				} else {
+					addCodeUnit(static_cast<WORD>(character));
+				}
+			}
+			SendInput(static_cast<UINT>(events.size()), events.data(), sizeof(INPUT));
+			if ((keystrokesDelay > 0) && ((chunkStart + chunkSize) < text.size())) {
+				ROBOT_NS::Timer::Sleep(keystrokesDelay);
+			}
+		}
+	}
+#endif
+}
+
+void prepareInputSimulationForMultipleThreads()
+{
+#ifdef __linux__
+	if (XInitThreads() == 0) {
+		std::cerr << "WARNING: Xlib could not be initialized for the multithreaded use. The simulated input could be corrupted, if the stick to window option is used.\n";
+	}
+#endif
+}
+
+void RobotInputBackend::simulateKeys(ROBOT_NS::KeyList const & keys, unsigned int keystrokesDelay)
+{
+#ifdef HAT_XTEST_INPUT_SUPPORT
+	if (SHOULD_BATCH_KEYBOARD_INPUT) {
+		XTestKeyboardInput::getInstance().simulate(keys, keystrokesDelay);
+		return;
+	}
+#endif
+#ifdef HAT_WINDOWS_SCANCODES_SUPPORT
+	//optional behaviour:
+	if (SHOULD_USE_SCANCODES) {
+		for (auto const & keyboardEvent : keys) {
+			simulateKeyboardEventWithScanCode(keyboardEvent);
+			sleep(keystrokesDelay);
+		}
+		return;
+	}
+#endif
+	//default behaviour:
+	auto keyboard = ROBOT_NS::Keyboard{};
+	keyboard.AutoDelay = keystrokesDelay;
+	for (auto const & keyboardEvent : keys) {
+		(keyboardEvent.first) ? keyboard.Press(keyboardEvent.second) : keyboard.Release(keyboardEvent.second);
+	}
+}
+
+bool RobotInputBackend::canTypeText() const
+{
+#if defined(HAT_XTEST_INPUT_SUPPORT) || defined(HAT_WINDOWS_SCANCODES_SUPPORT)
+	return true;
+#else
+	return false;
+#endif
+}
+
+// The text is typed by the fastest way available on the platform (see XTestKeyboardInput::typeText() and typeTextWithUnicodeEvents()).
+void RobotInputBackend::typeText(std::u32string const & text, unsigned int keystrokesDelay)
+{
+#ifdef HAT_XTEST_INPUT_SUPPORT
+	XTestKeyboardInput::getInstance().typeText(text, keystrokesDelay);
+#elif defined(HAT_WINDOWS_SCANCODES_SUPPORT)
+	typeTextWithUnicodeEvents(text, keystrokesDelay);
+#endif
+}
+
+void RobotInputBackend::clickMouse(ROBOT_NS::Button button, ROBOT_NS::Point const & position)
+{
+	ROBOT_NS::Mouse mouse;
+	mouse.SetPos(position);
+	mouse.Click(button);
+}
+
+void RobotInputBackend::scrollMouse(bool isVertical, int amount, unsigned int delayAfterScroll)
+{
+	ROBOT_NS::Mouse mouse;
+	if (isVertical) {
+		mouse.AutoDelay = delayAfterScroll;
+		mouse.ScrollV(amount);
+		return;
+	}
+	// Note: this is a workaround for the horizontal scroll. We can't just call mouse.ScrollH(amount) here because of the issue in the windows implementation of horizontal scrolling.
+	// It turns out, that the sendInput() function does not simulate horizontal scroll for several clicks (it assumes that it is the 'wheel tilt' operations)
+	// So, the robot's ScrollH() function will act incorrectly here - it will alwyas scroll one unit, regardless to the actual integer value, which is passed to it.
+	// Caution: This workaround could become very slow. For big numbers it will lock up the hat tool for quite a long time (simulation of each of the scrolling operations is quite slow).
+	// TODO: remove this workaround after the scrolH() is fixed in the robot library.
+	// Link for the issue on github: https://github.com/Robot/robot/issues/92
+	if (amount != 0) {
+		auto iterationsCount = (amount > 0) ? amount : -amount;
+		auto scrollDirection = (amount > 0) ? 1 : -1;
+		for (int i = 0; i < iterationsCount; ++i) {
+			mouse.ScrollH(scrollDirection);
+		}
+	}
+	sleep(delayAfterScroll);
+}
+
+void RobotInputBackend::sleep(unsigned int millisec)
+{
+	ROBOT_NS::Timer::Sleep(millisec);
+}
+
+void RobotInputBackend::sleepUntil(std::chrono::steady_clock::time_point const & deadline)
+{
+	sleepUntilDeadline(deadline);
+}
+
+ROBOT_NS::uintptr RobotInputBackend::getActiveWindowHandle()
+{
+	return ROBOT_NS::Window::GetActive().GetHandle();
+}
+
+RecordingInputBackend::RecordingInputBackend(size_t capacity)
+	: m_recorder(capacity)
+{
+}
+
+void RecordingInputBackend::simulateKeys(ROBOT_NS::KeyList const & keys, unsigned int keystrokesDelay)
+{
+	for (auto const & keyboardEvent : keys) {
+		m_recorder.record(keyboardEvent.first ? core::RecordedInputEvent::Type::KEY_PRESS : core::RecordedInputEvent::Type::KEY_RELEASE, static_cast<int64_t>(keyboardEvent.second));
+		if (keystrokesDelay > 0) {
+			sleep(keystrokesDelay);
+		}
+	}
+}
+
+bool RecordingInputBackend::canTypeText() const
+{
+	return true;
+}
+
+// Note: the keystrokes delay is done after each character here (the real backends do it between the chunks of the text).
+void RecordingInputBackend::typeText(std::u32string const & text, unsigned int keystrokesDelay)
+{
+	for (auto const character : text) {
+		m_recorder.record(core::RecordedInputEvent::Type::TEXT_CHARACTER, static_cast<int64_t>(character));
+		if (keystrokesDelay > 0) {
+			sleep(keystrokesDelay);
+		}
+	}
+}
+
+void RecordingInputBackend::clickMouse(ROBOT_NS::Button button, ROBOT_NS::Point const & position)
+{
+	m_recorder.record(core::RecordedInputEvent::Type::MOUSE_MOVE, (static_cast<int64_t>(position.X) << 32) | static_cast<uint32_t>(position.Y));
+	m_recorder.record(core::RecordedInputEvent::Type::MOUSE_CLICK, static_cast<int64_t>(button));
+}
+
+void RecordingInputBackend::scrollMouse(bool isVertical, int amount, unsigned int delayAfterScroll)
+{
+	m_recorder.record(isVertical ? core::RecordedInputEvent::Type::MOUSE_SCROLL_V : core::RecordedInputEvent::Type::MOUSE_SCROLL_H, amount);
+	sleep(delayAfterScroll);
+}
+
+void RecordingInputBackend::sleep(unsigned int millisec)
+{
+	m_recorder.record(core::RecordedInputEvent::Type::SLEEP, static_cast<int64_t>(millisec) * 1000);
+	std::this_thread::sleep_for(std::chrono::milliseconds{ millisec });
+}
+
+void RecordingInputBackend::sleepUntil(std::chrono::steady_clock::time_point const & deadline)
+{
+	auto const now = std::chrono::steady_clock::now();
+	auto const duration = std::chrono::duration_cast<std::chrono::microseconds>(deadline - now);
+	m_recorder.record(core::RecordedInputEvent{ core::RecordedInputEvent::Type::SLEEP, (std::max)(duration.count(), static_cast<decltype(duration.count())>(0)), now });
+	sleepUntilDeadline(deadline);
+}
+
+ROBOT_NS::uintptr RecordingInputBackend::getActiveWindowHandle()
+{
+	return 0;
+}
+
+uint64_t RecordingInputBackend::commandRequested()
+{
+	auto const requestID = ++m_lastRequestID;
+	m_recorder.record(core::RecordedInputEvent::Type::COMMAND_REQUESTED, static_cast<int64_t>(requestID));
+	return requestID;
+}
+
+void RecordingInputBackend::commandExecutionStarted(uint64_t requestID)
+{
+	m_recorder.record(core::RecordedInputEvent::Type::COMMAND_STARTED, static_cast<int64_t>(requestID));
+}
+
+void RecordingInputBackend::commandExecutionFinished(uint64_t requestID)
+{
+	m_recorder.record(core::RecordedInputEvent::Type::COMMAND_FINISHED, static_cast<int64_t>(requestID));
+	auto const statistics = m_recorder.getStatistics();
+	if (statistics.m_commandsCount == 0) {
+		std::cout << "Recorded input: the requests of the executed commands were not kept (too many commands were requested before their execution).\n";
+		return;
+	}
+	auto const toMicroseconds = [](std::chrono::nanoseconds duration) { return std::chrono::duration_cast<std::chrono::microseconds>(duration).count(); };
+	auto const executionTime = std::chrono::duration<double>(statistics.m_totalExecutionTime).count();
+	std::cout << "Recorded input: " << m_recorder.getRecordedCount() << " event(s) in total. " << statistics.m_commandsCount << " command(s) executed, "
+		<< statistics.m_inputEventsCount << " input event(s) during their execution";
+	if (executionTime > 0) {
+		std::cout << " (" << static_cast<size_t>(statistics.m_inputEventsCount / executionTime) << " events per second)";
+	}
+	std::cout << ".";
+	if (statistics.m_latenciesCount > 0) {
+		std::cout << " Latency from the request to the first input event: min " << toMicroseconds(statistics.m_minLatency) << " us, max " << toMicroseconds(statistics.m_maxLatency)
+			<< " us, average " << toMicroseconds(statistics.m_totalLatency / statistics.m_latenciesCount) << " us.";
+	}
+	std::cout << "\n";
+}
+
+} // namespace tool
+} // namespace hat
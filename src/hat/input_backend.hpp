@@ -0,0 +1,88 @@
+// This source file is part of the 'hat' open source project.
+// Copyright (c) 2016, Yuriy Vosel.
+// Licensed under Boost Software License.
+// See LICENSE.txt for the licence information.
+
+#ifndef HAT_INPUT_BACKEND_HPP
+#define HAT_INPUT_BACKEND_HPP
+
+#include "../hat-core/input_events_recorder.hpp"
+#include "../external_dependencies/robot/Source/Keyboard.h"
+#include "../external_dependencies/robot/Source/Mouse.h"
+#include "../external_dependencies/robot/Source/Window.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace hat {
+namespace tool {
+
+// The interface for simulating the user input. The input objects, which are created by the engine (see Engine::create()), send all their input through it.
+// Note: the input methods are called on the commands execution thread. The getActiveWindowHandle() and commandRequested() methods are called on the thread, which serves the connections.
+class InputBackend
+{
+public:
+	virtual ~InputBackend() = default;
+
+	virtual void simulateKeys(ROBOT_NS::KeyList const & keys, unsigned int keystrokesDelay) = 0;
+	virtual bool canTypeText() const = 0;
+	virtual void typeText(std::u32string const & text, unsigned int keystrokesDelay) = 0;
+	virtual void clickMouse(ROBOT_NS::Button button, ROBOT_NS::Point const & position) = 0;
+	virtual void scrollMouse(bool isVertical, int amount, unsigned int delayAfterScroll) = 0;
+	virtual void sleep(unsigned int millisec) = 0;
+	virtual void sleepUntil(std::chrono::steady_clock::time_point const & deadline) = 0;
+	virtual ROBOT_NS::uintptr getActiveWindowHandle() = 0;
+
+	// The notifications about the commands processing. The commandRequested() returns the id of the request, which is passed to the other two methods.
+	// Note: the execution of the command could be never started (if it was dropped, because too many commands are waiting for the execution).
+	virtual uint64_t commandRequested() { return 0; };
+	virtual void commandExecutionStarted(uint64_t requestID) {};
+	virtual void commandExecutionFinished(uint64_t requestID) {};
+};
+
+// The Robot library is used from 2 threads: the input is simulated on the commands execution thread, while the active window is requested on the thread, which serves the connections.
+// On linux this function makes the Xlib calls thread-safe (see XInitThreads()). It should be called at the start of the program, before any other call to the Robot library.
+void prepareInputSimulationForMultipleThreads();
+
+// Sends the input to the system through the Robot library (or through the platform specific ways, if they are enabled - see the '--useScanCodes' and '--batchKeyboardInput' options).
+class RobotInputBackend : public InputBackend
+{
+public:
+	void simulateKeys(ROBOT_NS::KeyList const & keys, unsigned int keystrokesDelay) override;
+	bool canTypeText() const override;
+	void typeText(std::u32string const & text, unsigned int keystrokesDelay) override;
+	void clickMouse(ROBOT_NS::Button button, ROBOT_NS::Point const & position) override;
+	void scrollMouse(bool isVertical, int amount, unsigned int delayAfterScroll) override;
+	void sleep(unsigned int millisec) override;
+	void sleepUntil(std::chrono::steady_clock::time_point const & deadline) override;
+	ROBOT_NS::uintptr getActiveWindowHandle() override;
+};
+
+// Records the input events with their timestamps instead of sending them to the system, so the tool could be run without the display (for the benchmarks and the tests).
+// The delays and the sleeps are done as usual, so the timings are the same as with the real input. The active window is always the same (its handle is 0).
+// After each command the statistics of the recorded commands is printed (it is updated during the recording, see core::InputEventsRecorder::getStatistics()).
+class RecordingInputBackend : public InputBackend
+{
+	core::InputEventsRecorder m_recorder;
+	std::atomic<uint64_t> m_lastRequestID{ 0 };
+public:
+	explicit RecordingInputBackend(size_t capacity); // the capacity of the events ring buffer
+	void simulateKeys(ROBOT_NS::KeyList const & keys, unsigned int keystrokesDelay) override;
+	bool canTypeText() const override;
+	void typeText(std::u32string const & text, unsigned int keystrokesDelay) override;
+	void clickMouse(ROBOT_NS::Button button, ROBOT_NS::Point const & position) override;
+	void scrollMouse(bool isVertical, int amount, unsigned int delayAfterScroll) override;
+	void sleep(unsigned int millisec) override;
+	void sleepUntil(std::chrono::steady_clock::time_point const & deadline) override;
+	ROBOT_NS::uintptr getActiveWindowHandle() override;
+	uint64_t commandRequested() override;
+	void commandExecutionStarted(uint64_t requestID) override;
+	void commandExecutionFinished(uint64_t requestID) override;
+};
+
+} // namespace tool
+} // namespace hat
+
+#endif //HAT_INPUT_BACKEND_HPP
@@ -7,13 +7,23 @@
 #include <tau/util/boost_asio_server.h>
 
 #include "engine.hpp"
+#include "commands_execution_thread.hpp"
 #ifdef HAT_IMAGES_SUPPORT
 #include "images_loader.hpp"
 #endif // HAT_IMAGES_SUPPORT
+#ifdef HAT_CONFIG_FILES_WATCHING_SUPPORT
+#include "config_files_watcher.hpp"
+#endif // HAT_CONFIG_FILES_WATCHING_SUPPORT
+#ifdef HAT_XTEST_INPUT_SUPPORT
+#include "xtest_keyboard_input.hpp"
+#endif // HAT_XTEST_INPUT_SUPPORT
 #include <set>
 #include <iostream>
 #include <memory>
 #include <deque>
+#include <mutex>
+#include <algorithm>
+#include <iterator>
 
 #include <boost/program_options/options_description.hpp>
 #include <boost/program_options/variables_map.hpp>
@@ -26,31 +36,67 @@ std::string IMAGE_RESOURCES_CONFIG_PATH;
 std::string COMMAND_ID_TO_IMAGE_ID_CONFIG_PATH;
 std::vector<std::string> INPUT_SEQUENCES_CFG_PATHS;
 std::vector<std::string> VARIABLE_MANAGERS_CFG_PATHS;
+std::string CONFIG_BUNDLE_PATH;
+ConfigBundleMode CONFIG_BUNDLE_MODE = ConfigBundleMode::NONE;
+hat::core::ConfigsReloadCache CONFIGS_RELOAD_CACHE; // shared between all the connections and the config files watcher (see createEngine() below)
+std::mutex CONFIGS_RELOAD_CACHE_MUTEX;
 bool STICK_ENV_TO_WINDOW = false;
 unsigned int KEYSTROKES_DELAY = 0;
+bool PRECOMPUTE_ENVIRONMENT_LAYOUTS = false;
+std::shared_ptr<InputBackend> INPUT_BACKEND = std::make_shared<RobotInputBackend>(); // replaced by the RecordingInputBackend, if the '--recordInput' option is set
 #ifdef HAT_WINDOWS_SCANCODES_SUPPORT
 extern bool SHOULD_USE_SCANCODES = false;
 #endif
+#ifdef HAT_XTEST_INPUT_SUPPORT
+bool SHOULD_BATCH_KEYBOARD_INPUT = false;
+#endif // HAT_XTEST_INPUT_SUPPORT
 
 #ifdef HAT_WINDOWS_CONSOLE_HIDING_FEATURE_SUPPORTED
 extern bool SHOULD_HIDE_CONSOLE_WHEN_CLIENTS_ARE_CONNECTED = false;
 #endif //HAT_WINDOWS_CONSOLE_HIDING_FEATURE_SUPPORTED
+#ifdef HAT_CONFIG_FILES_WATCHING_SUPPORT
+bool WATCH_CONFIG_FILES = false;
+#endif //HAT_CONFIG_FILES_WATCHING_SUPPORT
+size_t const COMMANDS_EXECUTION_QUEUE_CAPACITY = 16;
+CommandsExecutionThread * COMMANDS_EXECUTION_THREAD = nullptr; // created in main() together with the io_service, to which it posts the results of the commands execution
+
+// Creates the engine object from the config files, which were specified in the command line.
+// Note: this function could be called from the config files watcher's thread, so the access to the reload cache is synchronized.
+// The layouts for the environments are precomputed only if the engine is going to be used for serving the clients (and the user requested this).
+Engine createEngine(bool isUsedForServingClients, std::function<void(std::string const &, std::string const &)> loggingCallback)
+{
+	std::lock_guard<std::mutex> reloadCacheLock(CONFIGS_RELOAD_CACHE_MUTEX);
+	return Engine::create(COMMANDS_CONFIG_PATH, INPUT_SEQUENCES_CFG_PATHS, VARIABLE_MANAGERS_CFG_PATHS, IMAGE_RESOURCES_CONFIG_PATH, COMMAND_ID_TO_IMAGE_ID_CONFIG_PATH, LAYOUT_CONFIG_PATH, STICK_ENV_TO_WINDOW, KEYSTROKES_DELAY, CONFIG_BUNDLE_PATH, CONFIG_BUNDLE_MODE, CONFIGS_RELOAD_CACHE, isUsedForServingClients && PRECOMPUTE_ENVIRONMENT_LAYOUTS, INPUT_BACKEND, loggingCallback);
+}
 
+// The configs, which were reloaded in the background (after the config files were changed).
+// The same object is applied to all the connections: each of them gets its own copy of the engine.
+struct BackgroundReloadResult
+{
+	std::shared_ptr<Engine const> m_engine;
+#ifdef HAT_IMAGES_SUPPORT
+	ImageBuffersList m_loadedImages;
+#endif // HAT_IMAGES_SUPPORT
+};
 
 class MyEventsDispatcher;
 namespace {
 	bool MONITOR_CONNECTIONS_WITH_HEARTBEATS = true;
+	auto const RELOADING_ERROR_DISPLAYING_INTERVAL = boost::posix_time::seconds{10}; // the error of the background configs reloading is shown for this time
 	size_t const UNANSWERED_HEARTBEATS_LIMIT = 5; //after we send this amount of heartbeats without receiving a reply, we should assume that the connection is no longer active.
 	void connectionEstablished(MyEventsDispatcher * dispatcherForTheConnection);
 	void connectionClosed(MyEventsDispatcher * dispatcherForTheConnection);
 }
 class MyEventsDispatcher : public tau::util::BasicEventsDispatcher
 {
-	std::unique_ptr<Engine> m_engine;
+	std::shared_ptr<Engine> m_engine; // Note: the engine is owned only by this object. The shared pointer is used for tracking the engine's lifetime from the commands execution thread (see addCommandsExecutionScheduler()).
+	// The normal layout, which is currently displayed on the client (empty, if the client displays some other layout). The layout updates are calculated against it.
+	std::shared_ptr<Engine::NormalLayout const> m_displayedNormalLayout;
 
 	// This variable is used to establish, if the connection is still alive. So, if we receive any packet from the client, this variable is set to 0 (we don't actually need to account for all of the heartbeat packets, we just try to make sure that the client device is still active)
 	size_t m_unanswered_heartbeats_counter;
 	bool m_should_reupload_images {true};
+	bool m_isDisplayingReloadingError{ false }; // the error of the background configs reloading is shown instead of the layout
 #ifdef HAT_IMAGES_SUPPORT
 	ImageBuffersList m_loadedImagesForConfig{};
 #endif// HAT_IMAGES_SUPPORT
@@ -72,7 +118,7 @@ public:
 		tau::common::ElementID const & buttonID) override
 	{
 		m_unanswered_heartbeats_counter = 0;
-		switch (m_engine->buttonOnLayoutClicked(buttonID.getValue())) {
+		switch (m_engine->layoutButtonClicked(buttonID)) {
 		case hat::core::FeedbackFromButtonClick::RELOAD_CONFIGS:
 			if (!reloadConfigs()) {
 				std::cerr << "Configuration parsing failed. The layout will not be renewed.\n";
@@ -129,13 +175,75 @@ public:
 			sendPacket_heartbeat();
 		}
 	}
+	// The configs were successfully reloaded in the background. The new layout is sent without showing the loading splashscreen.
+	void configsReloadedInBackground(BackgroundReloadResult const & reloadResult)
+	{
+		if (!m_engine) {
+			return; // the initial loading for this connection was not finished yet
+		}
+		auto newEngine = std::make_unique<Engine>(*reloadResult.m_engine);
+		newEngine->takeOverEnvironmentSelection(*m_engine);
+		m_engine = std::move(newEngine);
+		addNoteUpdatingFeedbackCallback(*m_engine);
+		addCommandsExecutionScheduler();
+#ifdef HAT_IMAGES_SUPPORT
+		m_loadedImagesForConfig = reloadResult.m_loadedImages;
+#endif // HAT_IMAGES_SUPPORT
+		m_should_reupload_images = true;
+		m_isDisplayingReloadingError = false;
+		refreshLayout();
+	}
+	// The background reloading of the changed configs failed. The error is shown on the loading splashscreen, until the previous layout is restored (see restoreLayoutAfterReloadingError()).
+	// Note: the configs are not reloaded here, so the io_service is not blocked.
+	void configsReloadingInBackgroundFailed(std::string const & errorMessage)
+	{
+		if (!m_engine) {
+			return;
+		}
+		auto const & loadingLayoutInfo = Engine::getLayoutJson_loadingConfigsSplashscreen();
+		sendPacket_resetLayout(loadingLayoutInfo.layoutJson);
+		m_displayedNormalLayout.reset();
+		m_isDisplayingReloadingError = true;
+		sendPacket_changeElementNote(loadingLayoutInfo.generalLoadingStepsLogLabel, "load log:\\n!!!\\nError during loading config files. The layout will be restored to previous state in " + std::to_string(RELOADING_ERROR_DISPLAYING_INTERVAL.total_seconds()) + " seconds!");
+		sendPacket_changeElementNote(loadingLayoutInfo.particularFilesLogLabel, hat::core::escapeRawUTF8_forJson_replacingInvalid(errorMessage));
+	}
+	void restoreLayoutAfterReloadingError()
+	{
+		if (!m_isDisplayingReloadingError) {
+			return; // the layout was already refreshed (for example, the configs were reloaded successfully after the error)
+		}
+		m_isDisplayingReloadingError = false;
+		refreshLayout();
+	}
 private:
+	void addNoteUpdatingFeedbackCallback(Engine & engine)
+	{
+		engine.addNoteUpdatingFeedbackCallback([this](tau::common::ElementID const & elementToUpdate, std::string const & newTextValue) {
+			sendPacket_changeElementNote(elementToUpdate, newTextValue);
+		});
+	}
+	// The input of the commands is simulated on the commands execution thread. The variables are updated after that, back on the io_service thread (if the engine was not replaced or destroyed in the meantime).
+	void addCommandsExecutionScheduler()
+	{
+		if (COMMANDS_EXECUTION_THREAD == nullptr) {
+			return;
+		}
+		auto const engine = std::weak_ptr<Engine>(m_engine);
+		m_engine->setCommandsExecutionScheduler([engine](std::function<void()> const & execution, std::function<void()> const & onExecuted) {
+			return COMMANDS_EXECUTION_THREAD->tryPush(execution, [engine, onExecuted]() {
+				if (!engine.expired()) {
+					onExecuted();
+				}
+			});
+		});
+	}
 	bool reloadConfigs()
 	{
 		auto temporaryEngineObject = std::unique_ptr<Engine>{};
 		try {
 			auto loadingLayoutInfo = Engine::getLayoutJson_loadingConfigsSplashscreen();
 			sendPacket_resetLayout(loadingLayoutInfo.layoutJson);
+			m_displayedNormalLayout.reset();
 			std::string mainLoadingLogText = "load log:";
 			auto particularFilesLogTail = std::deque<std::string>{};
 
@@ -179,11 +287,8 @@ private:
 			refresh_main_loading_log(mainLoadingLogText);
 
 			try {
-				temporaryEngineObject = std::make_unique<Engine>(Engine::create(COMMANDS_CONFIG_PATH, INPUT_SEQUENCES_CFG_PATHS, VARIABLE_MANAGERS_CFG_PATHS, IMAGE_RESOURCES_CONFIG_PATH, COMMAND_ID_TO_IMAGE_ID_CONFIG_PATH, LAYOUT_CONFIG_PATH, STICK_ENV_TO_WINDOW, KEYSTROKES_DELAY, add_line_to_client_onscreen_log));
-				temporaryEngineObject->addNoteUpdatingFeedbackCallback([this](tau::common::ElementID const & elementToUpdate, std::string const & newTextValue) {
-					sendPacket_changeElementNote(elementToUpdate, newTextValue);
-				
-				});
+				temporaryEngineObject = std::make_unique<Engine>(createEngine(true, add_line_to_client_onscreen_log));
+				addNoteUpdatingFeedbackCallback(*temporaryEngineObject);
 			} catch (std::runtime_error & e) {
 				std::cerr << "\n --- Error during reading of the config files:\n" << e.what() << "\n";
 
@@ -221,6 +326,7 @@ private:
 		// No errors occured during loading of the configs and images.
 		// Replacing the old engine with the newely created one.
 		m_engine = std::move(temporaryEngineObject);
+		addCommandsExecutionScheduler();
 		m_should_reupload_images = true;
 		return true;
 	}
@@ -239,8 +345,15 @@ private:
 			}
 		}
 #endif // HAT_IMAGES_SUPPORT
-		auto currentLayout = m_engine->getCurrentLayoutJson();
-		sendPacket_resetLayout(currentLayout);
+		auto const layoutUpdate = m_engine->getCurrentLayoutUpdate(m_displayedNormalLayout);
+		if (layoutUpdate.m_isFullLayout) {
+			sendPacket_resetLayout(layoutUpdate.m_layoutJson);
+		} else {
+			for (auto const & noteChange : layoutUpdate.m_notesChanges) {
+				sendPacket_changeElementNote(noteChange.first, noteChange.second);
+			}
+		}
+		m_displayedNormalLayout = layoutUpdate.m_normalLayout;
 	}
 };
 
@@ -248,7 +361,7 @@ bool checkConfigsForErrors() {
 
 	try {
 		std::cout << "Checking configuration files for errors ...\n";
-		Engine::create(COMMANDS_CONFIG_PATH, INPUT_SEQUENCES_CFG_PATHS, VARIABLE_MANAGERS_CFG_PATHS, IMAGE_RESOURCES_CONFIG_PATH, COMMAND_ID_TO_IMAGE_ID_CONFIG_PATH, LAYOUT_CONFIG_PATH, STICK_ENV_TO_WINDOW, KEYSTROKES_DELAY, [](std::string const &, std::string const &){});
+		createEngine(false, [](std::string const &, std::string const &){});
 		std::cout << "\t... done.\n";
 	} catch (std::runtime_error & e) {
 		std::cerr << "\n --- Error during reading of the config files at startup:\n" << e.what() << "\n";
@@ -290,6 +403,62 @@ namespace {
 			t->async_wait(boost::bind(resetTimer, t));
 		}
 	}
+
+#ifdef HAT_CONFIG_FILES_WATCHING_SUPPORT
+	auto const CONFIG_FILES_CHANGES_DEBOUNCE_INTERVAL = std::chrono::milliseconds{300};
+
+	std::vector<std::string> getAllConfigFilesPaths()
+	{
+		auto result = std::vector<std::string>{ COMMANDS_CONFIG_PATH, LAYOUT_CONFIG_PATH };
+		for (auto const & paths : { INPUT_SEQUENCES_CFG_PATHS, VARIABLE_MANAGERS_CFG_PATHS, std::vector<std::string>{ IMAGE_RESOURCES_CONFIG_PATH, COMMAND_ID_TO_IMAGE_ID_CONFIG_PATH } }) {
+			std::copy_if(paths.begin(), paths.end(), std::back_inserter(result), [](std::string const & path) { return path.size() > 0; });
+		}
+		return result;
+	}
+
+	// The error is shown by all the connections at once, and the previous layouts are restored after the interval.
+	void reloadingInBackgroundFailed(boost::asio::io_service & io_service, std::string const & errorMessage)
+	{
+		std::cerr << "\n --- Error during reloading of the changed config files:\n" << errorMessage << "\n";
+		io_service.post([&io_service, errorMessage]() {
+			for (auto dispatcher : activeConnections) {
+				dispatcher->configsReloadingInBackgroundFailed(errorMessage);
+			}
+			auto const restoringTimer = std::make_shared<boost::asio::deadline_timer>(io_service, RELOADING_ERROR_DISPLAYING_INTERVAL);
+			restoringTimer->async_wait([restoringTimer](boost::system::error_code const &) {
+				for (auto dispatcher : activeConnections) {
+					dispatcher->restoreLayoutAfterReloadingError();
+				}
+			});
+		});
+	}
+
+	// Called on the config files watcher's thread, so the io_service is not blocked while the configs and images are loaded.
+	// The result is passed to the connections through the io_service (they are not thread-safe).
+	void reloadChangedConfigsInBackground(boost::asio::io_service & io_service)
+	{
+		std::cout << "The config files were changed. Reloading them in the background...\n";
+		auto reloadResult = BackgroundReloadResult{};
+		try {
+			reloadResult.m_engine = std::make_shared<Engine const>(createEngine(true, [](std::string const &, std::string const &) {}));
+#ifdef HAT_IMAGES_SUPPORT
+			reloadResult.m_loadedImages = loadImages(reloadResult.m_engine->getImagesPhysicalInfos(), [](std::string const &, std::string const &) {});
+#endif // HAT_IMAGES_SUPPORT
+		} catch (std::exception & e) {
+			reloadingInBackgroundFailed(io_service, e.what());
+			return;
+		} catch (...) {
+			reloadingInBackgroundFailed(io_service, "Unknown error.");
+			return;
+		}
+		std::cout << "\t... done.\n";
+		io_service.post([reloadResult]() {
+			for (auto dispatcher : activeConnections) {
+				dispatcher->configsReloadedInBackground(reloadResult);
+			}
+		});
+	}
+#endif //HAT_CONFIG_FILES_WATCHING_SUPPORT
 }
 }// namespace tool
 }// namespace hat 
@@ -297,6 +466,7 @@ namespace {
 
 int main(int argc, char ** argv)
 {
+	hat::tool::prepareInputSimulationForMultipleThreads();
 	auto const VERSION_STR = "0.1.0";
 	// --------------------------------- Command line parameters parsing --------------------------------- 
 	auto const HELP = "help";
@@ -312,10 +482,21 @@ int main(int argc, char ** argv)
 	auto const IMAGE_ID_2_COMMAND_ID_CFG = "images_to_commands_cfg";
 #endif // HAT_IMAGES_SUPPORT
 	auto const STICK_ENV_TO_WIN = "stickEnvToWindow";
+	auto const CONFIG_BUNDLE = "bundle";
+	auto const COMPILE_CONFIG_BUNDLE = "compile-bundle";
+	auto const PRECOMPUTE_LAYOUTS = "precomputeLayouts";
+	auto const RECORD_INPUT = "recordInput";
+#ifdef HAT_CONFIG_FILES_WATCHING_SUPPORT
+	auto const WATCH_CONFIGS = "watchConfigs";
+#endif // HAT_CONFIG_FILES_WATCHING_SUPPORT
 
 #ifdef HAT_WINDOWS_SCANCODES_SUPPORT
 	auto const USE_SCAN_CODES_FOR_KEYBOARD_EMULATION = "useScanCodes";
 #endif
+#ifdef HAT_XTEST_INPUT_SUPPORT
+	auto const BATCH_KEYBOARD_INPUT = "batchKeyboardInput";
+	auto const BENCHMARK_KEYBOARD_INPUT = "benchmarkKeyboardInput";
+#endif // HAT_XTEST_INPUT_SUPPORT
 
 #ifdef HAT_WINDOWS_CONSOLE_HIDING_FEATURE_SUPPORTED
 	auto const HIDE_CONSOLE = "hideConsole";
@@ -338,9 +519,20 @@ int main(int argc, char ** argv)
 #endif // HAT_IMAGES_SUPPORT
 		(LAYOUT_CFG, po::value<std::string>(), "Filepath to the configuration file, holding the layout information")
 		(STICK_ENV_TO_WIN, "If set, the tool will require the user to specify a target window for each environment selected")
+		(CONFIG_BUNDLE, po::value<std::string>(), "Filepath to the precompiled configs bundle (see the '--compile-bundle' option). If the bundle was compiled from the same config files, it is loaded instead of parsing them. Otherwise the config files are parsed as usual.")
+		(COMPILE_CONFIG_BUNDLE, po::value<std::string>(), "Parse and verify the config files, write the result into the precompiled configs bundle file with the given path and exit")
+		(PRECOMPUTE_LAYOUTS, "If set, the tool will generate the layouts for all the environments right after the configs are loaded. This makes the switching between the environments faster, but takes more memory")
+		(RECORD_INPUT, po::value<size_t>(), "Record the simulated input events (with their timestamps) into the buffer of the given capacity instead of sending them to the system, and print the latency and throughput statistics after each command. This allows running the tool without the display (for the benchmarks and the tests)")
+#ifdef HAT_CONFIG_FILES_WATCHING_SUPPORT
+		(WATCH_CONFIGS, "If set, the tool will reload the configs automatically (and update the layouts on all the connected clients), when the config files are changed")
+#endif // HAT_CONFIG_FILES_WATCHING_SUPPORT
 #ifdef HAT_WINDOWS_SCANCODES_SUPPORT
 		(USE_SCAN_CODES_FOR_KEYBOARD_EMULATION, "If set, the tool will use scan-codes instead of virtual keycodes for keyboard emulation (windows only)")
 #endif
+#ifdef HAT_XTEST_INPUT_SUPPORT
+		(BATCH_KEYBOARD_INPUT, "If set, the tool will send the keyboard events of each key sequence to the X server at once through the XTest extension, using one persistent display connection (linux only)")
+		(BENCHMARK_KEYBOARD_INPUT, po::value<std::string>(), "Type the given key sequence repeatedly through the default and the batched keyboard input (see '--batchKeyboardInput'), print the events per second rate for both and exit. Note: the keys are sent to the focused window")
+#endif // HAT_XTEST_INPUT_SUPPORT
 #ifdef HAT_WINDOWS_CONSOLE_HIDING_FEATURE_SUPPORTED
 		(HIDE_CONSOLE, "If set, the tool will hide the console window when at least 1 client is connected (windows only)")
 #endif // HAT_WINDOWS_CONSOLE_HIDING_FEATURE_SUPPORTED
@@ -365,6 +557,18 @@ int main(int argc, char ** argv)
 		return 2;
 	}
 
+#ifdef HAT_XTEST_INPUT_SUPPORT
+	if (vm.count(BENCHMARK_KEYBOARD_INPUT) > 0) {
+		try {
+			hat::tool::runKeyboardInputBenchmark(vm[BENCHMARK_KEYBOARD_INPUT].as<std::string>(), (vm.count(KEYB_DELAY) > 0) ? vm[KEYB_DELAY].as<unsigned int>() : 0);
+		} catch (std::exception const & e) {
+			std::cerr << "Error during the keyboard input benchmark: " << e.what() << "\n";
+			return 7;
+		}
+		return 0;
+	}
+#endif // HAT_XTEST_INPUT_SUPPORT
+
 	if (vm.count(COMMANDS_CFG)) {
 		hat::tool::COMMANDS_CONFIG_PATH = vm[COMMANDS_CFG].as<std::string>();
 		std::cout << "Commands config file: " << hat::tool::COMMANDS_CONFIG_PATH << "\n";
@@ -448,6 +652,48 @@ int main(int argc, char ** argv)
 		std::cout << "delay for the simulated keyboard events is set to " << vm[KEYB_DELAY].as<unsigned int>() << "\n";
 		hat::tool::KEYSTROKES_DELAY = vm[KEYB_DELAY].as<unsigned int>();
 	}
+#ifdef HAT_XTEST_INPUT_SUPPORT
+	if (vm.count(BATCH_KEYBOARD_INPUT) > 0) {
+		try {
+			hat::tool::XTestKeyboardInput::getInstance(); // the display connection is opened here, so the errors are reported at the start
+			hat::tool::SHOULD_BATCH_KEYBOARD_INPUT = true;
+			std::cout << "Setting 'batch keyboard input' flag to true.\n";
+		} catch (std::exception const & e) {
+			std::cout << "Could not enable the batched keyboard input (" << e.what() << "). Ignoring the '" << BATCH_KEYBOARD_INPUT << "' command line argument.\n";
+		}
+	}
+#endif // HAT_XTEST_INPUT_SUPPORT
+
+	if (vm.count(COMPILE_CONFIG_BUNDLE) > 0) {
+		hat::tool::CONFIG_BUNDLE_PATH = vm[COMPILE_CONFIG_BUNDLE].as<std::string>();
+		hat::tool::CONFIG_BUNDLE_MODE = hat::tool::ConfigBundleMode::COMPILE;
+		std::cout << "Compiling the precompiled configs bundle '" << hat::tool::CONFIG_BUNDLE_PATH << "'\n";
+		return hat::tool::checkConfigsForErrors() ? 0 : 5;
+	}
+	if (vm.count(CONFIG_BUNDLE) > 0) {
+		hat::tool::CONFIG_BUNDLE_PATH = vm[CONFIG_BUNDLE].as<std::string>();
+		hat::tool::CONFIG_BUNDLE_MODE = hat::tool::ConfigBundleMode::LOAD_IF_VALID;
+		std::cout << "Precompiled configs bundle: " << hat::tool::CONFIG_BUNDLE_PATH << "\n";
+	}
+	if (vm.count(PRECOMPUTE_LAYOUTS) > 0) {
+		std::cout << "Setting 'precompute layouts' flag to true.\n";
+		hat::tool::PRECOMPUTE_ENVIRONMENT_LAYOUTS = true;
+	}
+	if (vm.count(RECORD_INPUT) > 0) {
+		try {
+			hat::tool::INPUT_BACKEND = std::make_shared<hat::tool::RecordingInputBackend>(vm[RECORD_INPUT].as<size_t>());
+		} catch (std::runtime_error const & e) {
+			std::cerr << "Error in the '--" << RECORD_INPUT << "' option: " << e.what() << "\n";
+			return 1;
+		}
+		std::cout << "The simulated input will be recorded instead of being sent to the system (up to " << vm[RECORD_INPUT].as<size_t>() << " last events are kept).\n";
+	}
+#ifdef HAT_CONFIG_FILES_WATCHING_SUPPORT
+	if (vm.count(WATCH_CONFIGS) > 0) {
+		std::cout << "Setting 'watch config files' flag to true.\n";
+		hat::tool::WATCH_CONFIG_FILES = true;
+	}
+#endif // HAT_CONFIG_FILES_WATCHING_SUPPORT
 
 	// --------------------------------- Command line parsing done. Starting the server. --------------------------------- 
 
@@ -459,7 +705,24 @@ int main(int argc, char ** argv)
 		//This timer is used for the heartbeats generation. If they are not enabled, the timer will not be enabled inside the resetTimer() function:
 		boost::asio::deadline_timer timer(io_service);
 		hat::tool::resetTimer(&timer);
+
+		hat::tool::CommandsExecutionThread commandsExecutionThread(hat::tool::COMMANDS_EXECUTION_QUEUE_CAPACITY, [&io_service](std::function<void()> const & onExecuted) {
+			io_service.post(onExecuted);
+		});
+		hat::tool::COMMANDS_EXECUTION_THREAD = &commandsExecutionThread;
 		
+#ifdef HAT_CONFIG_FILES_WATCHING_SUPPORT
+		auto configFilesWatcher = std::unique_ptr<hat::tool::ConfigFilesWatcher>{};
+		if (hat::tool::WATCH_CONFIG_FILES) {
+			try {
+				configFilesWatcher = std::make_unique<hat::tool::ConfigFilesWatcher>(hat::tool::getAllConfigFilesPaths(), hat::tool::CONFIG_FILES_CHANGES_DEBOUNCE_INTERVAL, [&io_service]() {
+					hat::tool::reloadChangedConfigsInBackground(io_service);
+				});
+			} catch (std::runtime_error & e) {
+				std::cerr << "Could not start watching the config files: " << e.what() << "\nThe configs will be reloaded only on the user's request.\n";
+			}
+		}
+#endif // HAT_CONFIG_FILES_WATCHING_SUPPORT
 		std::cout << "Starting server on port " << port << "...\n";
 		s.start();
 		std::cout << "Calling io_service.run()\n";
@@ -0,0 +1,239 @@
+// This source file is part of the 'hat' open source project.
+// Copyright (c) 2016, Yuriy Vosel.
+// Licensed under Boost Software License.
+// See LICENSE.txt for the licence information.
+
+#include "xtest_keyboard_input.hpp"
+
+#ifdef HAT_XTEST_INPUT_SUPPORT
+
+#include <X11/Xlib.h>
+#include <X11/keysym.h>
+#include <X11/extensions/XTest.h>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+namespace hat {
+namespace tool {
+
+XTestKeyboardInput::XTestKeyboardInput()
+	: m_display(XOpenDisplay(nullptr))
+{
+	if (m_display == nullptr) {
+		throw std::runtime_error("Could not open the X display for the keyboard input simulation");
+	}
+	int eventBase, errorBase, majorVersion, minorVersion;
+	if (!XTestQueryExtension(m_display, &eventBase, &errorBase, &majorVersion, &minorVersion)) {
+		XCloseDisplay(m_display);
+		throw std::runtime_error("The XTest extension is not available on the X display");
+	}
+}
+
+XTestKeyboardInput::~XTestKeyboardInput()
+{
+	XCloseDisplay(m_display);
+}
+
+XTestKeyboardInput & XTestKeyboardInput::getInstance()
+{
+	static XTestKeyboardInput instance;
+	return instance;
+}
+
+unsigned char XTestKeyboardInput::getKeyCode(ROBOT_NS::Key key)
+{
+	auto const foundKeyCode = m_keyCodes.find(key);
+	if (foundKeyCode != m_keyCodes.end()) {
+		return foundKeyCode->second;
+	}
+	return m_keyCodes.emplace(key, XKeysymToKeycode(m_display, static_cast<KeySym>(key))).first->second;
+}
+
+void XTestKeyboardInput::processKeyboardMappingChanges()
+{
+	// Note: the server sends the MappingNotify events to all the clients, so they are received without selecting any events.
+	XEvent event;
+	while (XCheckTypedEvent(m_display, MappingNotify, &event)) {
+		XRefreshKeyboardMapping(&event.xmapping);
+		m_keyCodes.clear();
+	}
+}
+
+void XTestKeyboardInput::simulate(ROBOT_NS::KeyList const & keys, unsigned int keystrokesDelay)
+{
+	processKeyboardMappingChanges();
+	for (auto const & keyEvent : keys) {
+		auto const keyCode = getKeyCode(keyEvent.second);
+		if (keyCode == 0) {
+			continue; // the key is not present in the current keyboard mapping (the Robot library ignores such keys too)
+		}
+		XTestFakeKeyEvent(m_display, keyCode, keyEvent.first ? True : False, CurrentTime);
+		if (keystrokesDelay > 0) {
+			XFlush(m_display);
+			std::this_thread::sleep_for(std::chrono::milliseconds{ keystrokesDelay });
+		}
+	}
+	// Wait until the server processes the events, so the following input (for example, a system call in the same sequence) does not overtake them:
+	XSync(m_display, False);
+}
+
+namespace {
+	// The clients translate the key codes into the symbols by their own copy of the mapping, which is updated after the mapping change notification arrives.
+	// So the remapped key codes are not used until this interval passes after the mapping change is processed by the server,
+	// and they are not remapped again until it passes after the events, which use them, are processed.
+	std::chrono::milliseconds const REMAPPED_KEYS_SETTLE_INTERVAL{ 20 };
+
+	KeySym getKeySymbol(char32_t character)
+	{
+		if (character == U'\n') {
+			return XK_Return;
+		} else if (character == U'\t') {
+			return XK_Tab;
+		} else if (((character >= 0x20) && (character <= 0x7E)) || ((character >= 0xA0) && (character <= 0xFF))) {
+			return static_cast<KeySym>(character); // the Latin-1 key symbols are the same as the code points
+		}
+		// Note: some of the layouts use the legacy key symbols for the other characters. Such characters are typed through the spare key codes.
+		return static_cast<KeySym>(0x01000000 | character);
+	}
+}
+
+void XTestKeyboardInput::loadKeyboardLayout()
+{
+	int minKeyCode, maxKeyCode;
+	XDisplayKeycodes(m_display, &minKeyCode, &maxKeyCode);
+	int symbolsPerKeyCode = 0;
+	auto const keySymbols = XGetKeyboardMapping(m_display, static_cast<KeyCode>(minKeyCode), maxKeyCode - minKeyCode + 1, &symbolsPerKeyCode);
+	m_keyboardLayout.clear();
+	m_spareKeyCodes.clear();
+	if (keySymbols == nullptr) {
+		return;
+	}
+	// The symbols, which are typed without the shift, are preferred:
+	for (int level = 0; level < (std::min)(symbolsPerKeyCode, 2); ++level) {
+		for (int keyCode = minKeyCode; keyCode <= maxKeyCode; ++keyCode) {
+			auto const keySymbol = keySymbols[(keyCode - minKeyCode) * symbolsPerKeyCode + level];
+			if (keySymbol != NoSymbol) {
+				m_keyboardLayout.emplace(keySymbol, TypedKey{ static_cast<unsigned char>(keyCode), level == 1 });
+			}
+		}
+	}
+	for (int keyCode = minKeyCode; keyCode <= maxKeyCode; ++keyCode) {
+		auto const symbols = keySymbols + (keyCode - minKeyCode) * symbolsPerKeyCode;
+		if (std::all_of(symbols, symbols + symbolsPerKeyCode, [](KeySym symbol) { return symbol == NoSymbol; })) {
+			m_spareKeyCodes.push_back(static_cast<unsigned char>(keyCode));
+		}
+	}
+	XFree(keySymbols);
+}
+
+void XTestKeyboardInput::typeText(std::u32string const & text, unsigned int keystrokesDelay)
+{
+	processKeyboardMappingChanges();
+	loadKeyboardLayout();
+	auto const shiftKeyCode = XKeysymToKeycode(m_display, XK_Shift_L);
+	auto remappedKeyCodes = std::unordered_map<KeySym, unsigned char>{}; // the symbols of the current chunk, which are mapped to the spare key codes
+	auto chunkKeys = std::vector<TypedKey>{};
+	for (size_t chunkStart = 0; chunkStart < text.size(); ) {
+		if (!remappedKeyCodes.empty()) {
+			XSync(m_display, False);
+			std::this_thread::sleep_for(REMAPPED_KEYS_SETTLE_INTERVAL);
+			remappedKeyCodes.clear();
+		}
+		chunkKeys.clear();
+		auto chunkEnd = chunkStart;
+		for (; (chunkEnd < text.size()) && ((chunkEnd - chunkStart) < TEXT_TYPING_CHUNK_SIZE); ++chunkEnd) {
+			auto const keySymbol = getKeySymbol(text[chunkEnd]);
+			auto const foundKey = m_keyboardLayout.find(keySymbol);
+			if (foundKey != m_keyboardLayout.end()) {
+				chunkKeys.push_back(foundKey->second);
+				continue;
+			}
+			if (m_spareKeyCodes.empty()) {
+				std::cerr << "The character U+" << std::hex << static_cast<unsigned long>(text[chunkEnd]) << std::dec << " is not in the keyboard layout, and there are no spare key codes to type it. It is skipped.\n";
+				continue;
+			}
+			auto remappedKey = remappedKeyCodes.find(keySymbol);
+			if (remappedKey == remappedKeyCodes.end()) {
+				if (remappedKeyCodes.size() == m_spareKeyCodes.size()) {
+					break; // all the spare key codes are used by this chunk, the character is typed in the next one
+				}
+				remappedKey = remappedKeyCodes.emplace(keySymbol, m_spareKeyCodes[remappedKeyCodes.size()]).first;
+			}
+			chunkKeys.push_back(TypedKey{ remappedKey->second, false });
+		}
+		for (auto const & remappedKey : remappedKeyCodes) {
+			KeySym symbols[] = { remappedKey.first, remappedKey.first }; // the same symbol with and without the shift
+			XChangeKeyboardMapping(m_display, remappedKey.second, 2, symbols, 1);
+		}
+		if (!remappedKeyCodes.empty()) {
+			XSync(m_display, False);
+			std::this_thread::sleep_for(REMAPPED_KEYS_SETTLE_INTERVAL);
+		}
+		for (auto const & key : chunkKeys) {
+			if (key.m_isShifted) {
+				XTestFakeKeyEvent(m_display, shiftKeyCode, True, CurrentTime);
+			}
+			XTestFakeKeyEvent(m_display, key.m_keyCode, True, CurrentTime);
+			XTestFakeKeyEvent(m_display, key.m_keyCode, False, CurrentTime);
+			if (key.m_isShifted) {
+				XTestFakeKeyEvent(m_display, shiftKeyCode, False, CurrentTime);
+			}
+		}
+		XFlush(m_display);
+		chunkStart = chunkEnd;
+		if ((keystrokesDelay > 0) && (chunkStart < text.size())) {
+			std::this_thread::sleep_for(std::chrono::milliseconds{ keystrokesDelay });
+		}
+	}
+	XSync(m_display, False);
+	if (!remappedKeyCodes.empty()) {
+		// The spare key codes are cleared, so the symbols do not stay in the mapping after the text is typed:
+		std::this_thread::sleep_for(REMAPPED_KEYS_SETTLE_INTERVAL);
+		for (auto const & remappedKey : remappedKeyCodes) {
+			KeySym symbols[] = { NoSymbol, NoSymbol };
+			XChangeKeyboardMapping(m_display, remappedKey.second, 2, symbols, 1);
+		}
+		XSync(m_display, False);
+		m_keyCodes.clear(); // the symbols could be resolved to the remapped key codes, while they were used by the text
+	}
+}
+
+void runKeyboardInputBenchmark(std::string const & keySequence, unsigned int keystrokesDelay)
+{
+	auto keys = ROBOT_NS::KeyList{};
+	if (!ROBOT_NS::Keyboard::Compile(keySequence.c_str(), keys) || keys.empty()) {
+		throw std::runtime_error("Could not compile the key sequence for the benchmark: " + keySequence);
+	}
+	size_t const repetitionsCount = 20;
+	auto const measureEventsPerSecond = [&keys](std::function<void()> const & simulateSequence) {
+		auto const start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < repetitionsCount; ++i) {
+			simulateSequence();
+		}
+		auto const duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		return (duration > 0) ? (keys.size() * repetitionsCount / duration) : 0.0;
+	};
+	auto & batchedInput = XTestKeyboardInput::getInstance();
+	auto const robotRate = measureEventsPerSecond([&keys, keystrokesDelay]() {
+		auto keyboard = ROBOT_NS::Keyboard{};
+		keyboard.AutoDelay = keystrokesDelay;
+		for (auto const & keyEvent : keys) {
+			(keyEvent.first) ? keyboard.Press(keyEvent.second) : keyboard.Release(keyEvent.second);
+		}
+	});
+	auto const batchedRate = measureEventsPerSecond([&keys, &batchedInput, keystrokesDelay]() {
+		batchedInput.simulate(keys, keystrokesDelay);
+	});
+	std::cout << "Keyboard input benchmark (" << keys.size() << " events, " << repetitionsCount << " repetitions, keystrokes delay " << keystrokesDelay << " ms):\n"
+		<< "\tRobot library: " << static_cast<size_t>(robotRate) << " events per second\n"
+		<< "\tbatched XTest input: " << static_cast<size_t>(batchedRate) << " events per second\n";
+}
+
+} // namespace tool
+} // namespace hat
+
+#endif //HAT_XTEST_INPUT_SUPPORT
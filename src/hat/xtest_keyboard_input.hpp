@@ -0,0 +1,65 @@
+// This source file is part of the 'hat' open source project.
+// Copyright (c) 2016, Yuriy Vosel.
+// Licensed under Boost Software License.
+// See LICENSE.txt for the licence information.
+
+#ifndef HAT_XTEST_KEYBOARD_INPUT_HPP
+#define HAT_XTEST_KEYBOARD_INPUT_HPP
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../external_dependencies/robot/Source/Keyboard.h"
+
+#ifdef HAT_XTEST_INPUT_SUPPORT
+struct _XDisplay;
+namespace hat {
+namespace tool {
+
+// Simulates the keyboard input through the XTest extension, using one connection to the X display for the whole process lifetime.
+// The Robot library sends each key event separately and waits until the X server processes it, so the long sequences cost one round-trip per event.
+// Here the events of the whole sequence are queued and sent at once (if the keystrokes delay is set, each event is sent separately before the delay),
+// and the sequence is synchronized with the X server only once, after its last event.
+// Note: the object is not thread-safe. After the initialization it is used only on the commands execution thread.
+class XTestKeyboardInput
+{
+	_XDisplay * m_display;
+	std::unordered_map<ROBOT_NS::Key, unsigned char> m_keyCodes; // the Robot's keys are the X key symbols. Their key codes are cached until the keyboard mapping is changed.
+	unsigned char getKeyCode(ROBOT_NS::Key key);
+	// Processes the mapping change notifications, which were received from the server since the last call: the Xlib's copy of the mapping is updated, and the key codes cache is cleared.
+	void processKeyboardMappingChanges();
+
+	// The key, which is pressed to type a character of the text.
+	struct TypedKey
+	{
+		unsigned char m_keyCode;
+		bool m_isShifted;
+	};
+	std::unordered_map<unsigned long, TypedKey> m_keyboardLayout; // the key symbols of the first group of the current keyboard mapping (without and with the shift)
+	std::vector<unsigned char> m_spareKeyCodes; // the key codes without any symbols. They are remapped temporarily to type the characters, which are not in the layout.
+	void loadKeyboardLayout();
+	XTestKeyboardInput(); // throws, if the display could not be opened or the XTest extension is not available
+public:
+	~XTestKeyboardInput();
+	XTestKeyboardInput(XTestKeyboardInput const &) = delete;
+	XTestKeyboardInput & operator = (XTestKeyboardInput const &) = delete;
+
+	static XTestKeyboardInput & getInstance(); // the object is created during the first call
+	void simulate(ROBOT_NS::KeyList const & keys, unsigned int keystrokesDelay);
+
+	// Types the characters of the text. The keyboard mapping is read again for each text, so the changes of the layout are picked up.
+	// The characters, which are not present in the layout, are typed through the spare key codes: they are mapped to the needed symbols before the chunk of the text is sent.
+	// The text is sent in the chunks of TEXT_TYPING_CHUNK_SIZE characters (or less, if the spare key codes run out). The keystrokes delay is done between the chunks.
+	static size_t const TEXT_TYPING_CHUNK_SIZE = 32;
+	void typeText(std::u32string const & text, unsigned int keystrokesDelay);
+};
+
+// Types the sequence (in the Robot library syntax) repeatedly through the Robot library and through the XTestKeyboardInput, and prints the events per second rate for both.
+// Note: the keys are sent to the focused window.
+void runKeyboardInputBenchmark(std::string const & keySequence, unsigned int keystrokesDelay);
+
+} // namespace tool
+} // namespace hat
+#endif //HAT_XTEST_INPUT_SUPPORT
+
+#endif //HAT_XTEST_KEYBOARD_INPUT_HPP